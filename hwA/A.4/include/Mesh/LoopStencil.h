@@ -0,0 +1,246 @@
+/*
+ * LoopStencil.h
+ *
+ * Loop 细分的模板表（stencil table）：“拓扑算一次，位置算多次”。
+ *
+ * 控制网格的拓扑不变、只有顶点位置逐帧变化（如动画变形的控制笼）时，第 L 级细分网格的
+ * 每个顶点都是控制顶点的固定线性组合：
+ *     P_L[i] = sum_j w_ij * P_0[j]
+ * LoopStencils 在构造时逐级细分一次拓扑，把每级的局部细分规则与上一级模板相乘，
+ * 得到以控制顶点表示的稀疏模板（CSR：offsets / controlIds / weights）。
+ * 之后每帧只需一次稀疏矩阵-向量乘（SSE 累加、多线程分块），不再需要重建半边结构、
+ * 计算 beta 权重或调用 addFace。
+ *
+ * 用法：
+ *     LoopStencils stencils(controlMesh, 3);          // 一次性构建
+ *     stencils.evaluate(3, controlPositions, refined); // 每帧求值
+ *     levelMesh.updatePositions(refined);               // 仅更新顶点缓冲
+ *
+ * 撰写者：Zhiyuan Feng
+ */
+
+#ifndef LOOP_STENCIL_H
+#define LOOP_STENCIL_H
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+#include "Mesh/Mesh.h"
+#include "Mesh/LoopSubdivision.h"
+#include "Parallel/ParallelFor.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define LOOP_STENCIL_SSE 1
+#endif
+
+// 稀疏模板表：第 i 个输出顶点 = sum(weights[k] * control[controlIds[k]])，k ∈ [offsets[i], offsets[i+1])
+struct StencilTable {
+    std::vector<unsigned int> offsets;
+    std::vector<unsigned int> controlIds;
+    std::vector<float> weights;
+
+    size_t size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+
+    // 对已按 (x, y, z, 0) 填充的控制点求值
+    void evaluate(const std::vector<Vec4>& paddedControl, std::vector<Vec3>& out) const {
+        out.resize(size());
+        parallelForRange(0, size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                unsigned int first = offsets[i], last = offsets[i + 1];
+#ifdef LOOP_STENCIL_SSE
+                __m128 acc = _mm_setzero_ps();
+                for (unsigned int k = first; k < last; ++k) {
+                    __m128 p = _mm_loadu_ps(&paddedControl[controlIds[k]].x);
+                    acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(weights[k]), p));
+                }
+                alignas(16) float result[4];
+                _mm_store_ps(result, acc);
+                out[i] = Vec3(result[0], result[1], result[2]);
+#else
+                Vec3 acc(0.0f);
+                for (unsigned int k = first; k < last; ++k) {
+                    acc += weights[k] * Vec3(paddedControl[controlIds[k]]);
+                }
+                out[i] = acc;
+#endif
+            }
+        }, 2048);
+    }
+};
+
+class LoopStencils {
+public:
+    // 以 controlMesh 为控制网格，构建第 1..levels 级的模板表；
+    // levels < 1 或细分失败时输出错误，levels() 返回实际构建的级数（可能为 0），由调用方处理
+    LoopStencils(const Mesh& controlMesh, int levels) : numControl(controlMesh.vertices.size()) {
+        if (levels < 1) {
+            std::cerr << "Error: LoopStencils requires at least one subdivision level!" << std::endl;
+            return;
+        }
+
+        Mesh parent = controlMesh;
+        for (int level = 1; level <= levels; ++level) {
+            Mesh child = LoopSubdivide(parent);
+            if (child.faceElements.empty()) {
+                std::cerr << "Error: LoopStencils stopped at level " << level - 1 << "!" << std::endl;
+                break; // levels() 返回实际构建的级数
+            }
+            tables.push_back(composeLevel(parent, level == 1 ? nullptr : &tables.back()));
+            levelIndices.push_back(child.indices);
+            parent = std::move(child);
+        }
+    }
+
+    int levels() const { return static_cast<int>(tables.size()); }
+    size_t controlCount() const { return numControl; }
+
+    // 第 level 级（1..levels）的模板表与三角形索引
+    const StencilTable& table(int level) const { return tables[level - 1]; }
+    const std::vector<unsigned int>& indices(int level) const { return levelIndices[level - 1]; }
+
+    // 由新的控制点位置求第 level 级细分网格的顶点位置
+    void evaluate(int level, const std::vector<Vec3>& controlPositions, std::vector<Vec3>& out) {
+        if (controlPositions.size() != numControl) {
+            std::cerr << "Error: control point count does not match the stencil table!" << std::endl;
+            return;
+        }
+        paddedControl.resize(numControl);
+        for (size_t i = 0; i < numControl; ++i) {
+            paddedControl[i] = Vec4(controlPositions[i], 0.0f);
+        }
+        table(level).evaluate(paddedControl, out);
+    }
+
+private:
+    size_t numControl;
+    std::vector<StencilTable> tables;
+    std::vector<std::vector<unsigned int>> levelIndices;
+    std::vector<Vec4> paddedControl;
+
+    // 单个子顶点在父网格顶点上的局部细分规则（与 LoopSubdivide 的规则一致）
+    static void localStencil(const Mesh& parent, size_t childVertex,
+                             std::vector<std::pair<size_t, double>>& entries) {
+        entries.clear();
+        const size_t numVerts = parent.vertices.size();
+
+        if (childVertex < numVerts) {
+            // 偶点
+            const HalfEdgeRange outgoing = parent.outgoingHalfEdges(childVertex);
+            unsigned adjCount = 0, adjBoundaryCount = 0;
+            for (size_t heId : outgoing) {
+                if (parent.edgeElements[parent.halfEdges[heId].edgeId].halfEdge2Id == INVALID_INDEX) {
+                    adjBoundaryCount++;
+                }
+                adjCount++;
+            }
+
+            if (adjBoundaryCount == 2) {
+                entries.emplace_back(childVertex, 0.75);
+                for (size_t heId : outgoing) {
+                    const HalfEdge& he = parent.halfEdges[heId];
+                    if (parent.edgeElements[he.edgeId].halfEdge2Id == INVALID_INDEX) {
+                        entries.emplace_back(he.toVertexId, 0.125);
+                    }
+                }
+            } else {
+                double beta = loop_detail::loopBeta(adjCount);
+                entries.emplace_back(childVertex, 1.0 - beta * adjCount);
+                for (size_t heId : outgoing) {
+                    entries.emplace_back(parent.halfEdges[heId].toVertexId, beta);
+                }
+            }
+        } else {
+            // 奇点（边点）
+            const EdgeElement& edge = parent.edgeElements[childVertex - numVerts];
+            const HalfEdge& he1 = parent.halfEdges[edge.halfEdge1Id];
+            if (edge.halfEdge2Id == INVALID_INDEX) {
+                entries.emplace_back(he1.fromVertexId, 0.5);
+                entries.emplace_back(he1.toVertexId, 0.5);
+            } else {
+                const HalfEdge& he2 = parent.halfEdges[edge.halfEdge2Id];
+                entries.emplace_back(he1.fromVertexId, 0.375);
+                entries.emplace_back(he1.toVertexId, 0.375);
+                entries.emplace_back(parent.halfEdges[he1.nextHalfEdgeId].toVertexId, 0.125);
+                entries.emplace_back(parent.halfEdges[he2.nextHalfEdgeId].toVertexId, 0.125);
+            }
+        }
+    }
+
+    // 子网格模板 = 局部规则 × 父网格模板（parentTable 为空表示父网格即控制网格）
+    StencilTable composeLevel(const Mesh& parent, const StencilTable* parentTable) const {
+        const size_t numChild = parent.vertices.size() + parent.edgeElements.size();
+
+        // 各线程块独立生成自己负责的连续子顶点区间，最后按顺序拼接，保证结果确定
+        struct Block {
+            size_t begin = 0;
+            std::vector<unsigned int> counts;
+            std::vector<unsigned int> controlIds;
+            std::vector<float> weights;
+        };
+        std::vector<Block> blocks((numChild + blockSize - 1) / blockSize);
+
+        // 稠密的累加数组每个工作线程只分配一次；stamp 记录最后写入的子顶点，
+        // 新的子顶点第一次碰到某个控制点时才把它清零，因此每个子顶点只花费 O(模板项数)
+        parallelForRange(0, blocks.size(), [&](size_t firstBlock, size_t lastBlock) {
+            std::vector<double> accum(numControl, 0.0);
+            std::vector<size_t> stamp(numControl, INVALID_INDEX);
+            std::vector<unsigned int> touched;
+            std::vector<std::pair<size_t, double>> entries;
+
+            for (size_t b = firstBlock; b < lastBlock; ++b) {
+                Block& block = blocks[b];
+                block.begin = b * blockSize;
+                size_t end = std::min(numChild, block.begin + blockSize);
+
+                for (size_t c = block.begin; c < end; ++c) {
+                    localStencil(parent, c, entries);
+                    touched.clear();
+                    for (const auto& [parentVertex, w] : entries) {
+                        if (parentTable == nullptr) {
+                            accumulate(parentVertex, w, c, accum, stamp, touched);
+                            continue;
+                        }
+                        for (unsigned int k = parentTable->offsets[parentVertex]; k < parentTable->offsets[parentVertex + 1]; ++k) {
+                            accumulate(parentTable->controlIds[k], w * parentTable->weights[k], c, accum, stamp, touched);
+                        }
+                    }
+
+                    // 按控制点编号排序，求值时访存更连续
+                    std::sort(touched.begin(), touched.end());
+                    for (unsigned int id : touched) {
+                        block.controlIds.push_back(id);
+                        block.weights.push_back(static_cast<float>(accum[id]));
+                    }
+                    block.counts.push_back(static_cast<unsigned int>(touched.size()));
+                }
+            }
+        }, 1);
+
+        StencilTable table;
+        table.offsets.reserve(numChild + 1);
+        table.offsets.push_back(0);
+        for (const Block& block : blocks) {
+            for (unsigned int count : block.counts) {
+                table.offsets.push_back(table.offsets.back() + count);
+            }
+            table.controlIds.insert(table.controlIds.end(), block.controlIds.begin(), block.controlIds.end());
+            table.weights.insert(table.weights.end(), block.weights.begin(), block.weights.end());
+        }
+        return table;
+    }
+
+    static void accumulate(size_t id, double w, size_t owner, std::vector<double>& accum,
+                           std::vector<size_t>& stamp, std::vector<unsigned int>& touched) {
+        if (stamp[id] != owner) {
+            stamp[id] = owner;
+            accum[id] = 0.0;
+            touched.push_back(static_cast<unsigned int>(id));
+        }
+        accum[id] += w;
+    }
+
+    static constexpr size_t blockSize = 8192;
+};
+
+#endif // LOOP_STENCIL_H
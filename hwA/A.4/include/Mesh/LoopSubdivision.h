@@ -0,0 +1,293 @@
+/*
+ * LoopSubdivision.h
+ *
+ * 基于半边结构的 Loop 细分（并行、无哈希表版本）。
+ *
+ * 新边点的编号直接由父网格半边的 edgeId 得到（numVerts + edgeId），不再需要
+ * unordered_map 查找；子网格的顶点、半边、边、面数组按 V+E / 12F / 2E+3F / 4F 精确预分配，
+ * 半边连接关系（对向半边、edgeId、顶点出入半边表）按公式直接写出，不再逐面调用 addFace。
+ * 偶点（旧顶点）与奇点（边点）两趟更新均按下标并行。
+ * 可选的 cancelled 标志在各趟之间检查，被置位时提前返回空网格（供后台细分线程取消任务）。
+ * 输入含非三角形面时输出错误并返回空网格，由调用方处理（不在工作线程中退出程序）。
+ *
+ * 对于由 Mesh::addFace 构建的流形三角网格，结果（顶点坐标以及全部半边连接关系）
+ * 与原先逐面 addFace 的串行实现逐位一致。
+ *
+ * 每个父面 f（半边 he0: v0->v1, he1: v1->v2, he2: v2->v0，对应边点 vp, vq, vr）
+ * 被细分为4个子面，子半边编号为 12f + j：
+ *   子面0 [v0, vp, vr]: +0 v0->vp, +1 vp->vr, +2 vr->v0
+ *   子面1 [vp, v1, vq]: +3 vp->v1, +4 v1->vq, +5 vq->vp
+ *   子面2 [vr, vq, v2]: +6 vr->vq, +7 vq->v2, +8 v2->vr
+ *   子面3 [vr, vp, vq]: +9 vr->vp, +10 vp->vq, +11 vq->vr
+ *
+ * 撰写者：Zhiyuan Feng
+ */
+
+#ifndef LOOP_SUBDIVISION_H
+#define LOOP_SUBDIVISION_H
+
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include "Mesh/Mesh.h"
+#include "Parallel/ParallelFor.h"
+
+namespace loop_detail {
+
+constexpr float LOOP_PI = 3.1415926f;
+
+// 第k条父半边的前半段（from -> 边点）对应的子半边偏移
+inline size_t firstHalfOffset(size_t k) { return 4 * k; }
+
+// 第k条父半边的后半段（边点 -> to）对应的子半边偏移
+inline size_t secondHalfOffset(size_t k) { return 3 * ((k + 1) % 3) + k; }
+
+// 面内三条内部边的对向关系（子半边偏移 -> 对向子半边偏移），其余为 INVALID
+constexpr size_t innerOpposite[12] = {
+    INVALID_INDEX, 9, INVALID_INDEX,
+    INVALID_INDEX, INVALID_INDEX, 10,
+    11, INVALID_INDEX, INVALID_INDEX,
+    1, 5, 6
+};
+
+// 第k条父半边的边点在本面内的出/入子半边偏移（已按升序排列）
+constexpr size_t midOutgoing[3][3] = { {1, 3, 10}, {5, 7, 11}, {2, 6, 9} };
+constexpr size_t midIncoming[3][3] = { {0, 5, 9}, {4, 6, 10}, {1, 8, 11} };
+
+// Loop 细分中的 beta 权重（与原实现相同的双精度计算）
+inline double loopBeta(unsigned adjCount) {
+    double val = 0.375 + 0.25 * std::cos(2.0 * LOOP_PI / static_cast<double>(adjCount));
+    return (0.625 - val * val) / static_cast<double>(adjCount);
+}
+
+} // namespace loop_detail
+
+// Loop细分算法（并行版本）
+inline Mesh LoopSubdivide(const Mesh& mesh, const std::atomic<bool>* cancelled = nullptr) {
+    using namespace loop_detail;
+
+    auto isCancelled = [cancelled]() {
+        return cancelled != nullptr && cancelled->load(std::memory_order_relaxed);
+    };
+
+    const size_t numVerts = mesh.vertices.size();
+    const size_t numEdges = mesh.edgeElements.size();
+    const size_t numFaces = mesh.faceElements.size();
+
+    if (mesh.halfEdges.size() != 3 * numFaces) {
+        std::cerr << "Error: Only triangular faces are supported!" << std::endl;
+        return Mesh();
+    }
+
+    const size_t newNumVerts = numVerts + numEdges;
+    const size_t newNumHalfEdges = 12 * numFaces;
+    const size_t newNumFaces = 4 * numFaces;
+
+    Mesh newMesh;
+    newMesh.vertices.resize(newNumVerts);
+    newMesh.vertexElements.resize(newNumVerts);
+    newMesh.halfEdges.resize(newNumHalfEdges);
+    newMesh.indices.resize(newNumHalfEdges);
+    newMesh.faces.resize(newNumFaces);
+    newMesh.faceElements.resize(newNumFaces);
+
+    // 父半边在所属面内的序号（0, 1, 2）
+    auto localIndex = [&mesh](size_t heId) {
+        return heId - mesh.faceElements[mesh.halfEdges[heId].faceId].startHalfEdgeId;
+    };
+
+    // 第一趟：逐父面写出12条子半边与4个子面，并统计本面新建的边数
+    std::vector<size_t> faceEdgeOffsets(numFaces + 1, 0);
+    parallelFor(0, numFaces, [&](size_t f) {
+        const size_t startHeId = mesh.faceElements[f].startHalfEdgeId;
+        size_t corner[3], mid[3], twinFirst[3], twinSecond[3];
+        for (size_t k = 0; k < 3; ++k) {
+            const HalfEdge& parentHe = mesh.halfEdges[startHeId + k];
+            corner[k] = parentHe.fromVertexId;
+            mid[k] = numVerts + parentHe.edgeId;
+
+            // 对向父半边拆分后的前/后半段即为本半边后/前半段的对向半边
+            size_t oppoId = parentHe.oppositeHalfEdgeId;
+            if (oppoId == INVALID_INDEX) {
+                twinFirst[k] = twinSecond[k] = INVALID_INDEX;
+            } else {
+                size_t oppoBase = 12 * mesh.halfEdges[oppoId].faceId;
+                size_t oppoK = localIndex(oppoId);
+                twinFirst[k] = oppoBase + firstHalfOffset(oppoK);
+                twinSecond[k] = oppoBase + secondHalfOffset(oppoK);
+            }
+        }
+
+        const size_t childVerts[12] = {
+            corner[0], mid[0], mid[2],
+            mid[0], corner[1], mid[1],
+            mid[2], mid[1], corner[2],
+            mid[2], mid[0], mid[1]
+        };
+
+        const size_t base = 12 * f;
+        size_t opposite[12];
+        for (size_t j = 0; j < 12; ++j) {
+            opposite[j] = innerOpposite[j] == INVALID_INDEX ? INVALID_INDEX : base + innerOpposite[j];
+        }
+        for (size_t k = 0; k < 3; ++k) {
+            opposite[firstHalfOffset(k)] = twinSecond[k];
+            opposite[secondHalfOffset(k)] = twinFirst[k];
+        }
+
+        size_t createdEdges = 0;
+        for (size_t j = 0; j < 12; ++j) {
+            size_t heId = base + j;
+            size_t i = j % 3;
+            HalfEdge& he = newMesh.halfEdges[heId];
+            he.id = heId;
+            he.fromVertexId = childVerts[j];
+            he.toVertexId = childVerts[j - i + (i + 1) % 3];
+            he.prevHalfEdgeId = heId - i + (i + 2) % 3;
+            he.nextHalfEdgeId = heId - i + (i + 1) % 3;
+            he.oppositeHalfEdgeId = opposite[j];
+            he.faceId = 4 * f + j / 3;
+            newMesh.indices[heId] = static_cast<unsigned int>(childVerts[j]);
+
+            // 与 addFace 一致：对向半边尚未出现（编号更大或不存在）时新建边
+            if (opposite[j] == INVALID_INDEX || opposite[j] > heId) {
+                ++createdEdges;
+            }
+        }
+
+        for (size_t c = 0; c < 4; ++c) {
+            FaceElement& face = newMesh.faceElements[4 * f + c];
+            face.startHalfEdgeId = base + 3 * c;
+            face.vertexIds.assign({ childVerts[3 * c], childVerts[3 * c + 1], childVerts[3 * c + 2] });
+        }
+        faceEdgeOffsets[f + 1] = createdEdges;
+    });
+
+    if (isCancelled()) return Mesh();
+
+    // 前缀和得到每个父面新建边的起始编号
+    for (size_t f = 0; f < numFaces; ++f) {
+        faceEdgeOffsets[f + 1] += faceEdgeOffsets[f];
+    }
+    const size_t newNumEdges = faceEdgeOffsets[numFaces];
+    newMesh.edges.resize(newNumEdges);
+    newMesh.edgeElements.resize(newNumEdges);
+
+    // 第二趟：为新建边的半边分配 edgeId
+    parallelFor(0, numFaces, [&](size_t f) {
+        size_t edgeId = faceEdgeOffsets[f];
+        for (size_t heId = 12 * f; heId < 12 * f + 12; ++heId) {
+            HalfEdge& he = newMesh.halfEdges[heId];
+            if (he.oppositeHalfEdgeId == INVALID_INDEX || he.oppositeHalfEdgeId > heId) {
+                he.edgeId = edgeId;
+                EdgeElement& edge = newMesh.edgeElements[edgeId];
+                edge.halfEdge1Id = heId;
+                edge.halfEdge1FromVertexId = he.fromVertexId;
+                edge.halfEdge1ToVertexId = he.toVertexId;
+                ++edgeId;
+            }
+        }
+    });
+
+    // 第三趟：其余半边沿用对向半边的 edgeId
+    parallelFor(0, newNumHalfEdges, [&](size_t heId) {
+        HalfEdge& he = newMesh.halfEdges[heId];
+        if (he.oppositeHalfEdgeId != INVALID_INDEX && he.oppositeHalfEdgeId < heId) {
+            he.edgeId = newMesh.halfEdges[he.oppositeHalfEdgeId].edgeId;
+            newMesh.edgeElements[he.edgeId].halfEdge2Id = heId;
+        }
+    });
+
+    if (isCancelled()) return Mesh();
+
+    // 子网格顶点邻接（CSR）的偏移：偶点沿用父顶点的出/入半边数，边点每侧父面各3条
+    newMesh.vertexOutgoingOffsets.assign(newNumVerts + 1, 0);
+    newMesh.vertexIncomingOffsets.assign(newNumVerts + 1, 0);
+    for (size_t v = 0; v < numVerts; ++v) {
+        newMesh.vertexOutgoingOffsets[v + 1] = newMesh.vertexOutgoingOffsets[v] + mesh.outgoingHalfEdges(v).size();
+        newMesh.vertexIncomingOffsets[v + 1] = newMesh.vertexIncomingOffsets[v] + mesh.incomingHalfEdges(v).size();
+    }
+    for (size_t e = 0; e < numEdges; ++e) {
+        size_t count = mesh.edgeElements[e].halfEdge2Id == INVALID_INDEX ? 3 : 6;
+        newMesh.vertexOutgoingOffsets[numVerts + e + 1] = newMesh.vertexOutgoingOffsets[numVerts + e] + count;
+        newMesh.vertexIncomingOffsets[numVerts + e + 1] = newMesh.vertexIncomingOffsets[numVerts + e] + count;
+    }
+    newMesh.vertexOutgoingHalfEdgeIds.resize(newMesh.vertexOutgoingOffsets[newNumVerts]);
+    newMesh.vertexIncomingHalfEdgeIds.resize(newMesh.vertexIncomingOffsets[newNumVerts]);
+
+    // 偶点：更新旧顶点位置，并由父网格的出/入半边表映射出子网格的出/入半边表
+    parallelFor(0, numVerts, [&](size_t v) {
+        newMesh.vertexElements[v].id = v;
+        const HalfEdgeRange parentOutgoing = mesh.outgoingHalfEdges(v);
+        const HalfEdgeRange parentIncoming = mesh.incomingHalfEdges(v);
+        size_t* outgoing = newMesh.vertexOutgoingHalfEdgeIds.data() + newMesh.vertexOutgoingOffsets[v];
+        size_t* incoming = newMesh.vertexIncomingHalfEdgeIds.data() + newMesh.vertexIncomingOffsets[v];
+        for (size_t heId : parentOutgoing) {
+            *outgoing++ = 12 * mesh.halfEdges[heId].faceId + firstHalfOffset(localIndex(heId));
+        }
+        for (size_t heId : parentIncoming) {
+            *incoming++ = 12 * mesh.halfEdges[heId].faceId + secondHalfOffset(localIndex(heId));
+        }
+
+        glm::vec3 newPos(0.0f), adjBoundaryPos(0.0f);
+        unsigned adjCount = 0, adjBoundaryCount = 0;
+        for (size_t heId : parentOutgoing) {
+            const HalfEdge& he = mesh.halfEdges[heId];
+            size_t neighborV = he.toVertexId;
+            if (mesh.edgeElements[he.edgeId].halfEdge2Id == INVALID_INDEX) {
+                adjBoundaryCount++;
+                adjBoundaryPos += mesh.vertices[neighborV].position;
+            }
+            newPos += mesh.vertices[neighborV].position;
+            adjCount++;
+        }
+
+        if (adjBoundaryCount == 2) {
+            newPos = 0.75f * mesh.vertices[v].position + 0.125f * adjBoundaryPos;
+        } else {
+            double beta = loopBeta(adjCount);
+            newPos = static_cast<float>((1.0 - beta * adjCount)) * mesh.vertices[v].position +
+                     static_cast<float>(beta) * glm::vec3(newPos);
+        }
+        newMesh.vertices[v].position = newPos;
+    }, 1024);
+
+    if (isCancelled()) return Mesh();
+
+    // 奇点：计算边点位置，并写出其出/入半边表（两侧父面依次排列，保持升序）
+    parallelFor(0, numEdges, [&](size_t e) {
+        const EdgeElement& parentEdge = mesh.edgeElements[e];
+        newMesh.vertexElements[numVerts + e].id = numVerts + e;
+
+        size_t sideHeIds[2] = { parentEdge.halfEdge1Id, parentEdge.halfEdge2Id };
+        size_t numSides = parentEdge.halfEdge2Id == INVALID_INDEX ? 1 : 2;
+        size_t* outgoing = newMesh.vertexOutgoingHalfEdgeIds.data() + newMesh.vertexOutgoingOffsets[numVerts + e];
+        size_t* incoming = newMesh.vertexIncomingHalfEdgeIds.data() + newMesh.vertexIncomingOffsets[numVerts + e];
+        for (size_t s = 0; s < numSides; ++s) {
+            size_t base = 12 * mesh.halfEdges[sideHeIds[s]].faceId;
+            size_t k = localIndex(sideHeIds[s]);
+            for (size_t j = 0; j < 3; ++j) {
+                *outgoing++ = base + midOutgoing[k][j];
+                *incoming++ = base + midIncoming[k][j];
+            }
+        }
+
+        const HalfEdge& he1 = mesh.halfEdges[parentEdge.halfEdge1Id];
+        glm::vec3 v1Pos = mesh.vertices[he1.fromVertexId].position;
+        glm::vec3 v2Pos = mesh.vertices[he1.toVertexId].position;
+        if (numSides == 1) {
+            newMesh.vertices[numVerts + e].position = 0.5f * (v1Pos + v2Pos);
+        } else {
+            const HalfEdge& he2 = mesh.halfEdges[parentEdge.halfEdge2Id];
+            glm::vec3 vNOpp1Pos = mesh.vertices[mesh.halfEdges[he1.nextHalfEdgeId].toVertexId].position;
+            glm::vec3 vNOpp2Pos = mesh.vertices[mesh.halfEdges[he2.nextHalfEdgeId].toVertexId].position;
+            newMesh.vertices[numVerts + e].position = 0.375f * (v1Pos + v2Pos) + 0.125f * (vNOpp1Pos + vNOpp2Pos);
+        }
+    }, 1024);
+
+    newMesh.invalidateHalfEdgeLookup(); // 半边按公式写出，addFace 所需的查找表在首次使用时重建
+    return newMesh;
+}
+
+#endif // LOOP_SUBDIVISION_H
@@ -6,13 +6,21 @@
 #include <sstream>
 #include <vector>
 #include <limits>
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <unordered_map>
 #include <unordered_set>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include "Shader/shader.h"
+#include "Parallel/ParallelFor.h"
+#include "Mesh/ObjReader.h"
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/gtc/type_ptr.hpp"
+#include "glm/gtc/packing.hpp"
 
 typedef glm::mat4x4 Mat4;
 typedef glm::vec3 Vec3;
@@ -28,6 +36,38 @@ struct Vertex {
     Vertex() : position(0.0f), normal(0.0f), texCoords(0.0f), quadric(0.0f) {}
 };
 
+// 上传到GPU的紧凑顶点格式（20字节）：位置 + 八面体编码法线（2 x snorm16）+ 半精度纹理坐标
+// 编辑用的 Vertex（含64字节的 quadric）只保留在CPU端，上传时再打包
+struct RenderVertex {
+    Vec3 position;
+    int16_t normalOct[2];
+    uint16_t texCoordsHalf[2];
+};
+
+// 单位向量的八面体编码，结果在 [-1, 1]^2
+inline Vec2 octEncode(Vec3 n) {
+    float l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    if (l1 <= 0.0f) return Vec2(0.0f);
+    n /= l1;
+    Vec2 e(n.x, n.y);
+    if (n.z < 0.0f) {
+        e.x = (1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+        e.y = (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+    }
+    return e;
+}
+
+inline RenderVertex packRenderVertex(const Vertex& vertex) {
+    RenderVertex packed;
+    packed.position = vertex.position;
+    Vec2 oct = octEncode(vertex.normal);
+    packed.normalOct[0] = static_cast<int16_t>(glm::packSnorm1x16(oct.x));
+    packed.normalOct[1] = static_cast<int16_t>(glm::packSnorm1x16(oct.y));
+    packed.texCoordsHalf[0] = glm::packHalf1x16(vertex.texCoords.x);
+    packed.texCoordsHalf[1] = glm::packHalf1x16(vertex.texCoords.y);
+    return packed;
+}
+
 struct Face {
     Vec4 normal;
     
@@ -44,12 +84,11 @@ struct Edge {
 
 constexpr size_t INVALID_INDEX = std::numeric_limits<size_t>::max();
 
+// 顶点的出/入半边存放在 Mesh 的 CSR 数组中（见 Mesh::outgoingHalfEdges / incomingHalfEdges）
 class VertexElement {
 public:
     size_t id;
     size_t smpfId;
-    std::vector<size_t> outgoingHalfEdgeIds;
-    std::vector<size_t> incomingHalfEdgeIds;
     bool deleted;
 
     VertexElement() : id(0), smpfId(INVALID_INDEX), deleted(false) {}
@@ -97,10 +136,44 @@ public:
           deleted(false) {}
 };
 
+// 面的顶点序列：三角形（最常见的情况）直接存放在对象内部，不单独分配内存；多于3个顶点时存放在堆上
+class FaceVertexIds {
+public:
+    FaceVertexIds() : count(0), inlineIds{} {}
+    FaceVertexIds(const std::vector<size_t>& ids) : FaceVertexIds() { assign(ids.begin(), ids.end()); }
+
+    template <typename Iterator>
+    void assign(Iterator first, Iterator last) {
+        count = static_cast<size_t>(std::distance(first, last));
+        if (count <= INLINE_CAPACITY) {
+            heapIds.clear();
+            std::copy(first, last, inlineIds);
+        } else {
+            heapIds.assign(first, last);
+        }
+    }
+    void assign(std::initializer_list<size_t> ids) { assign(ids.begin(), ids.end()); }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t* begin() { return count <= INLINE_CAPACITY ? inlineIds : heapIds.data(); }
+    size_t* end() { return begin() + count; }
+    const size_t* begin() const { return count <= INLINE_CAPACITY ? inlineIds : heapIds.data(); }
+    const size_t* end() const { return begin() + count; }
+    size_t& operator[](size_t i) { return begin()[i]; }
+    size_t operator[](size_t i) const { return begin()[i]; }
+
+private:
+    static constexpr size_t INLINE_CAPACITY = 3;
+    size_t count;
+    size_t inlineIds[INLINE_CAPACITY];
+    std::vector<size_t> heapIds;
+};
+
 class FaceElement {
 public:
     size_t startHalfEdgeId;
-    std::vector<size_t> vertexIds;
+    FaceVertexIds vertexIds;
     bool deleted;
 
     FaceElement() : startHalfEdgeId(INVALID_INDEX), deleted(false) {}
@@ -108,6 +181,18 @@ public:
         : startHalfEdgeId(startHeId), vertexIds(vids), deleted(false) {}
 };
 
+// CSR 数组中一段连续半边编号的只读视图
+struct HalfEdgeRange {
+    const size_t* first;
+    const size_t* last;
+
+    const size_t* begin() const { return first; }
+    const size_t* end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+    bool empty() const { return first == last; }
+    size_t operator[](size_t i) const { return first[i]; }
+};
+
 class Mesh {
 public:
     // 数据结构
@@ -120,6 +205,13 @@ public:
     std::vector<HalfEdge> halfEdges;
     std::vector<unsigned int> indices;
 
+    // 顶点邻接关系（CSR）：顶点 v 的出半边为 vertexOutgoingHalfEdgeIds[vertexOutgoingOffsets[v] .. vertexOutgoingOffsets[v+1])，
+    // 按半边编号升序排列（与逐面 addFace 的插入顺序一致）；入半边同理
+    std::vector<size_t> vertexOutgoingOffsets;
+    std::vector<size_t> vertexOutgoingHalfEdgeIds;
+    std::vector<size_t> vertexIncomingOffsets;
+    std::vector<size_t> vertexIncomingHalfEdgeIds;
+
     // OpenGL相关
     unsigned int VAO;
     unsigned int VBO, EBO;
@@ -145,6 +237,191 @@ public:
         faceElements.clear();
         halfEdges.clear();
         indices.clear();
+        vertexOutgoingOffsets.assign(1, 0);
+        vertexOutgoingHalfEdgeIds.clear();
+        vertexIncomingOffsets.assign(1, 0);
+        vertexIncomingHalfEdgeIds.clear();
+        halfEdgeLookup.clear();
+        halfEdgeLookupValid = true;
+        adjacencyDirty = false;
+    }
+
+    // 顶点 v 的出半边 / 入半边
+    HalfEdgeRange outgoingHalfEdges(size_t v) const {
+        const size_t* base = vertexOutgoingHalfEdgeIds.data();
+        return { base + vertexOutgoingOffsets[v], base + vertexOutgoingOffsets[v + 1] };
+    }
+
+    HalfEdgeRange incomingHalfEdges(size_t v) const {
+        const size_t* base = vertexIncomingHalfEdgeIds.data();
+        return { base + vertexIncomingOffsets[v], base + vertexIncomingOffsets[v + 1] };
+    }
+
+    // 由半边数组重建顶点邻接的 CSR 数组（计数排序，O(V + H)）
+    // 逐个 addVertex / addFace 构建网格后，需在使用邻接关系前调用一次
+    void buildVertexAdjacency() {
+        const size_t numVerts = vertexElements.size();
+        vertexOutgoingOffsets.assign(numVerts + 1, 0);
+        vertexIncomingOffsets.assign(numVerts + 1, 0);
+        for (const HalfEdge& he : halfEdges) {
+            vertexOutgoingOffsets[he.fromVertexId + 1]++;
+            vertexIncomingOffsets[he.toVertexId + 1]++;
+        }
+        for (size_t v = 0; v < numVerts; ++v) {
+            vertexOutgoingOffsets[v + 1] += vertexOutgoingOffsets[v];
+            vertexIncomingOffsets[v + 1] += vertexIncomingOffsets[v];
+        }
+
+        vertexOutgoingHalfEdgeIds.resize(halfEdges.size());
+        vertexIncomingHalfEdgeIds.resize(halfEdges.size());
+        std::vector<size_t> outCursor(vertexOutgoingOffsets.begin(), vertexOutgoingOffsets.end() - 1);
+        std::vector<size_t> inCursor(vertexIncomingOffsets.begin(), vertexIncomingOffsets.end() - 1);
+        for (size_t heId = 0; heId < halfEdges.size(); ++heId) {
+            vertexOutgoingHalfEdgeIds[outCursor[halfEdges[heId].fromVertexId]++] = heId;
+            vertexIncomingHalfEdgeIds[inCursor[halfEdges[heId].toVertexId]++] = heId;
+        }
+        adjacencyDirty = false;
+    }
+
+    bool isAdjacencyDirty() const { return adjacencyDirty; }
+
+    // 直接写入半边数组（不经过 addFace）后调用：有向边查找表在下一次 addFace 时按半边编号重建
+    void invalidateHalfEdgeLookup() {
+        halfEdgeLookup.clear();
+        halfEdgeLookupValid = false;
+    }
+
+    // 由顶点坐标和三角形索引批量构建网格（每3个索引一个面）
+    // 对向半边通过按端点分桶、桶内排序一次性配对，不再逐面查找；
+    // 结果与按相同顺序逐面调用 addFace 得到的半边连接关系完全一致
+    static Mesh buildFromIndexBuffer(const std::vector<Vec3>& positions, const std::vector<unsigned int>& triangleIndices) {
+        Mesh mesh;
+        const size_t numVerts = positions.size();
+        const size_t numFaces = triangleIndices.size() / 3;
+        const size_t numHalfEdges = 3 * numFaces;
+
+        for (unsigned int idx : triangleIndices) {
+            if (idx >= numVerts) {
+                std::cerr << "Error: Vertex index " << idx << " out of range!" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        mesh.vertices.resize(numVerts);
+        mesh.vertexElements.resize(numVerts);
+        parallelFor(0, numVerts, [&](size_t v) {
+            mesh.vertices[v].position = positions[v];
+            mesh.vertexElements[v].id = v;
+        });
+
+        // 半边与面
+        mesh.halfEdges.resize(numHalfEdges);
+        mesh.faceElements.resize(numFaces);
+        mesh.faces.resize(numFaces);
+        mesh.indices.assign(triangleIndices.begin(), triangleIndices.begin() + numHalfEdges);
+        parallelFor(0, numFaces, [&](size_t f) {
+            for (size_t i = 0; i < 3; ++i) {
+                size_t heId = 3 * f + i;
+                HalfEdge& he = mesh.halfEdges[heId];
+                he.id = heId;
+                he.fromVertexId = triangleIndices[heId];
+                he.toVertexId = triangleIndices[3 * f + (i + 1) % 3];
+                he.prevHalfEdgeId = 3 * f + (i + 2) % 3;
+                he.nextHalfEdgeId = 3 * f + (i + 1) % 3;
+                he.faceId = f;
+            }
+            FaceElement& face = mesh.faceElements[f];
+            face.startHalfEdgeId = 3 * f;
+            face.vertexIds.assign({ triangleIndices[3 * f], triangleIndices[3 * f + 1], triangleIndices[3 * f + 2] });
+        });
+
+        // 按较小端点分桶（计数排序），桶内按 (较大端点, 方向, 编号) 排序，同一无向边的半边即相邻
+        std::vector<size_t> bucketOffsets(numVerts + 1, 0);
+        for (const HalfEdge& he : mesh.halfEdges) {
+            bucketOffsets[std::min(he.fromVertexId, he.toVertexId) + 1]++;
+        }
+        for (size_t v = 0; v < numVerts; ++v) {
+            bucketOffsets[v + 1] += bucketOffsets[v];
+        }
+        std::vector<size_t> sorted(numHalfEdges);
+        {
+            std::vector<size_t> cursor(bucketOffsets.begin(), bucketOffsets.end() - 1);
+            for (size_t heId = 0; heId < numHalfEdges; ++heId) {
+                const HalfEdge& he = mesh.halfEdges[heId];
+                sorted[cursor[std::min(he.fromVertexId, he.toVertexId)]++] = heId;
+            }
+        }
+        auto sortKey = [&mesh](size_t heId) {
+            const HalfEdge& he = mesh.halfEdges[heId];
+            return std::make_tuple(std::max(he.fromVertexId, he.toVertexId), he.fromVertexId > he.toVertexId, heId);
+        };
+        parallelFor(0, numVerts, [&](size_t v) {
+            std::sort(sorted.begin() + bucketOffsets[v], sorted.begin() + bucketOffsets[v + 1],
+                      [&sortKey](size_t a, size_t b) { return sortKey(a) < sortKey(b); });
+        }, 1024);
+
+        // 按 addFace 的规则确定对向半边：
+        // 插入半边 x(a->b) 时取已存在的第一条 b->a（反向组中编号最小者 minR，要求 minR < x）；
+        // 同时 minR 的对向半边被改写为 x，因此正向组中编号最小者最终指向反向组中编号最大者
+        std::vector<size_t> lookupTarget(numHalfEdges, INVALID_INDEX);
+        auto pairGroup = [&](size_t gBegin, size_t gEnd, size_t rBegin, size_t rEnd) {
+            if (gBegin == gEnd || rBegin == rEnd) return;
+            size_t minR = sorted[rBegin], maxR = sorted[rEnd - 1];
+            for (size_t k = gBegin; k < gEnd; ++k) {
+                size_t x = sorted[k];
+                if (minR < x) {
+                    lookupTarget[x] = minR;
+                    mesh.halfEdges[x].oppositeHalfEdgeId = minR;
+                }
+            }
+            size_t minG = sorted[gBegin];
+            if (maxR > minG) {
+                mesh.halfEdges[minG].oppositeHalfEdgeId = maxR;
+            }
+        };
+        parallelFor(0, numVerts, [&](size_t v) {
+            size_t groupBegin = bucketOffsets[v];
+            const size_t bucketEnd = bucketOffsets[v + 1];
+            while (groupBegin < bucketEnd) {
+                const HalfEdge& first = mesh.halfEdges[sorted[groupBegin]];
+                size_t other = std::max(first.fromVertexId, first.toVertexId);
+                size_t groupEnd = groupBegin, split = groupBegin;
+                while (groupEnd < bucketEnd) {
+                    const HalfEdge& he = mesh.halfEdges[sorted[groupEnd]];
+                    if (std::max(he.fromVertexId, he.toVertexId) != other) break;
+                    if (he.fromVertexId <= he.toVertexId) split = groupEnd + 1;
+                    ++groupEnd;
+                }
+                if (v == other) {
+                    pairGroup(groupBegin, groupEnd, groupBegin, groupEnd); // 自环：正反向为同一组
+                } else {
+                    pairGroup(groupBegin, split, split, groupEnd);
+                    pairGroup(split, groupEnd, groupBegin, split);
+                }
+                groupBegin = groupEnd;
+            }
+        }, 1024);
+
+        // 按半边编号顺序分配边：找不到对向半边的半边新建边，其余沿用目标半边的边
+        mesh.edgeElements.reserve(numHalfEdges / 2 + 1);
+        for (size_t heId = 0; heId < numHalfEdges; ++heId) {
+            HalfEdge& he = mesh.halfEdges[heId];
+            if (lookupTarget[heId] == INVALID_INDEX) {
+                he.edgeId = mesh.edgeElements.size();
+                EdgeElement newEdge(heId);
+                newEdge.halfEdge1FromVertexId = he.fromVertexId;
+                newEdge.halfEdge1ToVertexId = he.toVertexId;
+                mesh.edgeElements.emplace_back(newEdge);
+            } else {
+                he.edgeId = mesh.halfEdges[lookupTarget[heId]].edgeId;
+                mesh.edgeElements[he.edgeId].halfEdge2Id = heId;
+            }
+        }
+        mesh.edges.resize(mesh.edgeElements.size());
+
+        mesh.buildVertexAdjacency();
+        mesh.invalidateHalfEdgeLookup(); // 需要时由 addFace 重建
+        return mesh;
     }
 
     // 添加顶点
@@ -154,10 +431,12 @@ public:
         size_t vertexId = vertexElements.size();
         vertices.push_back(vertex);
         vertexElements.emplace_back(vertexId);
+        adjacencyDirty = true;
         return vertexId;
     }
 
     // 添加面（确保顶点序列为逆时针且法向量朝外）
+    // 对向半边通过有向边哈希表 O(1) 查找；全部面添加完后需调用 buildVertexAdjacency
     size_t addFace(const std::vector<size_t>& vertexIds) {
         size_t numVertices = vertexIds.size();
         if (numVertices < 3) {
@@ -168,6 +447,10 @@ public:
         size_t faceId = faceElements.size();
         size_t startHalfEdgeId = halfEdges.size();
 
+        if (!halfEdgeLookupValid) {
+            rebuildHalfEdgeLookup();
+        }
+
         // 为每个边创建半边
         for (size_t i = 0; i < numVertices; ++i) {
             HalfEdge he;
@@ -176,19 +459,15 @@ public:
             he.fromVertexId = vertexIds[i];
             he.toVertexId = vertexIds[(i + 1) % numVertices];
 
-            // 查找对应的对向半边
-            for (size_t oppoHeId : vertexElements[he.fromVertexId].incomingHalfEdgeIds) {
-                const HalfEdge& oppoHe = halfEdges[oppoHeId];
-                if (oppoHe.fromVertexId == he.toVertexId) {
-                    he.oppositeHalfEdgeId = oppoHeId;
-                    halfEdges[oppoHeId].oppositeHalfEdgeId = currentHalfEdgeId;
-                    break;
-                }
+            // 查找对应的对向半边（最早插入的 to->from 半边）
+            auto oppoIt = halfEdgeLookup.find(directedKey(he.toVertexId, he.fromVertexId));
+            if (oppoIt != halfEdgeLookup.end()) {
+                size_t oppoHeId = oppoIt->second;
+                he.oppositeHalfEdgeId = oppoHeId;
+                halfEdges[oppoHeId].oppositeHalfEdgeId = currentHalfEdgeId;
             }
+            halfEdgeLookup.emplace(directedKey(he.fromVertexId, he.toVertexId), currentHalfEdgeId);
 
-            // 更新顶点的半边列表
-            vertexElements[he.fromVertexId].outgoingHalfEdgeIds.push_back(currentHalfEdgeId);
-            vertexElements[he.toVertexId].incomingHalfEdgeIds.push_back(currentHalfEdgeId);
             he.faceId = faceId;
             he.prevHalfEdgeId = (i == 0) ? (currentHalfEdgeId - 1 + numVertices) : (currentHalfEdgeId - 1);
             he.nextHalfEdgeId = (i == numVertices - 1) ? (currentHalfEdgeId + 1 - numVertices) : (currentHalfEdgeId + 1);
@@ -213,12 +492,20 @@ public:
         // 添加面
         faceElements.emplace_back(startHalfEdgeId, vertexIds);
         faces.emplace_back(); // 添加空的面数据
+        adjacencyDirty = true;
 
         return startHalfEdgeId;
     }
 
     // 设置OpenGL相关的缓冲区
     void setupMesh() {
+        // 加载顶点数据（打包为紧凑格式后上传）
+        std::vector<RenderVertex> renderVertices = buildRenderVertices();
+        setupMesh(renderVertices.data(), renderVertices.size(), indices.data(), indices.size());
+    }
+
+    // 由现成的GPU顶点流与索引创建缓冲（如 MeshCache 映射的内存）
+    void setupMesh(const RenderVertex* renderVertices, size_t vertexCount, const unsigned int* indexData, size_t indexCount) {
         // 生成缓冲区和数组对象
         glGenVertexArrays(1, &VAO);
         glGenBuffers(1, &VBO);
@@ -226,28 +513,47 @@ public:
 
         glBindVertexArray(VAO);
 
-        // 加载顶点数据
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(RenderVertex), renderVertices, GL_STATIC_DRAW);
 
         // 加载索引数据
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(unsigned int), indexData, GL_STATIC_DRAW);
 
         // 设置顶点属性指针
         // 位置
         glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-        // 法线
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(RenderVertex), (void*)0);
+        // 法线（八面体编码，着色器中解码）
         glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
-        // 纹理坐标
+        glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(RenderVertex), (void*)offsetof(RenderVertex, normalOct));
+        // 纹理坐标（半精度）
         glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoords));
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(RenderVertex), (void*)offsetof(RenderVertex, texCoordsHalf));
 
         glBindVertexArray(0);
     }
 
+    // 更新顶点位置并重新上传顶点缓冲（拓扑不变，需先调用过 setupMesh）
+    void updatePositions(const std::vector<Vec3>& positions) {
+        for (size_t i = 0; i < vertices.size() && i < positions.size(); ++i) {
+            vertices[i].position = positions[i];
+        }
+        std::vector<RenderVertex> renderVertices = buildRenderVertices();
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, renderVertices.size() * sizeof(RenderVertex), renderVertices.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // 把编辑用顶点打包为GPU顶点流
+    std::vector<RenderVertex> buildRenderVertices() const {
+        std::vector<RenderVertex> renderVertices(vertices.size());
+        parallelFor(0, vertices.size(), [&](size_t i) {
+            renderVertices[i] = packRenderVertex(vertices[i]);
+        });
+        return renderVertices;
+    }
+
     // 绘制网格
     void draw(Shader& shader) const {
         glBindVertexArray(VAO);
@@ -257,43 +563,37 @@ public:
     }
 
 private:
-    // 从文件加载数据
-    void loadFromFile(const std::string& filename) {
-        std::ifstream fin(filename);
-        if (!fin.is_open()) {
-            std::cerr << "Error: Failed to open file " << filename << std::endl;
-            return;
+    friend class MeshCache; // 由缓存直接填充数组时设置下面的状态
+
+    // addFace 使用的有向边查找表：(from, to) -> 最早插入的该方向半边
+    std::unordered_map<uint64_t, size_t> halfEdgeLookup;
+    bool halfEdgeLookupValid;
+    bool adjacencyDirty;
+
+    static uint64_t directedKey(size_t fromVertexId, size_t toVertexId) {
+        return (static_cast<uint64_t>(fromVertexId) << 32) | static_cast<uint64_t>(toVertexId);
+    }
+
+    // 批量构建的网格没有查找表，首次 addFace 时按半边编号顺序补建
+    void rebuildHalfEdgeLookup() {
+        halfEdgeLookup.clear();
+        halfEdgeLookup.reserve(halfEdges.size());
+        for (const HalfEdge& he : halfEdges) {
+            halfEdgeLookup.emplace(directedKey(he.fromVertexId, he.toVertexId), he.id);
         }
+        halfEdgeLookupValid = true;
+    }
 
-        std::string line;
-        Vec3 vertexPosition;
-        std::vector<size_t> faceVertexIndices(3, INVALID_INDEX);
-
-        while (std::getline(fin, line)) {
-            if (line.empty()) continue; // 跳过空行
-
-            std::istringstream stream(line);
-            char prefix;
-            stream >> prefix;
-
-            if (prefix == 'v') { // 顶点
-                stream >> vertexPosition.x >> vertexPosition.y >> vertexPosition.z;
-                addVertex(vertexPosition);
-            } else if (prefix == 'f') { // 面
-                stream >> faceVertexIndices[0] >> faceVertexIndices[1] >> faceVertexIndices[2];
-                // 转换为0基索引
-                for (size_t& idx : faceVertexIndices) {
-                    if (idx == 0) {
-                        std::cerr << "Error: Vertex indices in OBJ files should start from 1." << std::endl;
-                        exit(EXIT_FAILURE);
-                    }
-                    --idx;
-                }
-                addFace(faceVertexIndices);
-            }
+    // 从文件加载数据（多边形按扇形三角化）
+    void loadFromFile(const std::string& filename) {
+        ObjData obj;
+        if (!readObj(filename, obj)) {
+            return;
         }
+        std::vector<unsigned int> triangleIndices = obj.triangulate();
 
-        fin.close();
+        // 读完后一次性构建半边结构
+        *this = buildFromIndexBuffer(obj.positions, triangleIndices);
     }
 };
 
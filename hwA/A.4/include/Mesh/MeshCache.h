@@ -0,0 +1,433 @@
+/*
+ * MeshCache.h
+ *
+ * 网格的二进制缓存：把 Mesh 的坐标、索引、GPU 顶点流以及半边连接数组按内存布局原样写入文件，
+ * 下次启动时内存映射后逐段整体复制（多线程 memcpy），无需解析 OBJ、也无需重建半边结构。
+ *
+ * 文件布局（小端，所有段按 64 字节对齐）：
+ *   Header   魔数、版本、字节序标记、各结构体大小（布局不一致时视为失效）、
+ *            源文件大小与修改时间、段数
+ *   Section  段表：段编号、元素大小、偏移、元素个数、内容校验和
+ *   数据段   POSITIONS / RENDER_VERTICES / INDICES / FACE_STARTS / HALF_EDGES / EDGE_ELEMENTS /
+ *            顶点出入半边的 CSR 数组
+ *
+ * - 源文件的大小或修改时间与缓存记录不一致、版本或布局不一致、段的元素大小不符时 open 返回 false，
+ *   调用方重新解析并覆盖缓存；启动时不读取源文件内容
+ * - 段校验和只在 open 的 verifyChecksums 为 true 时检查（需要读完整个缓存文件，默认不检查）；
+ *   load 总会检查所有编号（面起点、半边 / 边的引用、CSR 偏移、顶点索引）都在范围内，
+ *   损坏的缓存返回 false 而不会越界访问
+ * - RENDER_VERTICES 与 INDICES 段可直接交给 glBufferData（见 Mesh::setupMesh 的重载）
+ * - 面的顶点序列由 INDICES 段批量生成，三角形不单独分配内存（见 FaceVertexIds）
+ * - 写入先写临时文件再重命名，避免中断时留下半个缓存
+ *
+ * 撰写者：Zhiyuan Feng
+ */
+
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "Mesh/Mesh.h"
+#include "Mesh/ObjReader.h"
+#include "Parallel/ParallelFor.h"
+
+// 并行计算的 64 位内容哈希：每 1MB 一块，块内按 8 字节做乘法-异或混合，块哈希按顺序合并
+inline uint64_t hashBytes(const void* data, size_t size) {
+    constexpr size_t BLOCK = 1 << 20;
+    constexpr uint64_t PRIME = 0x9E3779B97F4A7C15ull;
+    auto mix = [](uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        return h;
+    };
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    const size_t numBlocks = (size + BLOCK - 1) / BLOCK;
+    std::vector<uint64_t> blockHashes(numBlocks);
+    parallelFor(0, numBlocks, [&](size_t b) {
+        const unsigned char* p = bytes + b * BLOCK;
+        const size_t n = std::min(BLOCK, size - b * BLOCK);
+        uint64_t h = PRIME ^ n;
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, p + i, 8);
+            h = (h ^ mix(word)) * PRIME;
+        }
+        uint64_t tail = 0;
+        std::memcpy(&tail, p + i, n - i);
+        blockHashes[b] = mix((h ^ mix(tail)) * PRIME);
+    }, 4);
+    uint64_t h = mix(size * PRIME);
+    for (uint64_t blockHash : blockHashes) {
+        h = mix((h ^ blockHash) * PRIME);
+    }
+    return h;
+}
+
+class MeshCache {
+public:
+    static constexpr uint32_t VERSION = 2;
+
+    // 段编号
+    enum SectionId : uint32_t {
+        POSITIONS = 0,
+        RENDER_VERTICES,
+        INDICES,
+        FACE_STARTS,
+        HALF_EDGES,
+        EDGE_ELEMENTS,
+        VERTEX_OUTGOING_OFFSETS,
+        VERTEX_OUTGOING_IDS,
+        VERTEX_INCOMING_OFFSETS,
+        VERTEX_INCOMING_IDS,
+        SECTION_COUNT
+    };
+
+    // 源文件对应的缓存路径
+    static std::string cachePath(const std::string& sourcePath) { return sourcePath + ".meshcache"; }
+
+    // 源文件的大小与修改时间（失败时返回 false）
+    static bool sourceStamp(const std::string& sourcePath, uint64_t& size, int64_t& time) {
+        std::error_code error;
+        size = std::filesystem::file_size(sourcePath, error);
+        if (error) return false;
+        time = static_cast<int64_t>(std::filesystem::last_write_time(sourcePath, error).time_since_epoch().count());
+        return !error;
+    }
+
+    // 把 mesh 写入缓存文件
+    static bool save(const std::string& path, const Mesh& mesh, uint64_t sourceSize, int64_t sourceTime) {
+        std::vector<size_t> faceStarts(mesh.faceElements.size());
+        for (size_t f = 0; f < faceStarts.size(); ++f) {
+            faceStarts[f] = mesh.faceElements[f].startHalfEdgeId;
+        }
+        std::vector<Vec3> positions(mesh.vertices.size());
+        for (size_t v = 0; v < positions.size(); ++v) {
+            positions[v] = mesh.vertices[v].position;
+        }
+        std::vector<RenderVertex> renderVertices = mesh.buildRenderVertices();
+
+        struct Source { const void* data; size_t elementSize; size_t count; };
+        const Source sources[SECTION_COUNT] = {
+            { positions.data(), sizeof(Vec3), positions.size() },
+            { renderVertices.data(), sizeof(RenderVertex), renderVertices.size() },
+            { mesh.indices.data(), sizeof(unsigned int), mesh.indices.size() },
+            { faceStarts.data(), sizeof(size_t), faceStarts.size() },
+            { mesh.halfEdges.data(), sizeof(HalfEdge), mesh.halfEdges.size() },
+            { mesh.edgeElements.data(), sizeof(EdgeElement), mesh.edgeElements.size() },
+            { mesh.vertexOutgoingOffsets.data(), sizeof(size_t), mesh.vertexOutgoingOffsets.size() },
+            { mesh.vertexOutgoingHalfEdgeIds.data(), sizeof(size_t), mesh.vertexOutgoingHalfEdgeIds.size() },
+            { mesh.vertexIncomingOffsets.data(), sizeof(size_t), mesh.vertexIncomingOffsets.size() },
+            { mesh.vertexIncomingHalfEdgeIds.data(), sizeof(size_t), mesh.vertexIncomingHalfEdgeIds.size() },
+        };
+
+        Header header = makeHeader();
+        header.sourceSize = sourceSize;
+        header.sourceTime = sourceTime;
+        Section sections[SECTION_COUNT];
+        uint64_t offset = alignUp(sizeof(Header) + sizeof(sections));
+        for (uint32_t s = 0; s < SECTION_COUNT; ++s) {
+            sections[s].id = s;
+            sections[s].elementSize = static_cast<uint32_t>(sources[s].elementSize);
+            sections[s].offset = offset;
+            sections[s].count = sources[s].count;
+            sections[s].checksum = hashBytes(sources[s].data, sources[s].elementSize * sources[s].count);
+            offset = alignUp(offset + sources[s].elementSize * sources[s].count);
+        }
+        header.fileSize = offset;
+
+        const std::string tempPath = path + ".tmp";
+        {
+            std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+            if (!out.is_open()) {
+                std::cerr << "Error: Failed to write mesh cache " << path << std::endl;
+                return false;
+            }
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(reinterpret_cast<const char*>(sections), sizeof(sections));
+            uint64_t written = sizeof(header) + sizeof(sections);
+            static const char zeros[ALIGNMENT] = {};
+            for (uint32_t s = 0; s < SECTION_COUNT; ++s) {
+                out.write(zeros, static_cast<std::streamsize>(sections[s].offset - written));
+                out.write(static_cast<const char*>(sources[s].data), static_cast<std::streamsize>(sources[s].elementSize * sources[s].count));
+                written = sections[s].offset + sources[s].elementSize * sources[s].count;
+            }
+            out.write(zeros, static_cast<std::streamsize>(header.fileSize - written));
+            if (!out) {
+                std::cerr << "Error: Failed to write mesh cache " << path << std::endl;
+                return false;
+            }
+        }
+        std::remove(path.c_str());
+        if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // 映射缓存文件并校验；与源文件不一致或损坏时返回 false
+    bool open(const std::string& path, uint64_t sourceSize, int64_t sourceTime, bool verifyChecksums = false) {
+        file.reset(new MappedFile(path));
+        if (!file->isOpen() || file->length() < sizeof(Header) + sizeof(Section) * SECTION_COUNT) return fail();
+
+        Header header;
+        std::memcpy(&header, file->begin(), sizeof(header));
+        const Header expected = makeHeader();
+        if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 || header.version != expected.version ||
+            header.byteOrder != expected.byteOrder || std::memcmp(header.layout, expected.layout, sizeof(header.layout)) != 0 ||
+            header.sectionCount != SECTION_COUNT || header.fileSize != file->length()) {
+            return fail();
+        }
+        if (header.sourceSize != sourceSize || header.sourceTime != sourceTime) return fail();
+
+        std::memcpy(sections, file->begin() + sizeof(Header), sizeof(sections));
+        const uint32_t* expectedSizes = elementSizes();
+        for (uint32_t s = 0; s < SECTION_COUNT; ++s) {
+            const Section& section = sections[s];
+            if (section.id != s || section.offset % ALIGNMENT != 0 || section.elementSize != expectedSizes[s] ||
+                section.count > (file->length() - std::min<uint64_t>(section.offset, file->length())) / section.elementSize) {
+                return fail();
+            }
+        }
+        if (verifyChecksums) {
+            for (uint32_t s = 0; s < SECTION_COUNT; ++s) {
+                if (hashBytes(sectionData(s), sections[s].elementSize * sections[s].count) != sections[s].checksum) {
+                    return fail();
+                }
+            }
+        }
+        return true;
+    }
+
+    // 由缓存填充 mesh（各段整体复制，不做解析）
+    bool load(Mesh& mesh) const {
+        if (!file) return false;
+        const size_t numVerts = sections[POSITIONS].count;
+        const size_t numFaces = sections[FACE_STARTS].count;
+        if (sections[VERTEX_OUTGOING_OFFSETS].count != numVerts + 1 || sections[VERTEX_INCOMING_OFFSETS].count != numVerts + 1 ||
+            sections[RENDER_VERTICES].count != numVerts) {
+            return false;
+        }
+
+        const Vec3* positions = sectionAs<Vec3>(POSITIONS);
+        const size_t* faceStarts = sectionAs<size_t>(FACE_STARTS);
+        mesh.clearData();
+        if (positions == nullptr || faceStarts == nullptr ||
+            !copySection(HALF_EDGES, mesh.halfEdges) || !copySection(EDGE_ELEMENTS, mesh.edgeElements) ||
+            !copySection(INDICES, mesh.indices) ||
+            !copySection(VERTEX_OUTGOING_OFFSETS, mesh.vertexOutgoingOffsets) ||
+            !copySection(VERTEX_OUTGOING_IDS, mesh.vertexOutgoingHalfEdgeIds) ||
+            !copySection(VERTEX_INCOMING_OFFSETS, mesh.vertexIncomingOffsets) ||
+            !copySection(VERTEX_INCOMING_IDS, mesh.vertexIncomingHalfEdgeIds) ||
+            !validate(mesh, numVerts, faceStarts, numFaces)) {
+            std::cerr << "Error: Mesh cache is corrupt, rebuilding it" << std::endl;
+            mesh.clearData();
+            return false;
+        }
+
+        mesh.vertices.resize(numVerts);
+        mesh.vertexElements.resize(numVerts);
+        parallelFor(0, numVerts, [&](size_t v) {
+            std::memcpy(&mesh.vertices[v].position, positions + v, sizeof(Vec3));
+            mesh.vertexElements[v].id = v;
+        });
+
+        // 面的顶点序列即 indices 中从 startHalfEdgeId 起的一段（三角形存放在 FaceElement 内部，不分配内存）
+        mesh.faceElements.resize(numFaces);
+        mesh.faces.resize(numFaces);
+        mesh.edges.resize(mesh.edgeElements.size());
+        parallelFor(0, numFaces, [&](size_t f) {
+            size_t start, end;
+            std::memcpy(&start, faceStarts + f, sizeof(size_t));
+            if (f + 1 < numFaces) std::memcpy(&end, faceStarts + f + 1, sizeof(size_t));
+            else end = mesh.indices.size();
+            FaceElement& face = mesh.faceElements[f];
+            face.startHalfEdgeId = start;
+            face.vertexIds.assign(mesh.indices.begin() + start, mesh.indices.begin() + end);
+        });
+        mesh.invalidateHalfEdgeLookup();
+        mesh.adjacencyDirty = false;
+        return true;
+    }
+
+    // 可直接上传的GPU顶点流与索引（指向映射内存，缓存对象存活期间有效）
+    const RenderVertex* renderVertices() const { return sectionAs<RenderVertex>(RENDER_VERTICES); }
+    size_t renderVertexCount() const { return sections[RENDER_VERTICES].count; }
+    const unsigned int* indices() const { return sectionAs<unsigned int>(INDICES); }
+    size_t indexCount() const { return sections[INDICES].count; }
+
+private:
+    static constexpr uint64_t ALIGNMENT = 64;
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint32_t layout[8];     // 各结构体大小，防止不同编译器/平台的缓存被误用
+        uint64_t sourceSize;
+        int64_t sourceTime;     // 源文件修改时间（file_time_type 的计数）
+        uint64_t fileSize;
+        uint32_t sectionCount;
+        uint32_t reserved;
+    };
+
+    struct Section {
+        uint32_t id;
+        uint32_t elementSize;
+        uint64_t offset;
+        uint64_t count;
+        uint64_t checksum;
+    };
+
+    static_assert(std::is_trivially_copyable<HalfEdge>::value, "HalfEdge must be trivially copyable");
+    static_assert(std::is_trivially_copyable<EdgeElement>::value, "EdgeElement must be trivially copyable");
+
+    std::unique_ptr<MappedFile> file;
+    Section sections[SECTION_COUNT] = {};
+
+    static uint64_t alignUp(uint64_t offset) { return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT; }
+
+    static Header makeHeader() {
+        Header header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, "HEMESH\0", 8);
+        header.version = VERSION;
+        header.byteOrder = 0x01020304u;
+        header.layout[0] = sizeof(size_t);
+        header.layout[1] = sizeof(Vec3);
+        header.layout[2] = sizeof(RenderVertex);
+        header.layout[3] = sizeof(HalfEdge);
+        header.layout[4] = sizeof(EdgeElement);
+        header.layout[5] = sizeof(unsigned int);
+        header.sectionCount = SECTION_COUNT;
+        return header;
+    }
+
+    // 各段的元素大小，须与文件中记录的一致（不同编译器或版本生成的缓存不会被误读）
+    static const uint32_t* elementSizes() {
+        static const uint32_t sizes[SECTION_COUNT] = {
+            sizeof(Vec3), sizeof(RenderVertex), sizeof(unsigned int), sizeof(size_t), sizeof(HalfEdge),
+            sizeof(EdgeElement), sizeof(size_t), sizeof(size_t), sizeof(size_t), sizeof(size_t),
+        };
+        return sizes;
+    }
+
+    // 所有区间 [0, n) 上 pred(i) 都成立（按块并行，某块失败后其余块尽早结束）
+    template <typename Pred>
+    static bool allOf(size_t n, Pred&& pred) {
+        std::atomic<bool> ok(true);
+        parallelForRange(0, n, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end && ok.load(std::memory_order_relaxed); ++i) {
+                if (!pred(i)) ok = false;
+            }
+        });
+        return ok;
+    }
+
+    // 检查从缓存复制出的编号都在范围内，使面与邻接关系的访问不会越界
+    static bool validate(const Mesh& mesh, size_t numVerts, const size_t* faceStarts, size_t numFaces) {
+        const size_t numHalfEdges = mesh.halfEdges.size();
+        const size_t numEdges = mesh.edgeElements.size();
+        auto optional = [numHalfEdges](size_t id) { return id == INVALID_INDEX || id < numHalfEdges; };
+        if (mesh.indices.size() != numHalfEdges || (numFaces == 0) != (numHalfEdges == 0)) return false;
+
+        // 面起点从 0 开始严格递增，最后一个面也至少有一个角
+        const bool facesOk = allOf(numFaces, [&](size_t f) {
+            size_t start, end = numHalfEdges;
+            std::memcpy(&start, faceStarts + f, sizeof(size_t));
+            if (f + 1 < numFaces) std::memcpy(&end, faceStarts + f + 1, sizeof(size_t));
+            return (f != 0 || start == 0) && start < end && end <= numHalfEdges;
+        });
+        const bool indicesOk = allOf(numHalfEdges, [&](size_t i) { return mesh.indices[i] < numVerts; });
+        const bool halfEdgesOk = allOf(numHalfEdges, [&](size_t i) {
+            const HalfEdge& he = mesh.halfEdges[i];
+            return he.id == i && he.fromVertexId < numVerts && he.toVertexId < numVerts && he.faceId < numFaces &&
+                   he.prevHalfEdgeId < numHalfEdges && he.nextHalfEdgeId < numHalfEdges && he.edgeId < numEdges &&
+                   optional(he.oppositeHalfEdgeId);
+        });
+        const bool edgesOk = allOf(numEdges, [&](size_t e) {
+            const EdgeElement& edge = mesh.edgeElements[e];
+            return edge.halfEdge1Id < numHalfEdges && optional(edge.halfEdge2Id);
+        });
+        // CSR：偏移从 0 开始单调不减，末尾等于编号数组长度，编号都是有效半边
+        auto csrOk = [&](const std::vector<size_t>& offsets, const std::vector<size_t>& ids) {
+            return offsets.size() == numVerts + 1 && offsets.front() == 0 && offsets.back() == ids.size() &&
+                   allOf(numVerts, [&](size_t v) { return offsets[v] <= offsets[v + 1]; }) &&
+                   allOf(ids.size(), [&](size_t i) { return ids[i] < numHalfEdges; });
+        };
+        return facesOk && indicesOk && halfEdgesOk && edgesOk &&
+               csrOk(mesh.vertexOutgoingOffsets, mesh.vertexOutgoingHalfEdgeIds) &&
+               csrOk(mesh.vertexIncomingOffsets, mesh.vertexIncomingHalfEdgeIds);
+    }
+
+    bool fail() {
+        file.reset();
+        return false;
+    }
+
+    const char* sectionData(uint32_t s) const { return file->begin() + sections[s].offset; }
+
+    // 按 T 解释第 s 段；元素大小不符时返回空指针
+    template <typename T>
+    const T* sectionAs(uint32_t s) const {
+        if (!file || sections[s].elementSize != sizeof(T)) return nullptr;
+        return reinterpret_cast<const T*>(sectionData(s));
+    }
+
+    // 整段复制到 out（元素均可平凡复制，assign 直接按字节复制，不先逐个构造）；元素大小不符时返回 false
+    template <typename T>
+    bool copySection(uint32_t s, std::vector<T>& out) const {
+        const T* src = sectionAs<T>(s);
+        if (src == nullptr) {
+            std::cerr << "Error: Mesh cache section " << s << " has element size " << sections[s].elementSize
+                      << ", expected " << sizeof(T) << std::endl;
+            return false;
+        }
+        out.assign(src, src + sections[s].count);
+        return true;
+    }
+};
+
+// 读取 OBJ 网格并上传GPU：源文件未变化时直接映射缓存，否则解析 OBJ 并重写缓存
+inline std::shared_ptr<Mesh> loadMeshCached(const std::string& filename) {
+    auto mesh = std::make_shared<Mesh>();
+    uint64_t sourceSize = 0;
+    int64_t sourceTime = 0;
+    if (!MeshCache::sourceStamp(filename, sourceSize, sourceTime)) {
+        std::cerr << "Error: Failed to open file " << filename << std::endl;
+        return mesh;
+    }
+
+    const std::string cachePath = MeshCache::cachePath(filename);
+    {
+        // 映射须在重写缓存前释放（Windows 下无法覆盖已映射的文件）
+        MeshCache cache;
+        if (cache.open(cachePath, sourceSize, sourceTime) && cache.load(*mesh)) {
+            mesh->setupMesh(cache.renderVertices(), cache.renderVertexCount(), cache.indices(), cache.indexCount());
+            return mesh;
+        }
+    }
+
+    ObjData obj;
+    if (!readObj(filename, obj)) {
+        return mesh;
+    }
+    *mesh = Mesh::buildFromIndexBuffer(obj.positions, obj.triangulate());
+    MeshCache::save(cachePath, *mesh, sourceSize, sourceTime);
+    mesh->setupMesh();
+    return mesh;
+}
+
+#endif // MESH_CACHE_H
@@ -0,0 +1,478 @@
+/*
+ * MeshSimplifier.h
+ *
+ * 基于二次误差度量（Quadric Error Metrics, Garland & Heckbert 1997）的边折叠网格简化。
+ *
+ * 直接使用 Mesh 中预留的简化字段：
+ * - Face::normal       面的平面方程 (n, d)，n 为单位法向
+ * - Vertex::quadric    顶点的误差二次型 Q = sum(area * p p^T)，边界边额外加入垂直约束平面
+ * - Edge::QBar / vBar / cost   折叠后的二次型、最优位置与误差
+ * - deleted 标记与 VertexElement::smpfId（简化后网格中的新编号）
+ *
+ * 简化过程中：
+ * - 面的当前顶点保存在 FaceElement::vertexIds 中，边的当前端点保存在
+ *   EdgeElement::halfEdge1FromVertexId / halfEdge1ToVertexId 中
+ * - 每个顶点维护相邻面、相邻边列表（由 CSR 邻接初始化）
+ * - 索引最小堆按 cost 排序：每条边在堆中至多一项，更新 cost 时原地上浮/下沉；
+ *   被合并删除的边不立即出堆，出堆时再丢弃（惰性失效）
+ * - 折叠前检查 link condition、边界收缩与三角形翻转，保证结果仍为流形
+ * 简化完成后由 extractMesh 重新压缩编号并构建新的半边网格。
+ * 可通过 setCollapseLog 记录每次折叠（供 ProgressiveMesh 逆序回放为顶点分裂）。
+ *
+ * 撰写者：Zhiyuan Feng
+ */
+
+#ifndef MESH_SIMPLIFIER_H
+#define MESH_SIMPLIFIER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "Mesh/Mesh.h"
+#include "Parallel/ParallelFor.h"
+
+// 一次边折叠的记录：removed 并入 kept，kept 移动到 keptPositionAfter
+// removedFaces 为随之删除的面（其 vertexIds 保持删除前的内容）；
+// changedCorners 为 removed 被替换为 kept 的面角 (faceId, 角序号)
+struct EdgeCollapseRecord {
+    size_t kept;
+    size_t removed;
+    Vec3 keptPositionBefore;
+    Vec3 keptPositionAfter;
+    std::vector<size_t> removedFaces;
+    std::vector<std::pair<size_t, uint8_t>> changedCorners;
+};
+
+class QuadricSimplifier {
+public:
+    // 边界约束平面的权重（相对于面二次型）
+    static constexpr float BOUNDARY_WEIGHT = 1000.0f;
+
+    // 以 sourceMesh 的副本为工作网格（可 std::move 传入以避免复制）
+    explicit QuadricSimplifier(Mesh sourceMesh) : mesh(std::move(sourceMesh)) {
+        initialize();
+    }
+
+    // 折叠边直到面数不超过 targetFaceCount，或最小折叠误差超过 maxError；返回折叠次数
+    size_t simplify(size_t targetFaceCount, double maxError = std::numeric_limits<double>::infinity()) {
+        size_t collapses = 0;
+        while (activeFaces > targetFaceCount && !heap.empty()) {
+            size_t edgeId = heap.top();
+            if (mesh.edgeElements[edgeId].deleted) {
+                heap.pop(); // 已被合并的边
+                continue;
+            }
+            if (mesh.edges[edgeId].cost > maxError) {
+                break;
+            }
+            heap.pop();
+            if (collapseEdge(edgeId)) {
+                ++collapses;
+            }
+        }
+        return collapses;
+    }
+
+    size_t faceCount() const { return activeFaces; }
+
+    // 之后每次成功的折叠都追加到 log（传 nullptr 关闭记录）
+    void setCollapseLog(std::vector<EdgeCollapseRecord>* log) { collapseLog = log; }
+
+    // 工作网格（简化过程中带 deleted 标记）
+    const Mesh& workingMesh() const { return mesh; }
+
+    // 压缩编号并构建简化后的网格（为存活顶点写入 smpfId）
+    Mesh extractMesh() {
+        std::vector<Vec3> positions;
+        std::vector<unsigned int> triangleIndices;
+        positions.reserve(mesh.vertices.size());
+        triangleIndices.reserve(3 * activeFaces);
+
+        for (size_t v = 0; v < mesh.vertexElements.size(); ++v) {
+            VertexElement& elem = mesh.vertexElements[v];
+            elem.smpfId = elem.deleted ? INVALID_INDEX : positions.size();
+            if (!elem.deleted) {
+                positions.push_back(mesh.vertices[v].position);
+            }
+        }
+        for (const FaceElement& face : mesh.faceElements) {
+            if (face.deleted) continue;
+            for (size_t vid : face.vertexIds) {
+                triangleIndices.push_back(static_cast<unsigned int>(mesh.vertexElements[vid].smpfId));
+            }
+        }
+        return Mesh::buildFromIndexBuffer(positions, triangleIndices);
+    }
+
+private:
+    // 以边编号为索引的二叉最小堆，支持原地更新键值
+    class IndexedMinHeap {
+    public:
+        void build(const std::vector<Edge>& edges) {
+            const size_t n = edges.size();
+            entries.resize(n);
+            position.resize(n);
+            for (size_t e = 0; e < n; ++e) {
+                entries[e] = { edges[e].cost, static_cast<uint32_t>(e) };
+                position[e] = static_cast<uint32_t>(e);
+            }
+            for (size_t i = n / 2; i-- > 0;) {
+                siftDown(i);
+            }
+        }
+
+        bool empty() const { return entries.empty(); }
+        size_t top() const { return entries.front().id; }
+
+        void pop() {
+            position[entries.front().id] = NOT_IN_HEAP;
+            if (entries.size() > 1) {
+                entries.front() = entries.back();
+                position[entries.front().id] = 0;
+            }
+            entries.pop_back();
+            if (!entries.empty()) siftDown(0);
+        }
+
+        // 插入或更新 id 的键值
+        void update(size_t id, float key) {
+            uint32_t i = position[id];
+            if (i == NOT_IN_HEAP) {
+                i = static_cast<uint32_t>(entries.size());
+                entries.push_back({ key, static_cast<uint32_t>(id) });
+                position[id] = i;
+                siftUp(i);
+            } else if (key < entries[i].key) {
+                entries[i].key = key;
+                siftUp(i);
+            } else {
+                entries[i].key = key;
+                siftDown(i);
+            }
+        }
+
+    private:
+        static constexpr uint32_t NOT_IN_HEAP = std::numeric_limits<uint32_t>::max();
+        struct Entry {
+            float key;
+            uint32_t id;
+            bool operator<(const Entry& other) const {
+                return key < other.key || (key == other.key && id < other.id);
+            }
+        };
+        std::vector<Entry> entries;
+        std::vector<uint32_t> position;
+
+        void place(size_t i, const Entry& entry) {
+            entries[i] = entry;
+            position[entry.id] = static_cast<uint32_t>(i);
+        }
+
+        void siftUp(size_t i) {
+            Entry entry = entries[i];
+            while (i > 0) {
+                size_t parent = (i - 1) / 2;
+                if (!(entry < entries[parent])) break;
+                place(i, entries[parent]);
+                i = parent;
+            }
+            place(i, entry);
+        }
+
+        void siftDown(size_t i) {
+            Entry entry = entries[i];
+            const size_t n = entries.size();
+            while (true) {
+                size_t child = 2 * i + 1;
+                if (child >= n) break;
+                if (child + 1 < n && entries[child + 1] < entries[child]) ++child;
+                if (!(entries[child] < entry)) break;
+                place(i, entries[child]);
+                i = child;
+            }
+            place(i, entry);
+        }
+    };
+
+    Mesh mesh;
+    size_t activeFaces = 0;
+    std::vector<std::vector<size_t>> vertexFaces;
+    std::vector<std::vector<size_t>> vertexEdges;
+    // 顶点状态：内部 / 边界 / 非流形（多个边界扇区共用一点，不参与折叠）
+    enum : char { INTERIOR_VERTEX = 0, BOUNDARY_VERTEX = 1, NON_MANIFOLD_VERTEX = 2 };
+    std::vector<char> vertexState;
+    std::vector<size_t> vertexMark;
+    size_t markStamp = 0;
+    IndexedMinHeap heap;
+    std::vector<EdgeCollapseRecord>* collapseLog = nullptr;
+
+    static Mat4 planeQuadric(const Vec4& plane, float weight) {
+        Mat4 q(0.0f);
+        for (int c = 0; c < 4; ++c) {
+            for (int r = 0; r < 4; ++r) {
+                q[c][r] = weight * plane[c] * plane[r];
+            }
+        }
+        return q;
+    }
+
+    static double quadricError(const Mat4& q, const Vec3& p) {
+        glm::dvec4 v(p, 1.0);
+        return glm::dot(v, glm::dmat4(q) * v);
+    }
+
+    size_t otherEnd(size_t edgeId, size_t v) const {
+        const EdgeElement& edge = mesh.edgeElements[edgeId];
+        return edge.halfEdge1FromVertexId == v ? edge.halfEdge1ToVertexId : edge.halfEdge1FromVertexId;
+    }
+
+    bool faceHasVertex(size_t faceId, size_t v) const {
+        const FaceVertexIds& vids = mesh.faceElements[faceId].vertexIds;
+        return vids[0] == v || vids[1] == v || vids[2] == v;
+    }
+
+    // 边界半边的约束平面：过该边且垂直于所在面
+    Mat4 boundaryQuadric(size_t heId) const {
+        const HalfEdge& he = mesh.halfEdges[heId];
+        Vec3 p0 = mesh.vertices[he.fromVertexId].position;
+        Vec3 p1 = mesh.vertices[he.toVertexId].position;
+        Vec3 faceNormal = Vec3(mesh.faces[he.faceId].normal);
+        Vec3 n = glm::cross(p1 - p0, faceNormal);
+        float len = glm::length(n);
+        if (len <= 0.0f) return Mat4(0.0f);
+        n /= len;
+        float edgeLen2 = glm::dot(p1 - p0, p1 - p0);
+        return planeQuadric(Vec4(n, -glm::dot(n, p0)), BOUNDARY_WEIGHT * edgeLen2);
+    }
+
+    void initialize() {
+        if (mesh.isAdjacencyDirty()) {
+            mesh.buildVertexAdjacency();
+        }
+        const size_t numVerts = mesh.vertices.size();
+        const size_t numFaces = mesh.faceElements.size();
+        const size_t numEdges = mesh.edgeElements.size();
+        activeFaces = numFaces;
+
+        // 面的平面方程与面积
+        std::vector<float> faceAreas(numFaces, 0.0f);
+        parallelFor(0, numFaces, [&](size_t f) {
+            const FaceVertexIds& vids = mesh.faceElements[f].vertexIds;
+            Vec3 p0 = mesh.vertices[vids[0]].position;
+            Vec3 n = glm::cross(mesh.vertices[vids[1]].position - p0, mesh.vertices[vids[2]].position - p0);
+            float len = glm::length(n);
+            faceAreas[f] = 0.5f * len;
+            n = len > 0.0f ? n / len : Vec3(0.0f);
+            mesh.faces[f].normal = Vec4(n, -glm::dot(n, p0));
+        });
+
+        // 顶点二次型（面积加权）及邻接列表
+        vertexFaces.assign(numVerts, {});
+        vertexEdges.assign(numVerts, {});
+        vertexState.assign(numVerts, INTERIOR_VERTEX);
+        parallelFor(0, numVerts, [&](size_t v) {
+            Mat4 q(0.0f);
+            unsigned boundaryOutgoing = 0;
+            const HalfEdgeRange outgoing = mesh.outgoingHalfEdges(v);
+            const HalfEdgeRange incoming = mesh.incomingHalfEdges(v);
+            vertexFaces[v].reserve(outgoing.size());
+            vertexEdges[v].reserve(outgoing.size() + incoming.size());
+            for (size_t heId : outgoing) {
+                const HalfEdge& he = mesh.halfEdges[heId];
+                q += planeQuadric(mesh.faces[he.faceId].normal, faceAreas[he.faceId]);
+                vertexFaces[v].push_back(he.faceId);
+                vertexEdges[v].push_back(he.edgeId);
+                if (he.oppositeHalfEdgeId == INVALID_INDEX) {
+                    q += boundaryQuadric(heId);
+                    boundaryOutgoing++;
+                }
+            }
+            for (size_t heId : incoming) {
+                const HalfEdge& he = mesh.halfEdges[heId];
+                vertexEdges[v].push_back(he.edgeId);
+                if (he.oppositeHalfEdgeId == INVALID_INDEX) {
+                    q += boundaryQuadric(heId);
+                }
+            }
+            if (boundaryOutgoing > 0) {
+                vertexState[v] = boundaryOutgoing == 1 ? BOUNDARY_VERTEX : NON_MANIFOLD_VERTEX;
+            }
+            std::sort(vertexEdges[v].begin(), vertexEdges[v].end());
+            vertexEdges[v].erase(std::unique(vertexEdges[v].begin(), vertexEdges[v].end()), vertexEdges[v].end());
+            mesh.vertices[v].quadric = q;
+        }, 1024);
+
+        // 初始折叠代价
+        vertexMark.assign(numVerts, 0);
+        parallelFor(0, numEdges, [&](size_t e) { computeEdgeCost(e); }, 1024);
+        heap.build(mesh.edges);
+    }
+
+    // 计算边的 QBar、最优位置 vBar 与误差 cost
+    void computeEdgeCost(size_t edgeId) {
+        const EdgeElement& edgeElem = mesh.edgeElements[edgeId];
+        size_t a = edgeElem.halfEdge1FromVertexId, b = edgeElem.halfEdge1ToVertexId;
+        Edge& edge = mesh.edges[edgeId];
+        edge.QBar = mesh.vertices[a].quadric + mesh.vertices[b].quadric;
+
+        // 求解 A x = -b（A 为 QBar 左上 3x3），A 接近奇异时在端点与中点中选取误差最小者
+        glm::dmat3 A(glm::dmat4(edge.QBar));
+        glm::dvec3 rhs(-edge.QBar[3][0], -edge.QBar[3][1], -edge.QBar[3][2]);
+        double det = glm::determinant(A);
+        double scale = (A[0][0] + A[1][1] + A[2][2]) / 3.0;
+        Vec3 best;
+        double bestError;
+        if (std::abs(det) > 1e-6 * scale * scale * scale && scale > 0.0) {
+            best = Vec3(glm::inverse(A) * rhs);
+            bestError = quadricError(edge.QBar, best);
+        } else {
+            Vec3 candidates[3] = {
+                mesh.vertices[a].position, mesh.vertices[b].position,
+                0.5f * (mesh.vertices[a].position + mesh.vertices[b].position)
+            };
+            best = candidates[0];
+            bestError = quadricError(edge.QBar, best);
+            for (int i = 1; i < 3; ++i) {
+                double err = quadricError(edge.QBar, candidates[i]);
+                if (err < bestError) {
+                    bestError = err;
+                    best = candidates[i];
+                }
+            }
+        }
+        edge.vBar = Vec4(best, 1.0f);
+        edge.cost = static_cast<float>(std::max(0.0, bestError));
+    }
+
+    // 检查把 removed 折叠到 kept 并移动到 target 是否合法
+    bool canCollapse(size_t kept, size_t removed, const Vec3& target) {
+        // 与两端点都相邻的面（即该边两侧的面）
+        size_t sharedFaces = 0;
+        for (size_t f : vertexFaces[kept]) {
+            if (!mesh.faceElements[f].deleted && faceHasVertex(f, removed)) ++sharedFaces;
+        }
+        if (sharedFaces == 0 || sharedFaces > 2) return false;
+        if (vertexState[kept] == NON_MANIFOLD_VERTEX || vertexState[removed] == NON_MANIFOLD_VERTEX) return false;
+        // 内部边两端都在边界上时折叠会把网格捏成非流形
+        if (sharedFaces == 2 && vertexState[kept] != INTERIOR_VERTEX && vertexState[removed] != INTERIOR_VERTEX) return false;
+
+        // link condition：公共邻点数必须等于两侧面数
+        ++markStamp;
+        for (size_t e : vertexEdges[kept]) {
+            if (!mesh.edgeElements[e].deleted) vertexMark[otherEnd(e, kept)] = markStamp;
+        }
+        size_t commonNeighbors = 0;
+        for (size_t e : vertexEdges[removed]) {
+            if (!mesh.edgeElements[e].deleted && vertexMark[otherEnd(e, removed)] == markStamp) ++commonNeighbors;
+        }
+        if (commonNeighbors != sharedFaces) return false;
+
+        // 两侧面的第三个顶点折叠后必须仍有相邻面，否则会留下孤立顶点
+        for (size_t f : vertexFaces[kept]) {
+            if (mesh.faceElements[f].deleted || !faceHasVertex(f, removed)) continue;
+            for (size_t o : mesh.faceElements[f].vertexIds) {
+                if (o == kept || o == removed) continue;
+                size_t remaining = 0;
+                for (size_t g : vertexFaces[o]) {
+                    if (!mesh.faceElements[g].deleted && !(faceHasVertex(g, kept) && faceHasVertex(g, removed))) ++remaining;
+                }
+                if (remaining == 0) return false;
+            }
+        }
+
+        // 三角形翻转检查
+        for (size_t v : { kept, removed }) {
+            for (size_t f : vertexFaces[v]) {
+                const FaceElement& face = mesh.faceElements[f];
+                if (face.deleted || (faceHasVertex(f, kept) && faceHasVertex(f, removed))) continue;
+                Vec3 p[3], q[3];
+                for (int i = 0; i < 3; ++i) {
+                    p[i] = mesh.vertices[face.vertexIds[i]].position;
+                    q[i] = face.vertexIds[i] == v ? target : p[i];
+                }
+                Vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                Vec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+                if (glm::dot(before, after) <= 0.0f) return false;
+            }
+        }
+        return true;
+    }
+
+    bool collapseEdge(size_t edgeId) {
+        EdgeElement& edgeElem = mesh.edgeElements[edgeId];
+        size_t kept = edgeElem.halfEdge1FromVertexId, removed = edgeElem.halfEdge1ToVertexId;
+        Vec3 target = Vec3(mesh.edges[edgeId].vBar);
+        if (!canCollapse(kept, removed, target)) {
+            return false; // 邻域变化后会重新入堆
+        }
+
+        EdgeCollapseRecord* record = nullptr;
+        if (collapseLog) {
+            collapseLog->push_back({ kept, removed, mesh.vertices[kept].position, target, {}, {} });
+            record = &collapseLog->back();
+        }
+
+        mesh.vertices[kept].position = target;
+        mesh.vertices[kept].quadric = mesh.edges[edgeId].QBar;
+        vertexState[kept] = std::max(vertexState[kept], vertexState[removed]);
+        mesh.vertexElements[removed].deleted = true;
+        edgeElem.deleted = true;
+
+        // 面：两侧面删除，其余面把 removed 替换为 kept
+        for (size_t f : vertexFaces[removed]) {
+            FaceElement& face = mesh.faceElements[f];
+            if (face.deleted) continue;
+            if (faceHasVertex(f, kept)) {
+                face.deleted = true;
+                for (size_t i = 0; i < 3; ++i) {
+                    mesh.halfEdges[face.startHalfEdgeId + i].deleted = true;
+                }
+                --activeFaces;
+                if (record) record->removedFaces.push_back(f);
+            } else {
+                if (record) {
+                    size_t corner = std::find(face.vertexIds.begin(), face.vertexIds.end(), removed) - face.vertexIds.begin();
+                    record->changedCorners.emplace_back(f, static_cast<uint8_t>(corner));
+                }
+                std::replace(face.vertexIds.begin(), face.vertexIds.end(), removed, kept);
+                vertexFaces[kept].push_back(f);
+            }
+        }
+
+        // 边：与 kept 已有边重合的删除，其余改接到 kept（canCollapse 已标记 kept 的邻点）
+        for (size_t e : vertexEdges[removed]) {
+            EdgeElement& other = mesh.edgeElements[e];
+            if (e == edgeId || other.deleted) continue;
+            size_t w = otherEnd(e, removed);
+            if (vertexMark[w] == markStamp) {
+                other.deleted = true;
+            } else {
+                if (other.halfEdge1FromVertexId == removed) other.halfEdge1FromVertexId = kept;
+                else other.halfEdge1ToVertexId = kept;
+                vertexEdges[kept].push_back(e);
+            }
+        }
+        vertexFaces[removed].clear();
+        vertexFaces[removed].shrink_to_fit();
+        vertexEdges[removed].clear();
+        vertexEdges[removed].shrink_to_fit();
+
+        // 清理 kept 的列表，并更新其所有相邻边的代价
+        auto& faces = vertexFaces[kept];
+        faces.erase(std::remove_if(faces.begin(), faces.end(),
+                    [this](size_t f) { return mesh.faceElements[f].deleted; }), faces.end());
+        auto& edges = vertexEdges[kept];
+        edges.erase(std::remove_if(edges.begin(), edges.end(),
+                    [this](size_t e) { return mesh.edgeElements[e].deleted; }), edges.end());
+        for (size_t e : edges) {
+            computeEdgeCost(e);
+            heap.update(e, mesh.edges[e].cost);
+        }
+        return true;
+    }
+};
+
+#endif // MESH_SIMPLIFIER_H
@@ -0,0 +1,250 @@
+/*
+ * ProgressiveMesh.h
+ *
+ * 渐进网格（Progressive Mesh, Hoppe 1996）：由 QuadricSimplifier 记录一次完整的边折叠序列，
+ * 之后任意面数的网格都通过逆序回放“顶点分裂”（或正序回放折叠）增量得到。
+ *
+ * 编号方式使所有级别共用同一个顶点缓冲与索引缓冲：
+ * - 顶点：最简网格的顶点在前，其后按分裂顺序（即折叠的逆序）排列被删除的顶点，
+ *   应用 s 次分裂后活跃顶点恰为前 baseVertexCount + s 个
+ * - 面：最简网格的面在前，其后按分裂顺序排列每次分裂新增的面，活跃面恰为索引缓冲的前缀
+ * - 每次分裂只修改：被保留顶点 kept 的位置、若干面角的顶点编号（kept -> 新顶点）
+ *   以及新增面（本就位于活跃前缀之后，无需写入）
+ *
+ * 切换级别只改动 CPU 端数组并记录脏区间，updateBuffers 仅把变化的区间
+ * 用 glBufferSubData 上传；draw 只绘制活跃的索引前缀。
+ *
+ * 撰写者：Zhiyuan Feng
+ */
+
+#ifndef PROGRESSIVE_MESH_H
+#define PROGRESSIVE_MESH_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include "Shader/shader.h"
+#include "Mesh/Mesh.h"
+#include "Mesh/MeshSimplifier.h"
+
+class ProgressiveMesh {
+public:
+    // 由 sourceMesh 构建渐进记录：尽可能折叠到 minFaceCount 个面
+    explicit ProgressiveMesh(const Mesh& sourceMesh, size_t minFaceCount = 0)
+        : VAO(0), VBO(0), EBO(0) {
+        build(sourceMesh, minFaceCount);
+    }
+
+    ~ProgressiveMesh() {
+        if (VAO) glDeleteVertexArrays(1, &VAO);
+        if (VBO) glDeleteBuffers(1, &VBO);
+        if (EBO) glDeleteBuffers(1, &EBO);
+    }
+
+    ProgressiveMesh(const ProgressiveMesh&) = delete;
+    ProgressiveMesh& operator=(const ProgressiveMesh&) = delete;
+
+    size_t minFaceCount() const { return faceCountAfter(0); }
+    size_t maxFaceCount() const { return faceCountAfter(splits.size()); }
+    size_t faceCount() const { return faceCountAfter(appliedSplits); }
+    size_t vertexCount() const { return baseVertexCount + appliedSplits; }
+    size_t splitCount() const { return splits.size(); }
+
+    // 切换到面数不超过 targetFaceCount 的最精细级别（不低于最简网格）
+    void setFaceCount(size_t targetFaceCount) {
+        // splitFaceEnd 单调递增，二分查找满足面数要求的分裂次数
+        size_t target = static_cast<size_t>(std::upper_bound(splitFaceEnd.begin(), splitFaceEnd.end(),
+                                                              static_cast<uint32_t>(std::min<size_t>(targetFaceCount, UINT32_MAX)))
+                                            - splitFaceEnd.begin());
+        while (appliedSplits < target) applySplit(appliedSplits++);
+        while (appliedSplits > target) applyCollapse(--appliedSplits);
+    }
+
+    // 按 [0, 1] 的细节比例选择级别（0 为最简网格，1 为原网格）
+    void setDetail(float detail) {
+        detail = std::clamp(detail, 0.0f, 1.0f);
+        float faces = static_cast<float>(minFaceCount()) + detail * static_cast<float>(maxFaceCount() - minFaceCount());
+        setFaceCount(static_cast<size_t>(faces + 0.5f));
+    }
+
+    // 创建缓冲并上传全部顶点与索引（各级别共用，只需一次）
+    void setupMesh() {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+
+        glBindVertexArray(VAO);
+
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, renderVertices.size() * sizeof(RenderVertex), renderVertices.data(), GL_DYNAMIC_DRAW);
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_DYNAMIC_DRAW);
+
+        // 顶点属性与 Mesh::setupMesh 相同
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(RenderVertex), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(RenderVertex), (void*)offsetof(RenderVertex, normalOct));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(RenderVertex), (void*)offsetof(RenderVertex, texCoordsHalf));
+
+        glBindVertexArray(0);
+        clearDirty();
+    }
+
+    // 只上传自上次调用以来改动过的顶点与索引区间
+    void updateBuffers() {
+        if (dirtyVertexBegin < dirtyVertexEnd) {
+            glBindBuffer(GL_ARRAY_BUFFER, VBO);
+            glBufferSubData(GL_ARRAY_BUFFER, dirtyVertexBegin * sizeof(RenderVertex),
+                            (dirtyVertexEnd - dirtyVertexBegin) * sizeof(RenderVertex), renderVertices.data() + dirtyVertexBegin);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+        if (dirtyIndexBegin < dirtyIndexEnd) {
+            glBindVertexArray(VAO);
+            glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, dirtyIndexBegin * sizeof(unsigned int),
+                            (dirtyIndexEnd - dirtyIndexBegin) * sizeof(unsigned int), indices.data() + dirtyIndexBegin);
+            glBindVertexArray(0);
+        }
+        clearDirty();
+    }
+
+    // 绘制当前级别（活跃的索引前缀）；参数与 Mesh::draw 保持一致，着色器由调用方绑定
+    void draw(Shader& /* shader */) const {
+        glBindVertexArray(VAO);
+        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(3 * faceCount()), GL_UNSIGNED_INT, 0);
+        glBindVertexArray(0);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+private:
+    // 一次顶点分裂（即某次折叠的逆操作），编号均为渐进网格中的新编号
+    struct VertexSplit {
+        uint32_t keptVertex;
+        uint32_t cornerBegin; // splitCorners 中的区间
+        uint32_t cornerEnd;
+        Vec3 keptFinePosition;   // 分裂后 kept 的位置
+        Vec3 keptCoarsePosition; // 分裂前 kept 的位置
+    };
+
+    std::vector<RenderVertex> renderVertices; // 全部顶点，当前级别的坐标
+    std::vector<unsigned int> indices;        // 全部面，当前级别的顶点编号
+    std::vector<VertexSplit> splits;
+    std::vector<uint32_t> splitCorners;       // 索引缓冲中的位置
+    std::vector<uint32_t> splitFaceEnd;       // 应用 s+1 次分裂后的面数
+    size_t baseVertexCount = 0;
+    size_t baseFaceCount = 0;
+    size_t appliedSplits = 0;
+
+    size_t dirtyVertexBegin, dirtyVertexEnd;
+    size_t dirtyIndexBegin, dirtyIndexEnd;
+
+    unsigned int VAO, VBO, EBO;
+
+    size_t faceCountAfter(size_t s) const { return s == 0 ? baseFaceCount : splitFaceEnd[s - 1]; }
+
+    void clearDirty() {
+        dirtyVertexBegin = dirtyIndexBegin = SIZE_MAX;
+        dirtyVertexEnd = dirtyIndexEnd = 0;
+    }
+
+    void markVertex(size_t v) {
+        dirtyVertexBegin = std::min(dirtyVertexBegin, v);
+        dirtyVertexEnd = std::max(dirtyVertexEnd, v + 1);
+    }
+
+    void markIndex(size_t i) {
+        dirtyIndexBegin = std::min(dirtyIndexBegin, i);
+        dirtyIndexEnd = std::max(dirtyIndexEnd, i + 1);
+    }
+
+    // 第 s 次分裂新增顶点的编号
+    uint32_t splitVertex(size_t s) const { return static_cast<uint32_t>(baseVertexCount + s); }
+
+    void applySplit(size_t s) {
+        const VertexSplit& split = splits[s];
+        renderVertices[split.keptVertex].position = split.keptFinePosition;
+        markVertex(split.keptVertex);
+        for (uint32_t c = split.cornerBegin; c < split.cornerEnd; ++c) {
+            indices[splitCorners[c]] = splitVertex(s);
+            markIndex(splitCorners[c]);
+        }
+    }
+
+    void applyCollapse(size_t s) {
+        const VertexSplit& split = splits[s];
+        renderVertices[split.keptVertex].position = split.keptCoarsePosition;
+        markVertex(split.keptVertex);
+        for (uint32_t c = split.cornerBegin; c < split.cornerEnd; ++c) {
+            indices[splitCorners[c]] = split.keptVertex;
+            markIndex(splitCorners[c]);
+        }
+    }
+
+    void build(const Mesh& sourceMesh, size_t minFaces) {
+        std::vector<EdgeCollapseRecord> records;
+        QuadricSimplifier simplifier(sourceMesh);
+        simplifier.setCollapseLog(&records);
+        simplifier.simplify(minFaces);
+        const Mesh& work = simplifier.workingMesh();
+        const size_t numVerts = work.vertices.size();
+        const size_t numFaces = work.faceElements.size();
+
+        // 顶点与面的新编号：最简网格在前，其后按折叠的逆序排列
+        std::vector<uint32_t> vertexOrder(numVerts), faceOrder(numFaces);
+        uint32_t nextVertex = 0, nextFace = 0;
+        for (size_t v = 0; v < numVerts; ++v) {
+            if (!work.vertexElements[v].deleted) vertexOrder[v] = nextVertex++;
+        }
+        for (size_t f = 0; f < numFaces; ++f) {
+            if (!work.faceElements[f].deleted) faceOrder[f] = nextFace++;
+        }
+        baseVertexCount = nextVertex;
+        baseFaceCount = nextFace;
+        for (size_t r = records.size(); r-- > 0;) {
+            vertexOrder[records[r].removed] = nextVertex++;
+            for (size_t f : records[r].removedFaces) faceOrder[f] = nextFace++;
+        }
+
+        // 顶点取工作网格的最终状态：被删除的顶点保持删除时的坐标
+        renderVertices.resize(numVerts);
+        parallelFor(0, numVerts, [&](size_t v) {
+            renderVertices[vertexOrder[v]] = packRenderVertex(work.vertices[v]);
+        });
+
+        // 面取工作网格的最终状态：被删除的面保持删除时的顶点，即该面出现时（分裂后）的状态
+        indices.resize(3 * numFaces);
+        parallelFor(0, numFaces, [&](size_t f) {
+            const FaceVertexIds& vids = work.faceElements[f].vertexIds;
+            for (size_t i = 0; i < 3; ++i) {
+                indices[3 * faceOrder[f] + i] = vertexOrder[vids[i]];
+            }
+        });
+
+        // 分裂序列
+        splits.reserve(records.size());
+        splitFaceEnd.reserve(records.size());
+        size_t faceEnd = baseFaceCount;
+        for (size_t r = records.size(); r-- > 0;) {
+            const EdgeCollapseRecord& record = records[r];
+            VertexSplit split;
+            split.keptVertex = vertexOrder[record.kept];
+            split.keptFinePosition = record.keptPositionBefore;
+            split.keptCoarsePosition = record.keptPositionAfter;
+            split.cornerBegin = static_cast<uint32_t>(splitCorners.size());
+            for (const auto& corner : record.changedCorners) {
+                splitCorners.push_back(3 * faceOrder[corner.first] + corner.second);
+            }
+            split.cornerEnd = static_cast<uint32_t>(splitCorners.size());
+            splits.push_back(split);
+            faceEnd += record.removedFaces.size();
+            splitFaceEnd.push_back(static_cast<uint32_t>(faceEnd));
+        }
+        appliedSplits = 0;
+        clearDirty();
+    }
+};
+
+#endif // PROGRESSIVE_MESH_H
@@ -0,0 +1,133 @@
+/*
+ * SubdivisionWorker.h
+ *
+ * 后台细分服务：在工作线程上逐级计算 Loop 细分，渲染线程只负责 GPU 上传（setupMesh）。
+ *
+ * - setTargetLevel：设置当前希望显示的级数，工作线程会计算到 target + 1（预取下一级）
+ * - readyLevel：已连续计算完成的最高级数，渲染循环据此继续绘制上一级，直到新级别就绪
+ * - 用户降低级数时，正在计算且超出 target + 1 的级别会被取消
+ * - 细分失败（如网格含非三角形面）时停止继续细分，已完成的级别照常可用
+ *
+ * 各级网格以 shared_ptr 共享：工作线程只读取上一级的拓扑与坐标，渲染线程只写入
+ * VAO/VBO/EBO，两者访问的成员互不重叠。
+ *
+ * 撰写者：Zhiyuan Feng
+ */
+
+#ifndef SUBDIVISION_WORKER_H
+#define SUBDIVISION_WORKER_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Mesh/Mesh.h"
+#include "Mesh/LoopSubdivision.h"
+
+class SubdivisionWorker {
+public:
+    // baseMesh 为第0级网格，maxLevel 限制最多细分的级数（防止内存耗尽）
+    SubdivisionWorker(std::shared_ptr<Mesh> baseMesh, int maxLevel = 6)
+        : maxLevel(maxLevel), targetLevel(0), inFlightLevel(-1), stopRequested(false), failed(false), cancelRequested(false) {
+        levels.push_back(std::move(baseMesh));
+        worker = std::thread(&SubdivisionWorker::run, this);
+    }
+
+    ~SubdivisionWorker() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopRequested = true;
+            cancelRequested = true;
+        }
+        condition.notify_all();
+        worker.join();
+    }
+
+    SubdivisionWorker(const SubdivisionWorker&) = delete;
+    SubdivisionWorker& operator=(const SubdivisionWorker&) = delete;
+
+    int getMaxLevel() const { return maxLevel; }
+
+    // 设置希望显示的级数
+    void setTargetLevel(int level) {
+        level = std::clamp(level, 0, maxLevel);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (level == targetLevel) return;
+            targetLevel = level;
+            // 正在计算的级别已超出预取范围，取消之
+            if (inFlightLevel > targetLevel + 1) {
+                cancelRequested = true;
+            }
+        }
+        condition.notify_all();
+    }
+
+    // 已计算完成的最高级数
+    int readyLevel() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return static_cast<int>(levels.size()) - 1;
+    }
+
+    // 获取已计算完成的第 level 级网格，未就绪时返回空指针
+    std::shared_ptr<Mesh> getLevel(int level) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (level < 0 || static_cast<size_t>(level) >= levels.size()) return nullptr;
+        return levels[level];
+    }
+
+private:
+    const int maxLevel;
+    int targetLevel;
+    int inFlightLevel;
+    bool stopRequested;
+    bool failed; // 细分失败后不再计算更高的级别
+    std::atomic<bool> cancelRequested;
+
+    std::vector<std::shared_ptr<Mesh>> levels;
+    mutable std::mutex mutex;
+    std::condition_variable condition;
+    std::thread worker;
+
+    // 还需要计算下一级（目标级数 + 1 级预取）
+    bool hasPendingWork() const {
+        if (failed) return false;
+        int wanted = std::min(targetLevel + 1, maxLevel);
+        return static_cast<int>(levels.size()) - 1 < wanted;
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            condition.wait(lock, [this]() { return stopRequested || hasPendingWork(); });
+            if (stopRequested) return;
+
+            std::shared_ptr<Mesh> parent = levels.back();
+            inFlightLevel = static_cast<int>(levels.size());
+            cancelRequested = false;
+            lock.unlock();
+
+            Mesh child = LoopSubdivide(*parent, &cancelRequested);
+
+            lock.lock();
+            int finishedLevel = inFlightLevel;
+            inFlightLevel = -1;
+            if (cancelRequested) {
+                continue; // 结果作废，重新检查目标级数
+            }
+            if (child.faceElements.empty()) {
+                failed = true;
+                std::cerr << "细分级别 " << finishedLevel << " 计算失败，停止继续细分。" << std::endl;
+                continue;
+            }
+            levels.push_back(std::make_shared<Mesh>(std::move(child)));
+            std::cout << "细分级别 " << finishedLevel << " 计算完成。" << std::endl;
+        }
+    }
+};
+
+#endif // SUBDIVISION_WORKER_H
@@ -0,0 +1,67 @@
+/*
+ * ParallelFor.h
+ *
+ * 简单的数据并行工具：把区间 [begin, end) 均匀切成若干连续块，交给 std::thread 并行执行。
+ * 每个块内按顺序处理，因此只要各下标之间的写入互不重叠，结果与串行执行完全一致。
+ *
+ * 主要功能：
+ * - parallelForRange：按块回调 func(blockBegin, blockEnd)，便于在块内复用局部变量
+ * - parallelFor：按下标回调 func(i)
+ * - 区间较小时直接在当前线程串行执行，避免线程创建开销
+ *
+ * 撰写者：Zhiyuan Feng
+ */
+
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// 工作线程数（至少为1）
+inline unsigned int parallelThreadCount() {
+    unsigned int n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+}
+
+// 按块并行：func(blockBegin, blockEnd)，minGrain 为每块最少元素数
+template <typename Func>
+void parallelForRange(size_t begin, size_t end, Func&& func, size_t minGrain = 4096) {
+    if (end <= begin) return;
+    size_t count = end - begin;
+    size_t numBlocks = std::min<size_t>(parallelThreadCount(), (count + minGrain - 1) / minGrain);
+    if (numBlocks <= 1) {
+        func(begin, end);
+        return;
+    }
+
+    size_t blockSize = (count + numBlocks - 1) / numBlocks;
+    std::vector<std::thread> workers;
+    workers.reserve(numBlocks - 1);
+    for (size_t b = 1; b < numBlocks; ++b) {
+        size_t blockBegin = begin + b * blockSize;
+        size_t blockEnd = std::min(end, blockBegin + blockSize);
+        if (blockBegin >= blockEnd) break;
+        workers.emplace_back([&func, blockBegin, blockEnd]() { func(blockBegin, blockEnd); });
+    }
+    // 第一块由当前线程处理
+    func(begin, std::min(end, begin + blockSize));
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+// 按下标并行：func(i)
+template <typename Func>
+void parallelFor(size_t begin, size_t end, Func&& func, size_t minGrain = 4096) {
+    parallelForRange(begin, end, [&func](size_t blockBegin, size_t blockEnd) {
+        for (size_t i = blockBegin; i < blockEnd; ++i) {
+            func(i);
+        }
+    }, minGrain);
+}
+
+#endif // PARALLEL_FOR_H
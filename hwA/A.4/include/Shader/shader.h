@@ -9,6 +9,8 @@
  * - 编译顶点、片段、几何着色器
  * - 创建和链接着色器程序
  * - 提供uniform变量设置函数（包括bool、vec3、mat4类型）
+ * - 链接后一次性查询所有活动uniform的位置，存入按名称哈希排序的表，设置时不再调用glGetUniformLocation
+ * - 名称哈希（UniformName）对字符串字面量可在编译期求值
  * - 支持禁用当前着色器程序
  * 
  * 撰写者：Zhiyuan Feng
@@ -20,10 +22,14 @@
 #include "glad/glad.h" // 包含glad来获取所有的必须OpenGL头文件
 #include "glm/glm.hpp"
 
+#include <algorithm>
+#include <cstdint>
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <utility>
+#include <vector>
 
 // Helper function to check for compilation and linking errors
 void checkCompileErrors(unsigned int shader, const std::string &type) {
@@ -73,6 +79,25 @@ unsigned int compileShader(GLenum shaderType, const char *shaderCode) {
 
 
 
+// uniform名称的哈希（FNV-1a）。由字符串字面量构造时可在编译期求值，
+// 例如 static constexpr UniformName MODEL("model");
+// 查找只比较哈希，程序中两个活动uniform的哈希相同时视为错误（见 reflectUniforms）
+struct UniformName {
+    uint32_t hash;
+
+    template <size_t N>
+    constexpr UniformName(const char (&s)[N]) : hash(hashOf(s, N - 1)) {}
+    UniformName(const std::string& s) : hash(hashOf(s.c_str(), s.size())) {}
+
+    static constexpr uint32_t hashOf(const char* s, size_t length) {
+        uint32_t h = 2166136261u;
+        for (size_t i = 0; i < length; ++i) {
+            h = (h ^ static_cast<unsigned char>(s[i])) * 16777619u;
+        }
+        return h;
+    }
+};
+
 class Shader
 {
     public:
@@ -109,6 +134,9 @@ class Shader
             glDeleteShader(vertexShader);
             glDeleteShader(fragmentShader);
             if (geometryShader) glDeleteShader(geometryShader);
+
+            // 查询所有活动uniform的位置
+            reflectUniforms();
         }
 
         ~Shader() {
@@ -119,23 +147,87 @@ class Shader
             glUseProgram(programID);
         }
 
+        // uniform的位置，不存在（或已被编译器优化掉）时为 -1，此时 glUniform* 不做任何事
+        GLint uniformLocation(UniformName name) const {
+            auto it = std::lower_bound(uniformLocations.begin(), uniformLocations.end(), name.hash,
+                                       [](const std::pair<uint32_t, GLint> &entry, uint32_t hash) { return entry.first < hash; });
+            return it != uniformLocations.end() && it->first == name.hash ? it->second : -1;
+        }
+
         // uniform工具函数
-        void setBool(const std::string &name, bool value) const {
-            glUniform1i(glGetUniformLocation(programID, name.c_str()), (int)value);
+        void setBool(UniformName name, bool value) const {
+            glUniform1i(uniformLocation(name), (int)value);
         }
 
-        void setVec3(const std::string &name, const glm::vec3 &value) const { 
-            glUniform3fv(glGetUniformLocation(programID, name.c_str()), 1, &value[0]); 
+        void setVec3(UniformName name, const glm::vec3 &value) const { 
+            glUniform3fv(uniformLocation(name), 1, &value[0]); 
         }
 
-        void setMat4(const std::string &name, const glm::mat4 &mat) const {
-            glUniformMatrix4fv(glGetUniformLocation(programID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        void setMat4(UniformName name, const glm::mat4 &mat) const {
+            glUniformMatrix4fv(uniformLocation(name), 1, GL_FALSE, &mat[0][0]);
         }
 
         // 禁用当前着色器
         void disableShaders() const {
             glUseProgram(0); // 禁用着色器
         }
+
+    private:
+        // (名称哈希, 位置)，按哈希排序
+        std::vector<std::pair<uint32_t, GLint>> uniformLocations;
+
+        // 链接后遍历活动uniform。数组（GL 报告为 "name[0]"）同时登记数组名和每个元素 "name[i]"。
+        // 两个名称的哈希相同时输出错误、清空位置表并返回 false（所有uniform都不会被写入错误的位置）
+        bool reflectUniforms() {
+            uniformLocations.clear();
+            std::vector<std::string> names; // 与 uniformLocations 一一对应，仅用于检查冲突
+            GLint count = 0, maxLength = 0;
+            glGetProgramiv(programID, GL_ACTIVE_UNIFORMS, &count);
+            glGetProgramiv(programID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+            std::vector<char> buffer(std::max(maxLength, 1));
+            auto add = [this, &names](const std::string &name, GLint location) {
+                if (location < 0) return;
+                uniformLocations.emplace_back(UniformName(name).hash, location);
+                names.push_back(name);
+            };
+            for (GLint i = 0; i < count; ++i) {
+                GLsizei length = 0;
+                GLint size = 0;
+                GLenum type = 0;
+                glGetActiveUniform(programID, static_cast<GLuint>(i), maxLength, &length, &size, &type, buffer.data());
+                const std::string name(buffer.data(), length);
+                const GLint location = glGetUniformLocation(programID, name.c_str());
+                if (location < 0) continue;
+                const std::string suffix = "[0]";
+                if (name.size() <= suffix.size() || name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+                    add(name, location);
+                    continue;
+                }
+                const std::string base = name.substr(0, name.size() - suffix.size());
+                add(base, location);
+                for (GLint e = 0; e < size; ++e) {
+                    const std::string element = base + "[" + std::to_string(e) + "]";
+                    add(element, glGetUniformLocation(programID, element.c_str()));
+                }
+            }
+            std::vector<size_t> order(uniformLocations.size());
+            for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+            std::sort(order.begin(), order.end(), [this](size_t a, size_t b) { return uniformLocations[a] < uniformLocations[b]; });
+            bool ok = true;
+            for (size_t i = 1; i < order.size(); ++i) {
+                if (uniformLocations[order[i]].first == uniformLocations[order[i - 1]].first) {
+                    std::cerr << "ERROR::SHADER::UNIFORM_HASH_COLLISION in program " << programID << ": \""
+                              << names[order[i - 1]] << "\" and \"" << names[order[i]] << "\"" << std::endl;
+                    ok = false;
+                }
+            }
+            if (!ok) {
+                uniformLocations.clear();
+                return false;
+            }
+            std::sort(uniformLocations.begin(), uniformLocations.end());
+            return true;
+        }
 };
 
 #endif
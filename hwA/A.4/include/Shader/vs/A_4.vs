@@ -1,6 +1,6 @@
 #version 460 core
 layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
+layout (location = 1) in vec2 aNormalOct; // 八面体编码的法线
 layout (location = 2) in vec2 aTexCoords;
 
 out vec2 TexCoords;
@@ -10,9 +10,18 @@ uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+// 八面体编码解码为单位法线
+vec3 octDecode(vec2 e)
+{
+    vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0)
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return normalize(n);
+}
+
 void main()
 {
     TexCoords = aTexCoords;    
     gl_Position = projection * view * model * vec4(aPos, 1.0);
-    Normal = aNormal;
+    Normal = octDecode(aNormalOct);
 }
\ No newline at end of file
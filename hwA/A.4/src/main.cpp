@@ -2,7 +2,6 @@
 #include <GLFW/glfw3.h>
 #include <vector>
 #include <iostream>
-#include <unordered_map>
 #include <cassert>
 #include <fstream>
 #include <sstream>
@@ -10,187 +9,19 @@
 #include "glad/gldebug.h"
 #include "Shader/shader.h"
 #include "Mesh/Mesh.h"
+#include "Mesh/SubdivisionWorker.h"
+#include "Mesh/ProgressiveMesh.h"
+#include "Mesh/MeshCache.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
 constexpr unsigned int SCR_WIDTH = 800;
 constexpr unsigned int SCR_HEIGHT = 600;
-constexpr float PI = 3.1415926f;
 glm::vec3 lightPos(3.0f, 3.0f, 0.0f);
 
-// 索引对结构体，表示两顶点的边
-struct IndexPair2 {
-    size_t v1, v2;
-    IndexPair2() : v1(INVALID_INDEX), v2(INVALID_INDEX) {}
-    IndexPair2(size_t vertex1, size_t vertex2) : v1(vertex1), v2(vertex2) {}
-
-    bool operator==(const IndexPair2& other) const {
-        return v1 == other.v1 && v2 == other.v2;
-    }
-};
-
-// 用于计算索引对的哈希值
-template <typename T>
-inline void hash_combine(std::size_t& seed, const T& val) {
-    seed ^= std::hash<T>()(val) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-}
-
-// 计算多个值的组合哈希值
-template <typename... Types>
-inline std::size_t hash_val(const Types&... args) {
-    std::size_t seed = 0;
-    (hash_combine(seed, args), ...);
-    return seed;
-}
-
-// 索引对哈希函数
-struct IndexPair2Hash {    
-    std::size_t operator()(const IndexPair2& pair) const {        
-        return hash_val(pair.v1, pair.v2);
-    }	
-};
-
-// 索引三元组结构体，表示三顶点的关系
-struct IndexPair3 {
-    size_t vN, vOpp1, vOpp2;
-    IndexPair3() : vN(INVALID_INDEX), vOpp1(INVALID_INDEX), vOpp2(INVALID_INDEX) {}
-    IndexPair3(size_t vertexN, size_t vertexOpp1, size_t vertexOpp2 = INVALID_INDEX)
-        : vN(vertexN), vOpp1(vertexOpp1), vOpp2(vertexOpp2) {}
-};
-
-// 添加边的顶点到边顶点映射中
-int addEdgeVertex(std::unordered_map<IndexPair2, IndexPair3, IndexPair2Hash>& edgeVertices,
-                 size_t v1Index, size_t v2Index, size_t v3Index, size_t& newIndex) {
-    if (v1Index > v2Index) {
-        std::swap(v1Index, v2Index);
-    }
-    IndexPair2 vertsPair(v1Index, v2Index);
-    if (edgeVertices.find(vertsPair) == edgeVertices.end()) {
-        edgeVertices[vertsPair] = IndexPair3(newIndex++, v3Index);
-    } else {
-        edgeVertices[vertsPair].vOpp2 = v3Index;
-    }
-    return edgeVertices[vertsPair].vN;
-}
-
-// Loop细分算法
-Mesh LoopSubdivideNative(const Mesh& mesh) {
-    Mesh newMesh;
-    size_t numVerts = mesh.vertices.size();
-    for (size_t i = 0; i < numVerts; i++) {
-        newMesh.addVertex(mesh.vertices[i].position);
-    }
-
-    size_t numFaces = mesh.faceElements.size();
-    size_t newIndexOfVertices = numVerts;
-    std::unordered_map<IndexPair2, IndexPair3, IndexPair2Hash> edgeVertices;
-    std::vector<size_t> newFaces;
-
-    // 处理每个面
-    for (size_t f_id = 0; f_id < numFaces; f_id++) {
-        const FaceElement& face = mesh.faceElements[f_id];
-        size_t startHalfEdgeId = face.startHalfEdgeId;
-        size_t halfEdgeId = startHalfEdgeId;
-
-        std::vector<size_t> vertexIds;
-        do {
-            vertexIds.push_back(mesh.halfEdges[halfEdgeId].fromVertexId);
-            halfEdgeId = mesh.halfEdges[halfEdgeId].nextHalfEdgeId;
-        } while (halfEdgeId != startHalfEdgeId);
-
-        if (vertexIds.size() != 3) {
-            std::cerr << "Error: Only triangular faces are supported!" << std::endl;
-            continue;
-        }
-
-        // 为每条边添加顶点
-        size_t vpIndex = addEdgeVertex(edgeVertices, vertexIds[0], vertexIds[1], vertexIds[2], newIndexOfVertices);
-        if (vpIndex >= newMesh.vertices.size()) {
-            newMesh.addVertex(glm::vec3(0.0f));
-        }
-
-        size_t vqIndex = addEdgeVertex(edgeVertices, vertexIds[1], vertexIds[2], vertexIds[0], newIndexOfVertices);
-        if (vqIndex >= newMesh.vertices.size()) {
-            newMesh.addVertex(glm::vec3(0.0f));
-        }
-
-        size_t vrIndex = addEdgeVertex(edgeVertices, vertexIds[2], vertexIds[0], vertexIds[1], newIndexOfVertices);
-        if (vrIndex >= newMesh.vertices.size()) {
-            newMesh.addVertex(glm::vec3(0.0f));
-        }
-
-        // 新增面
-        newFaces.push_back(vertexIds[0]); newFaces.push_back(vpIndex); newFaces.push_back(vrIndex);
-        newFaces.push_back(vpIndex); newFaces.push_back(vertexIds[1]); newFaces.push_back(vqIndex);
-        newFaces.push_back(vrIndex); newFaces.push_back(vqIndex); newFaces.push_back(vertexIds[2]);
-        newFaces.push_back(vrIndex); newFaces.push_back(vpIndex); newFaces.push_back(vqIndex);
-    }
-
-    // 计算边的中点并设置新顶点的位置
-    for (auto& [edgePair, edgeInfo] : edgeVertices) {
-        size_t v1 = edgePair.v1, v2 = edgePair.v2;
-        size_t vN = edgeInfo.vN;
-        size_t vOpp1 = edgeInfo.vOpp1, vOpp2 = edgeInfo.vOpp2;
-        assert(vN != INVALID_INDEX);
-        assert(v1 != INVALID_INDEX && v2 != INVALID_INDEX);
-        assert(vOpp1 != INVALID_INDEX);
-
-        glm::vec3 v1Pos = newMesh.vertices[v1].position;
-        glm::vec3 v2Pos = newMesh.vertices[v2].position;
-
-        if (vOpp2 == INVALID_INDEX) {
-            newMesh.vertices[vN].position = 0.5f * (v1Pos + v2Pos);
-        } else {
-            glm::vec3 vNOpp1Pos = newMesh.vertices[vOpp1].position;
-            glm::vec3 vNOpp2Pos = newMesh.vertices[vOpp2].position;
-            glm::vec3 newPos = 0.375f * (v1Pos + v2Pos) + 0.125f * (vNOpp1Pos + vNOpp2Pos);
-            newMesh.vertices[vN].position = newPos;
-        }
-    }
-
-    // 更新顶点位置
-    for (size_t v = 0; v < numVerts; v++) {
-        glm::vec3 newPos(0.0f), adjBoundaryPos(0.0f);
-        unsigned adjCount = 0, adjBoundaryCount = 0;
-        const std::vector<size_t>& outgoingHalfEdges = mesh.vertexElements[v].outgoingHalfEdgeIds;
-
-        for (size_t heId : outgoingHalfEdges) {
-            size_t neighborV = mesh.halfEdges[heId].toVertexId;
-            IndexPair2 edgePair(std::min(v, neighborV), std::max(v, neighborV));
-            auto it = edgeVertices.find(edgePair);
-            if (it == edgeVertices.end() || it->second.vOpp2 == INVALID_INDEX) {
-                adjBoundaryCount++;
-                adjBoundaryPos += mesh.vertices[neighborV].position;
-            }
-            newPos += mesh.vertices[neighborV].position;
-            adjCount++;
-        }
-
-        if (adjBoundaryCount == 2) {
-            newPos = 0.75f * mesh.vertices[v].position + 0.125f * adjBoundaryPos;
-        } else {
-            double val = 0.375 + 0.25 * std::cos(2.0 * PI / static_cast<double>(adjCount));
-            double beta = (0.625 - val * val) / static_cast<double>(adjCount);
-            newPos = static_cast<float>((1.0 - beta * adjCount)) * mesh.vertices[v].position + 
-                     static_cast<float>(beta) * glm::vec3(newPos);
-        }
-
-        newMesh.vertices[v].position = newPos;
-    }
-
-    // 创建新面
-    size_t newNumFaces = newFaces.size() / 3;
-    for (size_t f = 0; f < newNumFaces; f++) {
-        size_t loc = f * 3;
-        std::vector<size_t> faceVertices = { newFaces[loc], newFaces[loc + 1], newFaces[loc + 2] };
-        newMesh.addFace(faceVertices);
-    }
-
-    return newMesh;
-}
-
 int subdivisionLevel = 0;
 float subdivisionLevelF = 0.0f;
+float lodDetail = 1.0f; // 第0级渐进网格的细节比例，0为最简网格，1为原网格
 
 void handleInputEvents(GLFWwindow* window) {
     if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) {
@@ -208,6 +39,11 @@ void handleInputEvents(GLFWwindow* window) {
             std::cout << "Subdivision level decreased to: " << subdivisionLevel << std::endl;
         }
     }
+    if (glfwGetKey(window, GLFW_KEY_Z) == GLFW_PRESS) {
+        lodDetail = std::max(0.0f, lodDetail - 0.002f);
+    } else if (glfwGetKey(window, GLFW_KEY_X) == GLFW_PRESS) {
+        lodDetail = std::min(1.0f, lodDetail + 0.002f);
+    }
 }
 
 int main()
@@ -248,9 +84,16 @@ int main()
     // 模型文件路径
     std::string filename = "./src/cow.obj"; 
 
-    // 加载模型并添加到网格列表
-    std::vector<Mesh> meshList;
-    meshList.emplace_back(filename); // 添加模型
+    // 加载模型，交给后台细分线程；meshList 记录已上传到GPU的各级网格
+    std::vector<std::shared_ptr<Mesh>> meshList;
+    meshList.push_back(loadMeshCached(filename)); // 添加模型（优先读取二进制缓存）
+    SubdivisionWorker subdivisionWorker(meshList[0]);
+
+    // 第0级以渐进网格绘制：记录一次折叠序列，Z/X 连续调节面数，只保留一份顶点缓冲
+    ProgressiveMesh progressiveMesh(*meshList[0]);
+    progressiveMesh.setupMesh();
+    std::cout << "渐进网格：" << progressiveMesh.minFaceCount() << " - " << progressiveMesh.maxFaceCount()
+              << " 个面，" << progressiveMesh.splitCount() << " 次顶点分裂。" << std::endl;
 
     // 相机设置
     glm::vec3 cameraPos = glm::vec3(0.0f, 0.0f, 10.0f); // 相机位置
@@ -270,13 +113,21 @@ int main()
         // 处理输入事件
         handleInputEvents(window);
 
-        // 检查是否需要进行细分
-        if (subdivisionLevel >= 0 && static_cast<size_t>(subdivisionLevel) >= meshList.size() - 1) {
-            // 获取当前网格并进行细分
-            Mesh newMesh = LoopSubdivideNative(meshList[subdivisionLevel]);
-            std::cout << "细分级别 " << subdivisionLevel + 1 << " 应用。" << std::endl;
-            newMesh.setupMesh(); // 设置新的网格
-            meshList.push_back(newMesh); // 将细分后的网格添加到网格列表中
+        // 细分在后台线程进行（并预取下一级），这里只在新级别就绪后上传GPU
+        if (subdivisionLevel > subdivisionWorker.getMaxLevel()) {
+            subdivisionLevel = subdivisionWorker.getMaxLevel();
+            subdivisionLevelF = static_cast<float>(subdivisionLevel);
+        }
+        subdivisionWorker.setTargetLevel(subdivisionLevel);
+        // 新级别未就绪前继续绘制已就绪的最高级
+        int drawLevel = std::min(subdivisionLevel, subdivisionWorker.readyLevel());
+        if (static_cast<size_t>(drawLevel) >= meshList.size()) {
+            meshList.resize(drawLevel + 1);
+        }
+        if (!meshList[drawLevel]) {
+            meshList[drawLevel] = subdivisionWorker.getLevel(drawLevel);
+            meshList[drawLevel]->setupMesh(); // 仅在渲染线程上传
+            std::cout << "细分级别 " << drawLevel << " 应用。" << std::endl;
         }
 
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // 清空缓冲区
@@ -297,7 +148,13 @@ int main()
         ourShader.setVec3("backColor", glm::vec3(1.0f, 1.0f, 1.0f)); // 设置背景色为白色
         
         glPolygonMode(GL_FRONT_AND_BACK, GL_LINE); // 设置为线框模式
-        meshList[subdivisionLevel].draw(ourShader); // 绘制当前网格
+        if (drawLevel == 0) {
+            progressiveMesh.setDetail(lodDetail); // 只回放变化的分裂/折叠
+            progressiveMesh.updateBuffers();      // 只上传变化的区间
+            progressiveMesh.draw(ourShader);
+        } else {
+            meshList[drawLevel]->draw(ourShader); // 绘制当前网格
+        }
 
         glfwSwapBuffers(window); // 交换缓冲区
         glfwPollEvents(); // 处理事件
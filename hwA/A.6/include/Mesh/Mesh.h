@@ -10,6 +10,7 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include "Shader/shader.h"
+#include "Mesh/ObjReader.h"
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/gtc/type_ptr.hpp"
@@ -336,41 +337,21 @@ public:
 private:
     // ???????
     void loadFromFile(const std::string& filename) {
-        std::ifstream fin(filename);
-        if (!fin.is_open()) {
-            std::cerr << "Error: Failed to open file " << filename << std::endl;
+        ObjData obj;
+        if (!readObj(filename, obj)) {
             return;
         }
 
-        std::string line;
-        Vec3 vertexPosition;
-        std::vector<size_t> faceVertexIndices(3, INVALID_INDEX);
-
-        while (std::getline(fin, line)) {
-            if (line.empty()) continue; // ????
-
-            std::istringstream stream(line);
-            char prefix;
-            stream >> prefix;
-
-            if (prefix == 'v') { // ??
-                stream >> vertexPosition.x >> vertexPosition.y >> vertexPosition.z;
-                addVertex(vertexPosition);
-            } else if (prefix == 'f') { // ?
-                stream >> faceVertexIndices[0] >> faceVertexIndices[1] >> faceVertexIndices[2];
-                // ???0???
-                for (size_t& idx : faceVertexIndices) {
-                    if (idx == 0) {
-                        std::cerr << "Error: Vertex indices in OBJ files should start from 1." << std::endl;
-                        exit(EXIT_FAILURE);
-                    }
-                    --idx;
-                }
-                addFace(faceVertexIndices);
-            }
+        for (const Vec3& position : obj.positions) {
+            addVertex(position);
+        }
+        // 多边形按扇形三角化后逐面添加
+        std::vector<unsigned int> triangleIndices = obj.triangulate();
+        std::vector<size_t> faceVertexIndices(3);
+        for (size_t i = 0; i < triangleIndices.size(); i += 3) {
+            faceVertexIndices.assign(triangleIndices.begin() + i, triangleIndices.begin() + i + 3);
+            addFace(faceVertexIndices);
         }
-
-        fin.close();
     }
 };
 
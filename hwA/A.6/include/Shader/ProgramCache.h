@@ -0,0 +1,150 @@
+/*
+ * ProgramCache.h
+ *
+ * 着色器程序二进制的磁盘缓存（glGetProgramBinary / glProgramBinary），减少启动时的编译与链接。
+ *
+ * - 键：各阶段源码、GL_VENDOR、GL_RENDERER 与 GL_VERSION（含驱动版本）的 64 位 FNV-1a 哈希，
+ *   源码或驱动变化后自然落到新的文件上
+ * - 文件：<目录>/<键的十六进制>.bin，内容为 头部 (magic, 二进制格式, 长度) + 驱动给出的二进制
+ * - load 失败（文件缺失、损坏，或驱动拒绝该二进制）时返回 false，由调用方重新编译，之后 store 覆盖旧文件
+ * - 驱动不支持任何二进制格式（GL_NUM_PROGRAM_BINARY_FORMATS 为 0）时缓存自动关闭
+ *
+ * 所有函数须在 GL 上下文所在的线程调用。
+ *
+ * 撰写者：Zhiyuan Feng
+ */
+
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "glad/glad.h"
+
+class ProgramCache {
+public:
+    // 所有 Shader 共用的缓存
+    static ProgramCache& shared() {
+        static ProgramCache cache;
+        return cache;
+    }
+
+    bool enabled = true;
+    std::string directory = "./cache/shaders";
+
+    // 由各阶段源码（按顺序，可含空串）与当前驱动计算缓存键
+    uint64_t key(const std::vector<const std::string*>& sources) {
+        uint64_t h = FNV_OFFSET;
+        for (const std::string* source : sources) {
+            h = hashBytes(h, source->data(), source->size());
+            h = hashBytes(h, "\0", 1); // 分隔各阶段，避免拼接后相同
+        }
+        return hashBytes(h, driver().data(), driver().size());
+    }
+
+    // 从缓存装入 program；成功时 program 已链接完成
+    bool load(uint64_t key, GLuint program) {
+        if (!available()) return false;
+        std::ifstream in(pathOf(key), std::ios::binary);
+        if (!in.is_open()) return false;
+        Header header;
+        if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != MAGIC || header.length == 0) {
+            return false;
+        }
+        std::vector<char> binary(header.length);
+        if (!in.read(binary.data(), static_cast<std::streamsize>(binary.size()))) return false;
+
+        glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        return linked == GL_TRUE;
+    }
+
+    // 链接前调用：允许之后取回 program 的二进制
+    void prepare(GLuint program) const {
+        if (enabled) glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    // 把已链接的 program 写入缓存（先写临时文件再改名，中途退出不会留下半个文件）
+    void store(uint64_t key, GLuint program) {
+        if (!available()) return;
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0) return;
+        std::vector<char> binary(static_cast<size_t>(length));
+        Header header{ MAGIC, 0, 0 };
+        GLsizei written = 0;
+        glGetProgramBinary(program, length, &written, &header.format, binary.data());
+        if (written <= 0) return;
+        header.length = static_cast<uint32_t>(written);
+
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        const std::string path = pathOf(key), temp = path + ".tmp";
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            if (!out.is_open()) return;
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(binary.data(), written);
+            if (!out) return;
+        }
+        std::filesystem::rename(temp, path, error);
+        if (error) std::filesystem::remove(temp, error);
+    }
+
+private:
+    struct Header {
+        uint32_t magic;
+        GLenum format;
+        uint32_t length;
+    };
+
+    static const uint32_t MAGIC = 0x31424750; // "PGB1"
+    static const uint64_t FNV_OFFSET = 14695981039346656037ull;
+    static const uint64_t FNV_PRIME = 1099511628211ull;
+
+    std::string driverString;
+    int supported = -1; // -1：尚未查询
+
+    ProgramCache() = default;
+
+    static uint64_t hashBytes(uint64_t h, const char* data, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            h = (h ^ static_cast<unsigned char>(data[i])) * FNV_PRIME;
+        }
+        return h;
+    }
+
+    bool available() {
+        if (supported < 0) {
+            GLint formats = 0;
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+            supported = formats > 0 ? 1 : 0;
+        }
+        return enabled && supported == 1;
+    }
+
+    const std::string& driver() {
+        if (driverString.empty()) {
+            for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+                const GLubyte* value = glGetString(name);
+                driverString += value ? reinterpret_cast<const char*>(value) : "?";
+                driverString += '\n';
+            }
+        }
+        return driverString;
+    }
+
+    std::string pathOf(uint64_t key) const {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+        return directory + "/" + name;
+    }
+};
+
+#endif // PROGRAM_CACHE_H
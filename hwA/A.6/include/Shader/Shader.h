@@ -1,29 +1,43 @@
 /*
  * Shader.h
  * 
- * ??????????????OpenGL????????????????????????????????????
- * ??????????????????????????uniform????????
+ * 这是一个用于加载、编译、链接OpenGL着色器的工具类。该类支持加载顶点着色器、片段着色器和几何着色器（可选）。
+ * 它提供了编译和链接错误检查、着色器程序的管理以及设置uniform变量的工具函数。
  * 
- * ?????
- * - ?????????
- * - ?????????????
- * - ??????????
- * - ??uniform?????????bool?vec3?mat4???
- * - ???????????
+ * 主要功能：
+ * - 加载着色器源码文件
+ * - 编译顶点、片段、几何着色器
+ * - 创建和链接着色器程序
+ * - 提供uniform变量设置函数（包括bool、vec3、mat4类型）
+ * - 链接后一次性查询所有活动uniform的位置，存入按名称哈希排序的表，设置时不再调用glGetUniformLocation
+ * - 名称哈希（UniformName）对字符串字面量可在编译期求值
+ * - 把uniform块绑定到指定的绑定点（与 UniformBuffer 配合）
+ * - 程序二进制缓存（见 ProgramCache）：命中时跳过编译与链接；未命中时只提交编译与链接，
+ *   状态检查推迟到第一次 use，驱动可以同时编译多个程序
+ * - 源码经 ShaderPreprocessor 展开 #include，可带变体宏（defines）
+ * - 热重载：reloadIfChanged 发现源码（含被包含的文件）修改后重新编译链接，失败时保留原程序
+ * - 支持禁用当前着色器程序
  * 
- * ????Zhiyuan Feng
+ * 撰写者：Zhiyuan Feng
  */
 
 #ifndef SHADER_H
 #define SHADER_H
 
-#include "glad/glad.h" // ??glad????????OpenGL???
+#include "glad/glad.h" // 包含glad来获取所有的必须OpenGL头文件
 #include "glm/glm.hpp"
+#include "Shader/ProgramCache.h"
+#include "Shader/ShaderPreprocessor.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <utility>
+#include <vector>
 
 // Helper function to check for compilation and linking errors
 void checkCompileErrors(unsigned int shader, const std::string &type) {
@@ -61,106 +75,297 @@ std::string loadShaderSource(const std::string &filePath) {
     }
 }
 
-// Helper function to compile shader and check for errors
+// Helper function to submit a shader for compilation (errors are checked after linking)
 unsigned int compileShader(GLenum shaderType, const char *shaderCode) {
     unsigned int shader = glCreateShader(shaderType);
     glShaderSource(shader, 1, &shaderCode, nullptr);
     glCompileShader(shader);
-    checkCompileErrors(shader, (shaderType == GL_VERTEX_SHADER ? "VERTEX" :
-                                shaderType == GL_FRAGMENT_SHADER ? "FRAGMENT" : "GEOMETRY"));
     return shader;
 }
 
 
 
+// uniform名称的哈希（FNV-1a）。由字符串字面量构造时可在编译期求值，
+// 例如 static constexpr UniformName MODEL("model");
+// 查找只比较哈希，程序中两个活动uniform的哈希相同时视为错误（见 reflectUniforms）
+struct UniformName {
+    uint32_t hash;
+
+    template <size_t N>
+    constexpr UniformName(const char (&s)[N]) : hash(hashOf(s, N - 1)) {}
+    UniformName(const std::string& s) : hash(hashOf(s.c_str(), s.size())) {}
+
+    static constexpr uint32_t hashOf(const char* s, size_t length) {
+        uint32_t h = 2166136261u;
+        for (size_t i = 0; i < length; ++i) {
+            h = (h ^ static_cast<unsigned char>(s[i])) * 16777619u;
+        }
+        return h;
+    }
+};
+
 class Shader
 {
     public:
-        // ??ID
+        // 程序ID
         unsigned int programID;
 
-        // ???????????
-        Shader(const GLchar* vertexFilePath, const GLchar* fragmentFilePath, const char* geometryFilePath = nullptr) {
-            // ?????????/???????
-            std::string vertexSource = loadShaderSource(vertexFilePath);
-            std::string fragmentSource = loadShaderSource(fragmentFilePath);
-            std::string geometrySource = geometryFilePath ? loadShaderSource(geometryFilePath) : "";
+        // 构造器读取并预处理着色器源码，缓存命中时直接装入程序二进制，否则提交编译与链接。
+        // defines 为变体宏，每项 "NAME" 或 "NAME=VALUE"
+        Shader(const GLchar* vertexFilePath, const GLchar* fragmentFilePath, const char* geometryFilePath = nullptr,
+               const std::vector<std::string> &defines = {})
+            : stagePaths{ vertexFilePath, fragmentFilePath, geometryFilePath ? geometryFilePath : "" }, defines(defines) {
+            // 创建着色器程序
+            programID = glCreateProgram();
+            std::string sources[3];
+            loadSources(sources);
+            submit(sources);
+        }
 
-            // ?????
-            unsigned int vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource.c_str());
-            unsigned int fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource.c_str());
-            unsigned int geometryShader = 0;
+        Shader(const Shader&) = delete;
+        Shader& operator=(const Shader&) = delete;
 
-            if (!geometrySource.empty()) {
-                geometryShader = compileShader(GL_GEOMETRY_SHADER, geometrySource.c_str());
-            }
+        ~Shader() {
+            glDeleteProgram(programID);
+        }
 
-            // ???????
-            programID = glCreateProgram();
-            glAttachShader(programID, vertexShader);
-            glAttachShader(programID, fragmentShader);
-            if (geometryShader) glAttachShader(programID, geometryShader);
-            glLinkProgram(programID);
+        void use() {
+            finishLink();
+            glUseProgram(programID);
+        }
 
-            // ??????
+        // 等待链接完成：检查编译与链接错误，查询uniform位置，写入程序缓存（只执行一次）；返回是否链接成功
+        bool finishLink() {
+            if (!linkPending) return linked;
+            linkPending = false;
+
+            // 检查编译错误
+            for (const auto &shader : pendingShaders) {
+                checkCompileErrors(shader.first, shader.second);
+            }
+            // 检查链接错误
             checkCompileErrors(programID, "PROGRAM");
 
-            // ???????????????????????
-            glDeleteShader(vertexShader);
-            glDeleteShader(fragmentShader);
-            if (geometryShader) glDeleteShader(geometryShader);
+            // 删除单独的着色器对象（它们已经被链接到程序中）
+            for (const auto &shader : pendingShaders) {
+                glDeleteShader(shader.first);
+            }
+            pendingShaders.clear();
+
+            GLint status = GL_FALSE;
+            glGetProgramiv(programID, GL_LINK_STATUS, &status);
+            linked = status == GL_TRUE && reflectUniforms();
+            if (linked) {
+                ProgramCache::shared().store(cacheKey, programID);
+            }
+            return linked;
         }
 
-        ~Shader() {
+        // 源码（含被包含的文件）修改过时重新编译链接。成功时换用新程序并返回 true
+        // （uniform块绑定与只设置一次的uniform须由调用方重新设置）；失败时输出错误，继续使用原程序
+        bool reloadIfChanged() {
+            bool changed = false;
+            for (const auto &file : watchedFiles) {
+                std::error_code error;
+                changed = changed || std::filesystem::last_write_time(file.first, error) != file.second;
+            }
+            if (!changed) return false;
+
+            finishLink();
+            const GLuint oldProgram = programID;
+            const uint64_t oldKey = cacheKey;
+            const bool oldLinked = linked;
+            const auto oldLocations = uniformLocations;
+
+            std::string sources[3];
+            programID = glCreateProgram();
+            if (loadSources(sources)) {
+                submit(sources);
+                if (finishLink()) {
+                    glDeleteProgram(oldProgram);
+                    std::cout << "Reloaded shader " << stagePaths[0] << " + " << stagePaths[1] << std::endl;
+                    return true;
+                }
+            }
+            // 保留原程序；修改时间已更新，再次保存文件后重试
             glDeleteProgram(programID);
+            programID = oldProgram;
+            cacheKey = oldKey;
+            linked = oldLinked;
+            uniformLocations = oldLocations;
+            return false;
         }
 
-        void use() {
-            glUseProgram(programID);
+        // uniform的位置，不存在（或已被编译器优化掉）时为 -1，此时 glUniform* 不做任何事
+        GLint uniformLocation(UniformName name) const {
+            auto it = std::lower_bound(uniformLocations.begin(), uniformLocations.end(), name.hash,
+                                       [](const std::pair<uint32_t, GLint> &entry, uint32_t hash) { return entry.first < hash; });
+            return it != uniformLocations.end() && it->first == name.hash ? it->second : -1;
         }
 
-        void setBool(const std::string &name, bool value) const {
-            glUniform1i(glGetUniformLocation(programID, name.c_str()), (int)value);
+        // 把名为 blockName 的uniform块绑定到绑定点 binding，程序中没有该块时返回 false
+        bool bindUniformBlock(const char *blockName, GLuint binding) {
+            finishLink();
+            GLuint index = glGetUniformBlockIndex(programID, blockName);
+            if (index == GL_INVALID_INDEX) return false;
+            glUniformBlockBinding(programID, index, binding);
+            return true;
         }
-        void setInt(const std::string &name, int value) const {
-            glUniform1i(glGetUniformLocation(programID, name.c_str()), value); 
+
+        void setBool(UniformName name, bool value) const {
+            glUniform1i(uniformLocation(name), (int)value);
+        }
+        void setInt(UniformName name, int value) const {
+            glUniform1i(uniformLocation(name), value); 
         }
-        void setFloat(const std::string &name, float value) const {
-            glUniform1f(glGetUniformLocation(programID, name.c_str()), value); 
+        void setFloat(UniformName name, float value) const {
+            glUniform1f(uniformLocation(name), value); 
         }
         // ------------------------------------------------------------------------
-        void setVec2(const std::string &name, const glm::vec2 &value) const{ 
-            glUniform2fv(glGetUniformLocation(programID, name.c_str()), 1, &value[0]); 
+        void setVec2(UniformName name, const glm::vec2 &value) const{ 
+            glUniform2fv(uniformLocation(name), 1, &value[0]); 
+        }
+        void setVec2(UniformName name, float x, float y) const{ 
+            glUniform2f(uniformLocation(name), x, y); 
         }
-        void setVec2(const std::string &name, float x, float y) const{ 
-            glUniform2f(glGetUniformLocation(programID, name.c_str()), x, y); 
+        // 一次上传整个 vec2 数组（name 为不带下标的数组名）
+        void setVec2Array(UniformName name, const glm::vec2 *values, int count) const{ 
+            glUniform2fv(uniformLocation(name), count, &values[0][0]); 
         }
-        void setVec3(const std::string &name, const glm::vec3 &value) const{ 
-            glUniform3fv(glGetUniformLocation(programID, name.c_str()), 1, &value[0]); 
+        void setVec3(UniformName name, const glm::vec3 &value) const{ 
+            glUniform3fv(uniformLocation(name), 1, &value[0]); 
         }
-        void setVec3(const std::string &name, float x, float y, float z) const{ 
-            glUniform3f(glGetUniformLocation(programID, name.c_str()), x, y, z); 
+        void setVec3(UniformName name, float x, float y, float z) const{ 
+            glUniform3f(uniformLocation(name), x, y, z); 
         }
-        void setVec4(const std::string &name, const glm::vec4 &value) const{ 
-            glUniform4fv(glGetUniformLocation(programID, name.c_str()), 1, &value[0]); 
+        void setVec4(UniformName name, const glm::vec4 &value) const{ 
+            glUniform4fv(uniformLocation(name), 1, &value[0]); 
         }
-        void setVec4(const std::string &name, float x, float y, float z, float w) { 
-            glUniform4f(glGetUniformLocation(programID, name.c_str()), x, y, z, w); 
+        void setVec4(UniformName name, float x, float y, float z, float w) { 
+            glUniform4f(uniformLocation(name), x, y, z, w); 
         }
         // ------------------------------------------------------------------------
-        void setMat2(const std::string &name, const glm::mat2 &mat) const{
-            glUniformMatrix2fv(glGetUniformLocation(programID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        void setMat2(UniformName name, const glm::mat2 &mat) const{
+            glUniformMatrix2fv(uniformLocation(name), 1, GL_FALSE, &mat[0][0]);
         }
-        void setMat3(const std::string &name, const glm::mat3 &mat) const{
-            glUniformMatrix3fv(glGetUniformLocation(programID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        void setMat3(UniformName name, const glm::mat3 &mat) const{
+            glUniformMatrix3fv(uniformLocation(name), 1, GL_FALSE, &mat[0][0]);
         }
-        void setMat4(const std::string &name, const glm::mat4 &mat) const{
-            glUniformMatrix4fv(glGetUniformLocation(programID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        void setMat4(UniformName name, const glm::mat4 &mat) const{
+            glUniformMatrix4fv(uniformLocation(name), 1, GL_FALSE, &mat[0][0]);
         }
 
-        // ???????
+        // 禁用当前着色器
         void disableShaders() const {
-            glUseProgram(0); // ?????
+            glUseProgram(0); // 禁用着色器
+        }
+
+    private:
+        std::string stagePaths[3];         // 顶点、片段、几何（可为空）着色器文件
+        std::vector<std::string> defines;  // 变体宏
+        std::vector<std::pair<std::string, std::filesystem::file_time_type>> watchedFiles; // 参与预处理的文件及修改时间
+
+        uint64_t cacheKey = 0;
+        bool linkPending = false;
+        bool linked = false;
+        std::vector<std::pair<unsigned int, const char*>> pendingShaders; // 已提交、尚未检查的着色器及其阶段名
+
+        // 预处理各阶段源码并记录参与的文件；某一阶段失败时返回 false（该阶段源码为空）
+        bool loadSources(std::string (&sources)[3]) {
+            watchedFiles.clear();
+            bool ok = true;
+            for (int stage = 0; stage < 3; ++stage) {
+                if (stagePaths[stage].empty()) continue;
+                ShaderSource source;
+                ok = preprocessShader(stagePaths[stage], defines, source) && ok;
+                sources[stage] = source.text;
+                if (source.files.empty()) source.files.push_back(stagePaths[stage]); // 入口文件读取失败时也要监视
+                for (const std::string &file : source.files) {
+                    std::error_code error;
+                    watchedFiles.emplace_back(file, std::filesystem::last_write_time(file, error));
+                }
+            }
+            return ok;
+        }
+
+        // 缓存命中时装入程序二进制，否则提交编译与链接（状态在 finishLink 中检查）
+        void submit(const std::string (&sources)[3]) {
+            ProgramCache &cache = ProgramCache::shared();
+            cacheKey = cache.key({ &sources[0], &sources[1], &sources[2] });
+            if (cache.load(cacheKey, programID)) {
+                linked = reflectUniforms();
+                return;
+            }
+
+            // 编译着色器
+            const GLenum types[3] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_GEOMETRY_SHADER };
+            const char *names[3] = { "VERTEX", "FRAGMENT", "GEOMETRY" };
+            for (int stage = 0; stage < 3; ++stage) {
+                if (stage == 2 && sources[stage].empty()) continue;
+                pendingShaders.emplace_back(compileShader(types[stage], sources[stage].c_str()), names[stage]);
+            }
+            for (const auto &shader : pendingShaders) {
+                glAttachShader(programID, shader.first);
+            }
+            cache.prepare(programID);
+            glLinkProgram(programID);
+            linkPending = true;
+        }
+
+        // (名称哈希, 位置)，按哈希排序
+        std::vector<std::pair<uint32_t, GLint>> uniformLocations;
+
+        // 链接后遍历活动uniform。数组（GL 报告为 "name[0]"）同时登记数组名和每个元素 "name[i]"；
+        // uniform块中的成员没有位置，跳过。两个名称的哈希相同时输出错误、清空位置表并返回 false
+        bool reflectUniforms() {
+            uniformLocations.clear();
+            std::vector<std::string> names; // 与 uniformLocations 一一对应，仅用于检查冲突
+            GLint count = 0, maxLength = 0;
+            glGetProgramiv(programID, GL_ACTIVE_UNIFORMS, &count);
+            glGetProgramiv(programID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+            std::vector<char> buffer(std::max(maxLength, 1));
+            auto add = [this, &names](const std::string &name, GLint location) {
+                if (location < 0) return;
+                uniformLocations.emplace_back(UniformName(name).hash, location);
+                names.push_back(name);
+            };
+            for (GLint i = 0; i < count; ++i) {
+                GLsizei length = 0;
+                GLint size = 0;
+                GLenum type = 0;
+                glGetActiveUniform(programID, static_cast<GLuint>(i), maxLength, &length, &size, &type, buffer.data());
+                const std::string name(buffer.data(), length);
+                const GLint location = glGetUniformLocation(programID, name.c_str());
+                if (location < 0) continue;
+                const std::string suffix = "[0]";
+                if (name.size() <= suffix.size() || name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+                    add(name, location);
+                    continue;
+                }
+                const std::string base = name.substr(0, name.size() - suffix.size());
+                add(base, location);
+                for (GLint e = 0; e < size; ++e) {
+                    const std::string element = base + "[" + std::to_string(e) + "]";
+                    add(element, glGetUniformLocation(programID, element.c_str()));
+                }
+            }
+            std::vector<size_t> order(uniformLocations.size());
+            for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+            std::sort(order.begin(), order.end(), [this](size_t a, size_t b) { return uniformLocations[a] < uniformLocations[b]; });
+            bool ok = true;
+            for (size_t i = 1; i < order.size(); ++i) {
+                if (uniformLocations[order[i]].first == uniformLocations[order[i - 1]].first) {
+                    std::cerr << "ERROR::SHADER::UNIFORM_HASH_COLLISION in program " << programID << ": \""
+                              << names[order[i - 1]] << "\" and \"" << names[order[i]] << "\"" << std::endl;
+                    ok = false;
+                }
+            }
+            if (!ok) {
+                uniformLocations.clear();
+                return false;
+            }
+            std::sort(uniformLocations.begin(), uniformLocations.end());
+            return true;
         }
 };
 
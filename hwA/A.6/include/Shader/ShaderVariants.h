@@ -0,0 +1,92 @@
+/*
+ * ShaderVariants.h
+ *
+ * 同一组着色器文件按变体宏（defines）编译出的多个程序，例如地面的 FLAT_SHADING 变体。
+ *
+ * - get(defines) 第一次用到某个组合时才编译，之后复用（宏的顺序不同视为同一组合）
+ * - request(defines) 只提交编译与链接、不等待，便于和其他程序同时编译；之后第一次 get 时才等待并调用 setup
+ * - setup 在程序第一次 get 与每次热重载成功后调用，用于绑定uniform块、设置纹理单元等只设置一次的状态
+ * - reloadIfChanged 检查所有已创建的变体
+ *
+ * 所有函数须在 GL 上下文所在的线程调用。
+ *
+ * 撰写者：Zhiyuan Feng
+ */
+
+#ifndef SHADER_VARIANTS_H
+#define SHADER_VARIANTS_H
+
+#include "Shader/Shader.h"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ShaderVariants {
+public:
+    std::function<void(Shader&)> setup; // 创建与重载后调用，可为空
+
+    ShaderVariants(std::string vertexFilePath, std::string fragmentFilePath)
+        : vertexPath(std::move(vertexFilePath)), fragmentPath(std::move(fragmentFilePath)) {}
+
+    ShaderVariants(const ShaderVariants&) = delete;
+    ShaderVariants& operator=(const ShaderVariants&) = delete;
+
+    // 取得 defines 对应的程序，不存在时编译；第一次取得时调用 setup
+    Shader& get(std::vector<std::string> defines = {}) {
+        Variant& variant = find(std::move(defines));
+        if (!variant.setUp) {
+            variant.setUp = true;
+            if (setup) setup(*variant.shader);
+        }
+        return *variant.shader;
+    }
+
+    // 提交 defines 对应程序的编译与链接（已存在时不做任何事），不等待链接完成
+    void request(std::vector<std::string> defines = {}) {
+        find(std::move(defines));
+    }
+
+    // 重新编译源码有修改的变体，返回成功重载的个数
+    int reloadIfChanged() {
+        int reloaded = 0;
+        for (auto& entry : variants) {
+            Variant& variant = entry.second;
+            if (variant.shader->reloadIfChanged()) {
+                if (variant.setUp && setup) setup(*variant.shader);
+                ++reloaded;
+            }
+        }
+        return reloaded;
+    }
+
+private:
+    struct Variant {
+        std::unique_ptr<Shader> shader;
+        bool setUp = false; // 是否已调用过 setup
+    };
+
+    std::string vertexPath, fragmentPath;
+    std::map<std::string, Variant> variants; // 排序后的宏（换行分隔） -> 程序
+
+    Variant& find(std::vector<std::string> defines) {
+        std::sort(defines.begin(), defines.end());
+        std::string key;
+        for (const std::string& define : defines) {
+            key += define;
+            key += '\n';
+        }
+        auto it = variants.find(key);
+        if (it == variants.end()) {
+            Variant variant;
+            variant.shader = std::make_unique<Shader>(vertexPath.c_str(), fragmentPath.c_str(), nullptr, defines);
+            it = variants.emplace(key, std::move(variant)).first;
+        }
+        return it->second;
+    }
+};
+
+#endif // SHADER_VARIANTS_H
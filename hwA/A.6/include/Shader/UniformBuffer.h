@@ -0,0 +1,48 @@
+/*
+ * UniformBuffer.h
+ *
+ * uniform缓冲对象（UBO）：一块 GL_UNIFORM_BUFFER 固定绑定到一个绑定点，
+ * 所有用 Shader::bindUniformBlock 绑定到同一绑定点的程序共享其中的数据，每次更新只上传一次。
+ * C++ 侧的结构体须按 std140 布局（mat4 / vec4 按 16 字节对齐，vec3 之后补一个 float）。
+ *
+ * GL 对象随上下文一起销毁（与 CDLODTerrain 相同）。
+ *
+ * 撰写者：Zhiyuan Feng
+ */
+
+#ifndef UNIFORM_BUFFER_H
+#define UNIFORM_BUFFER_H
+
+#include "glad/glad.h"
+
+class UniformBuffer {
+public:
+    UniformBuffer() = default;
+    UniformBuffer(const UniformBuffer&) = delete;
+    UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+    // 分配 size 字节并绑定到绑定点 binding
+    void create(GLsizeiptr size, GLuint binding) {
+        bindingPoint = binding;
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, buffer);
+    }
+
+    // 更新 [offset, offset + size) 的内容
+    void update(const void* data, GLsizeiptr size, GLintptr offset = 0) const {
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    GLuint binding() const { return bindingPoint; }
+
+private:
+    GLuint buffer = 0;
+    GLuint bindingPoint = 0;
+};
+
+#endif // UNIFORM_BUFFER_H
@@ -0,0 +1,8 @@
+// ƬΣɸɫ #include Shader/ShaderPreprocessor.h
+// C++ ಼ּ main.cpp е CameraUniforms󶨵Ϊ TerrainEngine::CAMERA_BINDING
+// ÿ֡ݣstd140ͬһ UBO
+layout(std140) uniform Camera {
+    mat4 view;       // ͼ
+    mat4 projection; // ͶӰ
+    vec3 viewPos;    // λã꣩
+};
@@ -2,12 +2,18 @@
 
 in vec3 FragPos;   // ӶɫƬλã꣩
 in vec2 TexCoords; // Ӷɫ
+#ifdef FLAT_SHADING
+flat in vec3 Normal; // ֵķߣFLAT_SHADING 壩
+#else
+in vec3 Normal;    // Ӷɫķߣ꣩
+#endif
 
 out vec4 FragColor; // ɫ
 
 uniform sampler2D land_Texture;   // λ
 uniform sampler2D detail_Texture; // ϸ
 uniform float detail_scale;       // ϸϵ
+uniform vec3 lightDir;            // ƽйָⷽԴ
 
 void main() {
     // λ
@@ -21,5 +27,9 @@ void main() {
     float detailWeight = 1.0 - baseWeight; // ϸȨ
     vec3 finalColor = mix(baseColor, detailColor, detailWeight);
 
+    //  + 
+    float diffuse = max(dot(normalize(Normal), lightDir), 0.0);
+    finalColor *= 0.6 + 0.4 * diffuse;
+
     FragColor = vec4(finalColor, 1.0);
 }
\ No newline at end of file
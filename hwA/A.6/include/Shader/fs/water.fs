@@ -3,11 +3,13 @@
 in vec2 TexCoords; // Ӷɫ
 in vec3 Normal;    // Ӷɫķ
 in vec3 FragPos;   // ӶɫƬλ
+in vec4 ClipPos;   // ӶɫĲüռλ
 
 out vec4 FragColor; // ɫ
 
 uniform sampler2D texture; // ˮ
-uniform float water_alpha; // ˮ͸
+uniform sampler2D reflection_Texture; // ȾĻ룩
+uniform float water_alpha; // ˮռΪ
 uniform float xShift;      // ̬Xƫ
 uniform float yShift;      // ̬Yƫ
 uniform float texture_scale; // ظ
@@ -30,5 +32,10 @@ void main()
     // ˮɫͷǿ
     vec3 finalColor = mix(baseColor.rgb, vec3(0.8, 0.9, 1.0), clamp(reflectStrength, 0.0, 1.0));
 
-    FragColor = vec4(finalColor, water_alpha); // Ӧ͸
+    // ͶӰ꣺ƬĻϵλüжӦλã沨΢Ŷ
+    vec2 reflectCoords = ClipPos.xy / ClipPos.w * 0.5 + 0.5;
+    reflectCoords += (baseColor.rg - 0.5) * 0.01;
+    vec3 reflectColor = texture(reflection_Texture, clamp(reflectCoords, 0.001, 0.999)).rgb;
+
+    FragColor = vec4(mix(reflectColor, finalColor, water_alpha), 1.0); // 뷴
 }
@@ -1,34 +1,74 @@
 #version 330 core
 
-layout (location = 0) in vec3 aPos;       // λ
-layout (location = 1) in vec2 aTexCoords; // 
+// CDLOD Σнڵ㹲һ壬 gl_VertexID õ
+// ߶ȴƬ Terrain/CDLODTerrain.h
+layout (location = 1) in vec4 aNode; // ʵ(ʼ, ʼ, ߳, LOD )
+layout (location = 2) in vec4 aTile; // ʵ(Ƭ x, y, Ƭ / 0, )
 
 uniform mat4 model;      // ģ;
-uniform mat4 view;       // ͼ
-uniform mat4 projection; // ͶӰ
+#include "../common/camera.glsl" // Camera uniform飨viewprojectionviewPos
 
-uniform sampler2D heightMap; // ߶ͼ
+uniform sampler2DArray heightTiles; // ߶Ƭ
+uniform sampler2DArray normalTiles; // Ƭ (nx, nz)߶Ƭͬ
+uniform float tileSamples;          // Ƭÿ߲
+uniform vec2 heightMapSize;         // 0߶ͼߴ (, )
 uniform float heightScale;   // ߶ϵ
+uniform float gridSize;      // ÿڵ߳
+uniform vec2 lodMorph[16];   // α (ʼ, )ռ
+uniform vec3 cameraPos;      // λã꣩
 
 out vec3 FragPos;   // ݵƬɫƬλã꣩
 out vec2 TexCoords; // ݵƬɫ
+// FLAT_SHADING 壺ֵ߲ÿȡһ㣨provoking vertexķ
+#ifdef FLAT_SHADING
+flat out vec3 Normal;
+#else
+out vec3 Normal;    // ݵƬɫķߣ꣩
+#endif
 
-uniform bool isUp;
 uniform float offset;
+uniform float clipHeight; //  y ڸֵĲֱõgl_ClipDistance
+
+//  (, ) -> Ƭ
+vec3 tileUV(vec2 sampleCoord) {
+    sampleCoord = clamp(sampleCoord, vec2(0.0), heightMapSize - 1.0);
+    vec2 tileCoord = sampleCoord * aTile.z - aTile.xy;
+    return vec3((tileCoord + 0.5) / tileSamples, aTile.w);
+}
+
+//  (, ) -> ľֲ
+vec3 terrainPos(vec2 sampleCoord) {
+    sampleCoord = clamp(sampleCoord, vec2(0.0), heightMapSize - 1.0);
+    float h = textureLod(heightTiles, tileUV(sampleCoord), 0.0).r;
+    vec3 aPos = vec3(sampleCoord.y / heightMapSize.y, h, sampleCoord.x / heightMapSize.x);
+    return vec3((aPos.x - 0.5)*0.2 , (aPos.y*heightScale + offset) , (aPos.z - 0.5)*0.2);
+}
 
 void main() {
-    // ϵ aPos.xz תΪ
-    TexCoords = aPos.xz;
+    //  (0 ~ gridSize) v Ӧ (v % (gridSize + 1), v / (gridSize + 1))
+    int gridVerts = int(gridSize) + 1;
+    vec2 aGrid = vec2(float(gl_VertexID % gridVerts), float(gl_VertexID / gridVerts));
+
+    float step = aNode.z / gridSize;
+    vec2 sampleCoord = aNode.xy + aGrid * step;
+
+    // ľƵһ
+    vec2 morphRange = lodMorph[int(aNode.w)];
+    float dist = distance(cameraPos, vec3(model * vec4(terrainPos(sampleCoord), 1.0)));
+    float k = clamp((dist - morphRange.x) / (morphRange.y - morphRange.x), 0.0, 1.0);
+    sampleCoord -= fract(aGrid * 0.5) * 2.0 * step * k;
 
+    vec3 adjustedPos = terrainPos(sampleCoord);
+    vec2 clamped = clamp(sampleCoord, vec2(0.0), heightMapSize - 1.0);
+    TexCoords = vec2(clamped.y / heightMapSize.y, clamped.x / heightMapSize.x);
 
-    //  y ꣬ y Ϊ -0.5
-    vec3 adjustedPos = vec3((aPos.x - 0.5)*0.2 , (aPos.y*heightScale + offset) , (aPos.z - 0.5)*0.2);
+    // ڲü߶ȵĲӲüڲü߶ȵĽڵ CPU ޳
+    gl_ClipDistance[0] = adjustedPos.y - clipHeight;
 
-    //  y ꣬ -0.49
-    if ((adjustedPos.y < -0.46 && isUp == true) || (isUp == false && adjustedPos.y < 0.46)) {
-        gl_Position = vec4(0.0, 0.0, 0.0, 0.0); // 
-        return;
-    }
+    // ߣƬд (nx, nz)ny Ϊmodel ֻ/ƽ
+    vec2 nxz = textureLod(normalTiles, tileUV(sampleCoord), 0.0).rg;
+    vec3 localNormal = vec3(nxz.x, sqrt(max(1.0 - dot(nxz, nxz), 0.0)), nxz.y);
+    Normal = normalize(mat3(model) * localNormal);
 
     // Ķתϵ
     FragPos = vec3(model * vec4(adjustedPos, 1.0));
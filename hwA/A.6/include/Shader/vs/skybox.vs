@@ -2,15 +2,16 @@
 
 layout (location = 0) in vec3 aPos; // λ
 
-uniform mat4 projection;  // ͶӰ
-uniform mat4 view;        // ͼ
+#include "../common/camera.glsl" // Camera uniform飨viewprojectionviewPos
 uniform mat4 model;      // ģ;
 
 out vec3 TexCoords;       // ݸƬɫ
 
 void main() {
-    // ӳ䵽 [-0.5, 0.5]ͼ
+    // ϵλ [-0.5, 0.5] ͼĲ
     TexCoords = aPos; 
 
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    // z ȡ w͸ӳȺΪ 1Զƽ棩 GL_LEQUAL ֻڿհ״
+    vec4 pos = projection * view * model * vec4(aPos, 1.0);
+    gl_Position = pos.xyww;
 }
\ No newline at end of file
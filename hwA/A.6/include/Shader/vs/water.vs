@@ -5,12 +5,12 @@ layout (location = 1) in vec2 aTexCoords;
 layout (location = 2) in vec3 aNormal;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#include "../common/camera.glsl" // Camera uniform飨viewprojectionviewPos
 
 out vec2 TexCoords; // ݵƬɫ
 out vec3 Normal;    // ݵƬɫķ
 out vec3 FragPos;   // ݵƬɫƬλ
+out vec4 ClipPos;   // üռλãڼ㷴ͶӰ
 
 void main()
 {
@@ -24,4 +24,5 @@ void main()
     TexCoords = aPos.xz; //  aPos.xz Ѿ [-0.5, 0.5]
     
     gl_Position = projection * view * vec4(FragPos, 1.0);
+    ClipPos = gl_Position;
 }
@@ -0,0 +1,544 @@
+/*
+ * CDLODTerrain.h
+ *
+ * 分块四叉树地形（CDLOD, Strugar 2010）：
+ * - 所有节点共用一块 gridSize x gridSize 网格的 16 位索引缓冲，没有顶点缓冲：顶点着色器由 gl_VertexID
+ *   （即索引值）得到网格坐标，再从 16 位高度瓦片采样高度，GPU 上每个采样只占 2 字节
+ * - 第 l 级节点覆盖 gridSize * 2^l 个采样间隔；每级节点的最小/最大高度由 TileStore 的分块数据合并得到
+ *   （min-max 金字塔），用于构造节点包围盒
+ * - 每帧按相机距离自顶向下选择节点：节点处于下一级的 LOD 范围内则细分，否则整块以本级绘制；
+ *   不在视锥内、整体低于裁剪高度的节点直接跳过；选择完成后可再按地平线剔除被近处山体挡住的节点
+ * - 顶点在本级 LOD 范围的末段逐渐“形变”（morph）到上一级网格，相邻级别之间没有裂缝和跳变
+ * - 选中的节点写入实例缓冲，整个地形一次 glDrawElementsInstanced 完成
+ * - 高度数据按瓦片驻留在一个纹理数组中（最多 tileBudget 层，按最近使用淘汰）：第 l 级节点使用第 l 级瓦片，
+ *   尚未读入时向后台线程请求，并暂用已驻留的更粗一级瓦片绘制；最粗一级只有一个瓦片，始终驻留
+ * - 每个高度瓦片附带一个同层的法线瓦片（RG8_SNORM，由后台线程按 Sobel 梯度计算，见 TerrainNormals.h）
+ *
+ * 地形局部坐标与原 land.obj 一致：采样点 (row, col) 为 (row / H, h, col / W)。
+ * 局部坐标到模型坐标的变换见 localTransform，须与 land.vs 中的计算保持一致。
+ *
+ * 撰写者：Zhiyuan Feng
+ */
+
+#ifndef CDLOD_TERRAIN_H
+#define CDLOD_TERRAIN_H
+
+#include <algorithm>
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include "Shader/Shader.h"
+#include "Parallel/ParallelFor.h"
+#include "Terrain/Frustum.h"
+#include "Terrain/HorizonCulling.h"
+#include "Terrain/TerrainNormals.h"
+#include "Terrain/TileStore.h"
+#include "Terrain/TileStreamer.h"
+
+class CDLODTerrain {
+public:
+    // 每次 select 的剔除统计
+    struct CullStats {
+        size_t nodesTested = 0;   // 参与测试的节点数
+        size_t frustumCulled = 0; // 视锥外
+        size_t heightCulled = 0;  // 整体低于裁剪高度
+        size_t horizonCulled = 0; // 被地平线挡住
+        size_t patchesDrawn = 0;  // 最终提交的节点数
+        size_t tilesRequested = 0; // 本次请求后台读取的瓦片数
+        size_t tileFallbacks = 0;  // 暂用更粗一级瓦片绘制的节点数
+    };
+
+    static constexpr int MAX_LOD_LEVELS = 16;
+    static constexpr int HEIGHT_MAP_UNIT = 2; // 高度瓦片使用的纹理单元
+    static constexpr int NORMAL_MAP_UNIT = 3; // 法线瓦片使用的纹理单元
+    static constexpr float HORIZONTAL_SCALE = 0.2f; // 整张高度图在局部 x / z 方向的跨度
+
+    int gridSize = 32;          // 每个节点的网格边长（须为分块边长的 2 的幂倍，且整除瓦片边长）
+    int tileBudget = 256;       // 同时驻留的瓦片数（纹理数组层数）
+    float lodRangeScale = 4.0f; // 第0级 LOD 范围 = 叶节点世界尺寸 * lodRangeScale，逐级加倍
+    float morphStartRatio = 0.66f; // 形变从本级范围的该比例处开始
+
+    // 与 land.vs 相同的局部 -> 模型变换：((x - 0.5) * 0.2, y * heightScale + offset, (z - 0.5) * 0.2)
+    static glm::mat4 localTransform(float heightScale, float offset) {
+        glm::mat4 m = glm::translate(glm::mat4(1.0f), glm::vec3(-0.5f * HORIZONTAL_SCALE, offset, -0.5f * HORIZONTAL_SCALE));
+        return glm::scale(m, glm::vec3(HORIZONTAL_SCALE, heightScale, HORIZONTAL_SCALE));
+    }
+
+    // 由瓦片存储构建四叉树（min-max 金字塔）；store 须在本对象之后销毁
+    bool build(const TileStore& tileStore) {
+        const int blockSize = tileStore.blockSize();
+        int shift = 0;
+        while ((blockSize << shift) < gridSize) ++shift;
+        if ((blockSize << shift) != gridSize || tileStore.tileSize() % gridSize != 0) {
+            std::cerr << "Error: Grid size " << gridSize << " does not match tile store layout" << std::endl;
+            return false;
+        }
+        store = &tileStore;
+        width = tileStore.width();
+        height = tileStore.height();
+        const int cellsX = std::max(1, width - 1), cellsY = std::max(1, height - 1);
+
+        levelCount = 1;
+        while (levelCount < MAX_LOD_LEVELS && (gridSize << (levelCount - 1)) < std::max(cellsX, cellsY)) {
+            ++levelCount;
+        }
+        levels.assign(levelCount, Level());
+        for (int l = 0; l < levelCount; ++l) {
+            levels[l].nodeSize = gridSize << l;
+        }
+
+        // 分块金字塔：第 k 层每格覆盖 blockSize * 2^k 个单元，第 shift + l 层即四叉树第 l 级；
+        // 第一个格数不超过 MAX_OCCLUDERS 的层用作地平线遮挡格
+        static constexpr size_t MAX_OCCLUDERS = 4096;
+        std::vector<glm::vec2> current(reinterpret_cast<const glm::vec2*>(tileStore.blockMinMax()),
+                                       reinterpret_cast<const glm::vec2*>(tileStore.blockMinMax()) +
+                                           static_cast<size_t>(tileStore.blocksX()) * tileStore.blocksY());
+        int countX = tileStore.blocksX(), countY = tileStore.blocksY();
+        occluderMin.clear();
+        for (int k = 0; k < shift + levelCount; ++k) {
+            if (occluderMin.empty() && static_cast<size_t>(countX) * countY <= MAX_OCCLUDERS) {
+                buildOccluders(current, countX, countY, blockSize << k);
+            }
+            if (k >= shift) {
+                Level& level = levels[k - shift];
+                level.countX = countX;
+                level.countY = countY;
+                level.minMax = current;
+            }
+            current = combine(current, countX, countY);
+            countX = (countX + 1) / 2;
+            countY = (countY + 1) / 2;
+        }
+        if (occluderMin.empty()) {
+            buildOccluders(current, countX, countY, blockSize << (shift + levelCount));
+        }
+        return true;
+    }
+
+    // 创建网格、实例缓冲与高度/法线瓦片纹理数组，载入常驻的最粗一级瓦片并启动后台读取线程
+    void setupMesh() {
+        // 共享网格：(gridSize + 1)^2 个顶点，索引 v 对应网格坐标 (v % (gridSize + 1), v / (gridSize + 1))
+        std::vector<uint16_t> gridIndices;
+        for (int j = 0; j < gridSize; ++j) {
+            for (int i = 0; i < gridSize; ++i) {
+                uint16_t v00 = static_cast<uint16_t>(j * (gridSize + 1) + i), v01 = v00 + 1;
+                uint16_t v10 = static_cast<uint16_t>(v00 + gridSize + 1), v11 = v10 + 1;
+                gridIndices.insert(gridIndices.end(), { v00, v01, v11, v11, v10, v00 });
+            }
+        }
+        gridIndexCount = static_cast<GLsizei>(gridIndices.size());
+
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &EBO);
+        glGenBuffers(1, &instanceVBO);
+
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, gridIndices.size() * sizeof(uint16_t), gridIndices.data(), GL_STATIC_DRAW);
+
+        // 实例属性：(起始列, 起始行, 边长, LOD 级别) 与 (瓦片起点 x, y, 瓦片采样 / 第0级采样, 纹理层)
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_STREAM_DRAW);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)offsetof(Instance, node));
+        glVertexAttribDivisor(1, 1);
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)offsetof(Instance, tile));
+        glVertexAttribDivisor(2, 1);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        // 高度瓦片纹理数组（16 位归一化）
+        const int samples = store->tileSamples();
+        glGenTextures(1, &tileTexture);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, tileTexture);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R16, samples, samples, tileBudget, 0, GL_RED, GL_UNSIGNED_SHORT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+        // 法线瓦片纹理数组（(nx, nz) 两个有符号 8 位分量），层号与高度瓦片相同
+        glGenTextures(1, &normalTexture);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, normalTexture);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RG8_SNORM, samples, samples, tileBudget, 0, GL_RG, GL_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+        slots.assign(tileBudget, Slot());
+        residentSlots.clear();
+        const int topLevel = store->levelCount() - 1;
+        const uint64_t topKey = TileStreamer::makeKey(topLevel, 0, 0);
+        std::vector<int8_t> topNormals(static_cast<size_t>(samples) * samples * 2);
+        float kRow, kCol;
+        normalFactors(width, height, topLevel, store->vertical().scale, HORIZONTAL_SCALE, kRow, kCol);
+        computeTileNormals(*store, topLevel, 0, 0, kRow, kCol, topNormals.data());
+        uploadTile(0, topKey, store->tile(topLevel, 0, 0), topNormals.data());
+        slots[0].pinned = true;
+
+        streamer.reset(new TileStreamer(*store, HORIZONTAL_SCALE));
+    }
+
+    // 按相机位置与视锥选择节点；localToWorld 为 model * localTransform(...)，返回选中的节点数。
+    // minHeight 为局部归一化高度，最大高度低于它的节点不会被绘制；
+    // horizon 开启地平线剔除，要求 localToWorld 不翻转 y 轴
+    size_t select(const glm::mat4& localToWorld, const glm::vec3& cameraPos, const glm::mat4& viewProj,
+                  float minHeight = -std::numeric_limits<float>::max(), bool horizon = false) {
+        selection.clear();
+        selectionBounds.clear();
+        stats = CullStats();
+        if (levels.empty()) return 0;
+        uploadLoadedTiles();
+        ++frame;
+        toWorld = localToWorld;
+        camera = cameraPos;
+        frustum = Frustum::fromMatrix(viewProj);
+        clipHeight = minHeight;
+
+        // 各级 LOD 范围与形变区间（世界空间距离）
+        float leafExtent = std::max(glm::length(glm::vec3(localToWorld * glm::vec4(static_cast<float>(gridSize) / height, 0.0f, 0.0f, 0.0f))),
+                                    glm::length(glm::vec3(localToWorld * glm::vec4(0.0f, 0.0f, static_cast<float>(gridSize) / width, 0.0f))));
+        float previous = 0.0f;
+        for (int l = 0; l < levelCount; ++l) {
+            lodRanges[l] = leafExtent * lodRangeScale * static_cast<float>(1 << l);
+            lodMorph[l] = glm::vec2(previous + (lodRanges[l] - previous) * morphStartRatio, lodRanges[l]);
+            previous = lodRanges[l];
+        }
+
+        const Level& top = levels[levelCount - 1];
+        for (int ny = 0; ny < top.countY; ++ny) {
+            for (int nx = 0; nx < top.countX; ++nx) {
+                selectNode(levelCount - 1, nx, ny);
+            }
+        }
+        if (horizon) {
+            horizonCull();
+        }
+        assignTiles();
+        stats.patchesDrawn = selection.size();
+        return selection.size();
+    }
+
+    size_t selectedCount() const { return selection.size(); }
+
+    const CullStats& cullStats() const { return stats; }
+
+    // 绘制上一次 select 的结果（调用前须已 use 着色器并设置好变换矩阵）
+    void draw(Shader& shader) {
+        if (selection.empty()) return;
+        shader.setInt("heightTiles", HEIGHT_MAP_UNIT);
+        shader.setInt("normalTiles", NORMAL_MAP_UNIT);
+        shader.setFloat("tileSamples", static_cast<float>(store->tileSamples()));
+        shader.setVec2("heightMapSize", glm::vec2(static_cast<float>(width), static_cast<float>(height)));
+        shader.setFloat("gridSize", static_cast<float>(gridSize));
+        shader.setVec3("cameraPos", camera);
+        shader.setVec2Array("lodMorph", lodMorph, levelCount);
+
+        glActiveTexture(GL_TEXTURE0 + HEIGHT_MAP_UNIT);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, tileTexture);
+        glActiveTexture(GL_TEXTURE0 + NORMAL_MAP_UNIT);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, normalTexture);
+
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        glBufferData(GL_ARRAY_BUFFER, selection.size() * sizeof(Instance), selection.data(), GL_STREAM_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        glBindVertexArray(VAO);
+        glDrawElementsInstanced(GL_TRIANGLES, gridIndexCount, GL_UNSIGNED_SHORT, 0, static_cast<GLsizei>(selection.size()));
+        glBindVertexArray(0);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    // 节点的局部包围盒
+    AABB nodeBounds(int level, int nx, int ny) const {
+        const Level& lv = levels[level];
+        const glm::vec2& mm = lv.minMax[static_cast<size_t>(ny) * lv.countX + nx];
+        int r0 = ny * lv.nodeSize, c0 = nx * lv.nodeSize;
+        int r1 = std::min(r0 + lv.nodeSize, height - 1), c1 = std::min(c0 + lv.nodeSize, width - 1);
+        return { glm::vec3(static_cast<float>(r0) / height, mm.x, static_cast<float>(c0) / width),
+                 glm::vec3(static_cast<float>(r1) / height, mm.y, static_cast<float>(c1) / width) };
+    }
+
+private:
+    struct Instance {
+        glm::vec4 node; // (起始列, 起始行, 边长, LOD 级别)，第0级采样坐标
+        glm::vec4 tile; // (瓦片起点 x, y, 瓦片采样 / 第0级采样, 纹理层)
+    };
+
+    // 纹理数组的一层
+    struct Slot {
+        uint64_t key = 0;
+        uint64_t lastUsed = 0;
+        bool occupied = false;
+        bool pinned = false;
+    };
+
+    struct Level {
+        int nodeSize = 0;  // 节点边长（采样间隔数）
+        int countX = 0;    // 列方向节点数
+        int countY = 0;    // 行方向节点数
+        std::vector<glm::vec2> minMax; // 每个节点的 (最小高度, 最大高度)
+    };
+
+    const TileStore* store = nullptr;
+    int width = 0, height = 0;
+    int levelCount = 0;
+    std::vector<Level> levels;
+
+    // 地平线遮挡格
+    int occluderCell = 0;   // 每格边长（采样间隔数）
+    int occluderCountX = 0, occluderCountY = 0;
+    std::vector<float> occluderMin;
+
+    // 每帧选择状态
+    glm::mat4 toWorld = glm::mat4(1.0f);
+    glm::vec3 camera = glm::vec3(0.0f);
+    Frustum frustum;
+    float lodRanges[MAX_LOD_LEVELS] = {};
+    glm::vec2 lodMorph[MAX_LOD_LEVELS];
+    float clipHeight = 0.0f;
+    std::vector<Instance> selection;
+    std::vector<AABB> selectionBounds; // 与 selection 一一对应的世界空间包围盒
+    CullStats stats;
+    HorizonBuffer horizonBuffer;
+
+    // 瓦片驻留
+    std::vector<Slot> slots;
+    std::unordered_map<uint64_t, int> residentSlots;
+    std::unique_ptr<TileStreamer> streamer;
+    std::vector<TileStreamer::LoadedTile> loadedTiles;
+    uint64_t frame = 0;
+
+    // OpenGL相关
+    unsigned int VAO = 0, EBO = 0, instanceVBO = 0;
+    unsigned int tileTexture = 0;
+    unsigned int normalTexture = 0;
+    GLsizei gridIndexCount = 0;
+
+    void addNode(int level, int nx, int ny, int drawLevel, const AABB& worldBox) {
+        int size = levels[level].nodeSize;
+        Instance instance;
+        instance.node = glm::vec4(static_cast<float>(nx * size), static_cast<float>(ny * size), static_cast<float>(size),
+                                  static_cast<float>(drawLevel));
+        selection.push_back(instance);
+        selectionBounds.push_back(worldBox);
+    }
+
+    static std::vector<glm::vec2> combine(const std::vector<glm::vec2>& child, int childX, int childY) {
+        const int countX = (childX + 1) / 2, countY = (childY + 1) / 2;
+        std::vector<glm::vec2> result(static_cast<size_t>(countX) * countY);
+        parallelFor(0, static_cast<size_t>(countY), [&](size_t ny) {
+            for (int nx = 0; nx < countX; ++nx) {
+                glm::vec2 mm(std::numeric_limits<float>::max(), -std::numeric_limits<float>::max());
+                for (int cy = 2 * static_cast<int>(ny); cy < std::min(2 * static_cast<int>(ny) + 2, childY); ++cy) {
+                    for (int cx = 2 * nx; cx < std::min(2 * nx + 2, childX); ++cx) {
+                        const glm::vec2& c = child[static_cast<size_t>(cy) * childX + cx];
+                        mm.x = std::min(mm.x, c.x);
+                        mm.y = std::max(mm.y, c.y);
+                    }
+                }
+                result[ny * countX + nx] = mm;
+            }
+        }, 64);
+        return result;
+    }
+
+    void uploadTile(int slot, uint64_t key, const uint16_t* samples, const int8_t* normals) {
+        const int size = store->tileSamples();
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, tileTexture);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, slot, size, size, 1, GL_RED, GL_UNSIGNED_SHORT, samples);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, normalTexture);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, slot, size, size, 1, GL_RG, GL_BYTE, normals);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+        if (slots[slot].occupied) residentSlots.erase(slots[slot].key);
+        slots[slot].key = key;
+        slots[slot].occupied = true;
+        slots[slot].lastUsed = frame;
+        residentSlots[key] = slot;
+    }
+
+    // 上传后台线程读好的瓦片：优先用空层，否则淘汰最久未用的层；所有层本帧都在用时丢弃，之后会重新请求
+    void uploadLoadedTiles() {
+        streamer->takeLoaded(loadedTiles);
+        for (const TileStreamer::LoadedTile& tile : loadedTiles) {
+            if (residentSlots.count(tile.key)) continue;
+            int victim = -1;
+            for (int i = 0; i < static_cast<int>(slots.size()); ++i) {
+                if (slots[i].pinned) continue;
+                if (!slots[i].occupied) {
+                    victim = i;
+                    break;
+                }
+                if (victim < 0 || slots[i].lastUsed < slots[victim].lastUsed) victim = i;
+            }
+            if (victim < 0 || (slots[victim].occupied && slots[victim].lastUsed >= frame)) continue;
+            uploadTile(victim, tile.key, tile.samples.data(), tile.normals.data());
+        }
+        loadedTiles.clear();
+    }
+
+    // 为每个选中节点找到驻留的瓦片（缺失时退到更粗一级），并按距离由近到远请求缺失的瓦片
+    void assignTiles() {
+        const int T = store->tileSize();
+        const int topLevel = store->levelCount() - 1;
+        std::vector<std::pair<float, uint64_t>> missing;
+        std::unordered_set<uint64_t> requested;
+        for (size_t i = 0; i < selection.size(); ++i) {
+            Instance& instance = selection[i];
+            const int wanted = std::min(static_cast<int>(instance.node.w), topLevel);
+            const uint64_t col = static_cast<uint64_t>(instance.node.x), row = static_cast<uint64_t>(instance.node.y);
+            for (int p = wanted; p <= topLevel; ++p) {
+                const TileStore::LevelInfo& info = store->level(p);
+                const int tx = static_cast<int>(std::min<uint64_t>((col >> p) / T, info.tilesX - 1));
+                const int ty = static_cast<int>(std::min<uint64_t>((row >> p) / T, info.tilesY - 1));
+                const uint64_t key = TileStreamer::makeKey(p, tx, ty);
+                auto it = residentSlots.find(key);
+                if (it == residentSlots.end()) {
+                    if (p == wanted && requested.insert(key).second) {
+                        missing.emplace_back(selectionBounds[i].distanceSquared(camera), key);
+                    }
+                    continue;
+                }
+                slots[it->second].lastUsed = frame;
+                instance.tile = glm::vec4(static_cast<float>(tx * T), static_cast<float>(ty * T), 1.0f / static_cast<float>(1u << p),
+                                          static_cast<float>(it->second));
+                if (p != wanted) ++stats.tileFallbacks;
+                break;
+            }
+        }
+
+        std::sort(missing.begin(), missing.end());
+        std::vector<uint64_t> keys;
+        keys.reserve(missing.size());
+        for (const auto& item : missing) {
+            keys.push_back(item.second);
+        }
+        streamer->request(keys);
+        stats.tilesRequested = keys.size();
+    }
+
+    bool inRange(const AABB& worldBox, int level) const {
+        return worldBox.distanceSquared(camera) <= lodRanges[level] * lodRanges[level];
+    }
+
+    // 返回 false 表示节点超出本级范围，由父节点以父级精度绘制
+    bool selectNode(int level, int nx, int ny) {
+        ++stats.nodesTested;
+        const Level& lv = levels[level];
+        if (lv.minMax[static_cast<size_t>(ny) * lv.countX + nx].y < clipHeight) { // 整体被裁掉，视为已处理
+            ++stats.heightCulled;
+            return true;
+        }
+        AABB worldBox = nodeBounds(level, nx, ny).transformed(toWorld);
+        if (!frustum.intersects(worldBox)) { // 不可见，视为已处理
+            ++stats.frustumCulled;
+            return true;
+        }
+        if (level < levelCount - 1 && !inRange(worldBox, level)) return false;
+        if (level == 0 || !inRange(worldBox, level - 1)) {
+            addNode(level, nx, ny, level, worldBox);
+            return true;
+        }
+
+        const Level& child = levels[level - 1];
+        for (int cy = 2 * ny; cy < std::min(2 * ny + 2, child.countY); ++cy) {
+            for (int cx = 2 * nx; cx < std::min(2 * nx + 2, child.countX); ++cx) {
+                if (!selectNode(level - 1, cx, cy)) {
+                    // 子节点整体超出子级范围：子级顶点全部形变到本级网格，几何与本级一致
+                    addNode(level - 1, cx, cy, level - 1, nodeBounds(level - 1, cx, cy).transformed(toWorld));
+                }
+            }
+        }
+        return true;
+    }
+
+    // 地平线遮挡格：每格取自身及周围一圈格子内的最低高度。远处节点绘制时会形变到更粗的网格，
+    // 曲面可能低于本格的最低采样，多取一圈留出余量
+    void buildOccluders(const std::vector<glm::vec2>& cells, int countX, int countY, int cellSize) {
+        occluderCell = cellSize;
+        occluderCountX = countX;
+        occluderCountY = countY;
+        occluderMin.resize(cells.size());
+        for (int cy = 0; cy < countY; ++cy) {
+            for (int cx = 0; cx < countX; ++cx) {
+                float m = cells[static_cast<size_t>(cy) * countX + cx].x;
+                for (int y = std::max(cy - 1, 0); y <= std::min(cy + 1, countY - 1); ++y) {
+                    for (int x = std::max(cx - 1, 0); x <= std::min(cx + 1, countX - 1); ++x) {
+                        m = std::min(m, cells[static_cast<size_t>(y) * countX + x].x);
+                    }
+                }
+                occluderMin[static_cast<size_t>(cy) * countX + cx] = m;
+            }
+        }
+    }
+
+    // 地平线剔除：遮挡格按最远距离由近到远加入地平线，被测节点按最近距离由近到远测试，
+    // 保证只有严格更近的遮挡物参与判断。低于裁剪高度的部分不会被绘制，这样的格子不作为遮挡物
+    void horizonCull() {
+        horizonBuffer.reset(camera);
+
+        std::vector<std::pair<float, AABB>> occluders;
+        occluders.reserve(occluderMin.size());
+        for (int cy = 0; cy < occluderCountY; ++cy) {
+            for (int cx = 0; cx < occluderCountX; ++cx) {
+                float m = occluderMin[static_cast<size_t>(cy) * occluderCountX + cx];
+                if (m < clipHeight) continue;
+                int r0 = cy * occluderCell, c0 = cx * occluderCell;
+                int r1 = std::min(r0 + occluderCell, height - 1), c1 = std::min(c0 + occluderCell, width - 1);
+                AABB box = AABB{ glm::vec3(static_cast<float>(r0) / height, m, static_cast<float>(c0) / width),
+                                 glm::vec3(static_cast<float>(r1) / height, m, static_cast<float>(c1) / width) }.transformed(toWorld);
+                float dMin, dMax;
+                horizonBuffer.horizontalRange(box, dMin, dMax);
+                occluders.emplace_back(dMax, box);
+            }
+        }
+        std::sort(occluders.begin(), occluders.end(),
+                  [](const std::pair<float, AABB>& a, const std::pair<float, AABB>& b) { return a.first < b.first; });
+
+        std::vector<std::pair<float, size_t>> order(selection.size());
+        for (size_t i = 0; i < selection.size(); ++i) {
+            float dMin, dMax;
+            horizonBuffer.horizontalRange(selectionBounds[i], dMin, dMax);
+            order[i] = { dMin, i };
+        }
+        std::sort(order.begin(), order.end());
+
+        std::vector<char> hidden(selection.size(), 0);
+        size_t next = 0;
+        for (const auto& item : order) {
+            while (next < occluders.size() && occluders[next].first < item.first) {
+                horizonBuffer.addOccluder(occluders[next++].second);
+            }
+            hidden[item.second] = horizonBuffer.occluded(selectionBounds[item.second]);
+        }
+
+        size_t kept = 0;
+        for (size_t i = 0; i < selection.size(); ++i) {
+            if (hidden[i]) continue;
+            selection[kept] = selection[i];
+            selectionBounds[kept] = selectionBounds[i];
+            ++kept;
+        }
+        stats.horizonCulled = selection.size() - kept;
+        selection.resize(kept);
+        selectionBounds.resize(kept);
+    }
+};
+
+#endif // CDLOD_TERRAIN_H
@@ -0,0 +1,72 @@
+/*
+ * Frustum.h
+ *
+ * 轴对齐包围盒与视锥体：
+ * - AABB::transformed 把局部包围盒经仿射矩阵变换为世界空间包围盒（支持缩放、镜像）
+ * - Frustum::fromMatrix 由 projection * view 提取6个世界空间裁剪平面（Gribb-Hartmann）
+ * - Frustum::intersects 用包围盒离平面最远的顶点判断是否完全在某个平面之外
+ *
+ * 撰写者：Zhiyuan Feng
+ */
+
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <cmath>
+#include "glm/glm.hpp"
+
+struct AABB {
+    glm::vec3 min;
+    glm::vec3 max;
+
+    glm::vec3 center() const { return 0.5f * (min + max); }
+    glm::vec3 extents() const { return 0.5f * (max - min); }
+
+    // 点到包围盒的距离平方（点在盒内时为0）
+    float distanceSquared(const glm::vec3& p) const {
+        glm::vec3 d = glm::max(glm::max(min - p, p - max), glm::vec3(0.0f));
+        return glm::dot(d, d);
+    }
+
+    // 仿射变换后的包围盒
+    AABB transformed(const glm::mat4& m) const {
+        glm::vec3 c = glm::vec3(m * glm::vec4(center(), 1.0f));
+        glm::vec3 e = extents();
+        glm::vec3 r(0.0f);
+        for (int i = 0; i < 3; ++i) {
+            r[i] = std::abs(m[0][i]) * e.x + std::abs(m[1][i]) * e.y + std::abs(m[2][i]) * e.z;
+        }
+        return { c - r, c + r };
+    }
+};
+
+struct Frustum {
+    glm::vec4 planes[6]; // (n, d)，n·p + d >= 0 为内侧
+
+    static Frustum fromMatrix(const glm::mat4& viewProj) {
+        Frustum f;
+        glm::mat4 m = glm::transpose(viewProj); // m[i] 为 viewProj 的第 i 行
+        f.planes[0] = m[3] + m[0]; // 左
+        f.planes[1] = m[3] - m[0]; // 右
+        f.planes[2] = m[3] + m[1]; // 下
+        f.planes[3] = m[3] - m[1]; // 上
+        f.planes[4] = m[3] + m[2]; // 近
+        f.planes[5] = m[3] - m[2]; // 远
+        for (glm::vec4& p : f.planes) {
+            p /= glm::length(glm::vec3(p));
+        }
+        return f;
+    }
+
+    bool intersects(const AABB& box) const {
+        for (const glm::vec4& p : planes) {
+            glm::vec3 farthest(p.x >= 0.0f ? box.max.x : box.min.x,
+                               p.y >= 0.0f ? box.max.y : box.min.y,
+                               p.z >= 0.0f ? box.max.z : box.min.z);
+            if (glm::dot(glm::vec3(p), farthest) + p.w < 0.0f) return false;
+        }
+        return true;
+    }
+};
+
+#endif // FRUSTUM_H
@@ -0,0 +1,186 @@
+/*
+ * HeightConvert.h
+ *
+ * 高度数据的逐行转换核（SSE2 每次处理 8 个采样，无 SSE2 时退回标量）：
+ * - convertRowU8 / convertRowU16 / convertRowF32：源采样 -> 归一化高度 clamp(v * scale + bias, 0, 1)，
+ *   可选字节序交换（大端 DEM）与无效值（nodata，以及 float 的 NaN）替换为 0
+ * - encodeRowU16：归一化高度 -> 瓦片使用的 uint16（四舍五入）
+ * - rangeRowF32：统计一行的最小/最大值（跳过无效值），用于没有给出高度范围的浮点数据
+ *
+ * 源数据可以直接是内存映射的文件，所有读取都按非对齐处理。
+ *
+ * 撰写者：Zhiyuan Feng
+ */
+
+#ifndef HEIGHT_CONVERT_H
+#define HEIGHT_CONVERT_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HEIGHT_CONVERT_SSE2 1
+#endif
+
+namespace height_detail {
+
+inline uint16_t swap16(uint16_t v) { return static_cast<uint16_t>((v << 8) | (v >> 8)); }
+
+inline float swapF32(float v) {
+    uint32_t u;
+    std::memcpy(&u, &v, 4);
+    u = (u >> 24) | ((u >> 8) & 0xFF00u) | ((u << 8) & 0xFF0000u) | (u << 24);
+    std::memcpy(&v, &u, 4);
+    return v;
+}
+
+inline float normalize(float v, float scale, float bias) { return std::min(std::max(v * scale + bias, 0.0f), 1.0f); }
+
+#ifdef HEIGHT_CONVERT_SSE2
+inline __m128i swap16x8(__m128i v) { return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)); }
+
+// 每个 32 位元素内字节逆序：先交换 16 位内的两个字节，再交换两个 16 位半字
+inline __m128i swap32x4(__m128i v) {
+    v = swap16x8(v);
+    v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+inline __m128 normalize4(__m128 v, __m128 scale, __m128 bias) {
+    v = _mm_add_ps(_mm_mul_ps(v, scale), bias);
+    return _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+}
+#endif
+
+} // namespace height_detail
+
+inline void convertRowU8(const unsigned char* src, size_t n, float scale, float bias, float* out) {
+    size_t i = 0;
+#ifdef HEIGHT_CONVERT_SSE2
+    const __m128 s = _mm_set1_ps(scale), b = _mm_set1_ps(bias);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= n; i += 8) {
+        __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i));
+        __m128i words = _mm_unpacklo_epi8(bytes, zero);
+        _mm_storeu_ps(out + i, height_detail::normalize4(_mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero)), s, b));
+        _mm_storeu_ps(out + i + 4, height_detail::normalize4(_mm_cvtepi32_ps(_mm_unpackhi_epi16(words, zero)), s, b));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = height_detail::normalize(static_cast<float>(src[i]), scale, bias);
+    }
+}
+
+// hasNoData 时等于 noData 的采样输出 0
+inline void convertRowU16(const void* srcBytes, size_t n, bool swapBytes, float scale, float bias, float* out,
+                          bool hasNoData = false, uint16_t noData = 0) {
+    const unsigned char* src = static_cast<const unsigned char*>(srcBytes);
+    size_t i = 0;
+#ifdef HEIGHT_CONVERT_SSE2
+    const __m128 s = _mm_set1_ps(scale), b = _mm_set1_ps(bias);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i nd = _mm_set1_epi16(static_cast<short>(noData));
+    for (; i + 8 <= n; i += 8) {
+        __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i));
+        if (swapBytes) words = height_detail::swap16x8(words);
+        __m128i valid = hasNoData ? _mm_xor_si128(_mm_cmpeq_epi16(words, nd), _mm_set1_epi16(-1)) : _mm_set1_epi16(-1);
+        __m128 lo = height_detail::normalize4(_mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero)), s, b);
+        __m128 hi = height_detail::normalize4(_mm_cvtepi32_ps(_mm_unpackhi_epi16(words, zero)), s, b);
+        lo = _mm_and_ps(lo, _mm_castsi128_ps(_mm_unpacklo_epi16(valid, valid)));
+        hi = _mm_and_ps(hi, _mm_castsi128_ps(_mm_unpackhi_epi16(valid, valid)));
+        _mm_storeu_ps(out + i, lo);
+        _mm_storeu_ps(out + i + 4, hi);
+    }
+#endif
+    for (; i < n; ++i) {
+        uint16_t v;
+        std::memcpy(&v, src + 2 * i, 2);
+        if (swapBytes) v = height_detail::swap16(v);
+        out[i] = (hasNoData && v == noData) ? 0.0f : height_detail::normalize(static_cast<float>(v), scale, bias);
+    }
+}
+
+// NaN 以及 hasNoData 时等于 noData 的采样输出 0
+inline void convertRowF32(const void* srcBytes, size_t n, bool swapBytes, float scale, float bias, float* out,
+                          bool hasNoData = false, float noData = 0.0f) {
+    const unsigned char* src = static_cast<const unsigned char*>(srcBytes);
+    size_t i = 0;
+#ifdef HEIGHT_CONVERT_SSE2
+    const __m128 s = _mm_set1_ps(scale), b = _mm_set1_ps(bias);
+    const __m128 nd = _mm_set1_ps(noData);
+    for (; i + 4 <= n; i += 4) {
+        __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * i));
+        if (swapBytes) raw = height_detail::swap32x4(raw);
+        __m128 v = _mm_castsi128_ps(raw);
+        __m128 valid = _mm_cmpord_ps(v, v);
+        if (hasNoData) valid = _mm_andnot_ps(_mm_cmpeq_ps(v, nd), valid);
+        _mm_storeu_ps(out + i, _mm_and_ps(height_detail::normalize4(v, s, b), valid));
+    }
+#endif
+    for (; i < n; ++i) {
+        float v;
+        std::memcpy(&v, src + 4 * i, 4);
+        if (swapBytes) v = height_detail::swapF32(v);
+        out[i] = (std::isnan(v) || (hasNoData && v == noData)) ? 0.0f : height_detail::normalize(v, scale, bias);
+    }
+}
+
+inline void encodeRowU16(const float* src, size_t n, uint16_t* out) {
+    size_t i = 0;
+#ifdef HEIGHT_CONVERT_SSE2
+    // SSE2 没有无符号饱和打包：先减 32768 做有符号打包，再翻转最高位
+    const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), full = _mm_set1_ps(65535.0f), half = _mm_set1_ps(0.5f);
+    const __m128i bias = _mm_set1_epi32(32768), flip = _mm_set1_epi16(static_cast<short>(0x8000));
+    for (; i + 8 <= n; i += 8) {
+        __m128 a = _mm_add_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), zero), one), full), half);
+        __m128 b = _mm_add_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + 4), zero), one), full), half);
+        __m128i ia = _mm_sub_epi32(_mm_cvttps_epi32(a), bias);
+        __m128i ib = _mm_sub_epi32(_mm_cvttps_epi32(b), bias);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_xor_si128(_mm_packs_epi32(ia, ib), flip));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = static_cast<uint16_t>(std::min(std::max(src[i], 0.0f), 1.0f) * 65535.0f + 0.5f);
+    }
+}
+
+// 在 [minValue, maxValue] 上累积一行的范围（跳过 NaN 与无效值）
+inline void rangeRowF32(const void* srcBytes, size_t n, bool swapBytes, bool hasNoData, float noData,
+                        float& minValue, float& maxValue) {
+    const unsigned char* src = static_cast<const unsigned char*>(srcBytes);
+    size_t i = 0;
+#ifdef HEIGHT_CONVERT_SSE2
+    __m128 lo = _mm_set1_ps(minValue), hi = _mm_set1_ps(maxValue);
+    const __m128 nd = _mm_set1_ps(noData);
+    for (; i + 4 <= n; i += 4) {
+        __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * i));
+        if (swapBytes) raw = height_detail::swap32x4(raw);
+        __m128 v = _mm_castsi128_ps(raw);
+        __m128 valid = _mm_cmpord_ps(v, v);
+        if (hasNoData) valid = _mm_andnot_ps(_mm_cmpeq_ps(v, nd), valid);
+        // 无效值用当前的 lo / hi 代替，不影响结果
+        lo = _mm_min_ps(lo, _mm_or_ps(_mm_and_ps(valid, v), _mm_andnot_ps(valid, lo)));
+        hi = _mm_max_ps(hi, _mm_or_ps(_mm_and_ps(valid, v), _mm_andnot_ps(valid, hi)));
+    }
+    alignas(16) float l[4], h[4];
+    _mm_store_ps(l, lo);
+    _mm_store_ps(h, hi);
+    for (int k = 0; k < 4; ++k) {
+        minValue = std::min(minValue, l[k]);
+        maxValue = std::max(maxValue, h[k]);
+    }
+#endif
+    for (; i < n; ++i) {
+        float v;
+        std::memcpy(&v, src + 4 * i, 4);
+        if (swapBytes) v = height_detail::swapF32(v);
+        if (std::isnan(v) || (hasNoData && v == noData)) continue;
+        minValue = std::min(minValue, v);
+        maxValue = std::max(maxValue, v);
+    }
+}
+
+#endif // HEIGHT_CONVERT_H
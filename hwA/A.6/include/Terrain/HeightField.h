@@ -0,0 +1,49 @@
+/*
+ * HeightField.h
+ *
+ * 规则网格上的高度场：width x height 个采样点，按行存储归一化高度（0 ~ 1）。
+ * 采样点 (row, col) 对应地形局部坐标 (row / height, h, col / width)，与原 land.obj 的约定一致。
+ * 绘制时的竖直坐标为 h * vertical.scale + vertical.offset，随数据集配置（见 HeightmapSource）。
+ *
+ * 撰写者：Zhiyuan Feng
+ */
+
+#ifndef HEIGHT_FIELD_H
+#define HEIGHT_FIELD_H
+
+#include <cstddef>
+#include <vector>
+#include "Parallel/ParallelFor.h"
+#include "Terrain/HeightConvert.h"
+
+// 归一化高度到地形局部竖直坐标的映射：y = h * scale + offset
+struct VerticalScale {
+    float scale = 0.05f;
+    float offset = -0.48f;
+};
+
+struct HeightField {
+    int width = 0;
+    int height = 0;
+    std::vector<float> heights; // heights[row * width + col]
+    VerticalScale vertical;
+
+    bool empty() const { return width <= 0 || height <= 0; }
+
+    float at(int row, int col) const { return heights[static_cast<size_t>(row) * width + col]; }
+
+    // 由单通道 8 位像素构建（255 对应高度 1）
+    static HeightField fromPixels(const unsigned char* pixels, int width, int height) {
+        HeightField field;
+        field.width = width;
+        field.height = height;
+        field.heights.resize(static_cast<size_t>(width) * height);
+        parallelFor(0, static_cast<size_t>(height), [&](size_t row) {
+            convertRowU8(pixels + row * width, static_cast<size_t>(width), 1.0f / 255.0f, 0.0f,
+                         field.heights.data() + row * width);
+        }, 16);
+        return field;
+    }
+};
+
+#endif // HEIGHT_FIELD_H
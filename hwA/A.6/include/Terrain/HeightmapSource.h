@@ -0,0 +1,273 @@
+/*
+ * HeightmapSource.h
+ *
+ * 高度图数据源：把 8 位 / 16 位 / 32 位浮点的源采样按行转换成归一化高度（0 ~ 1）。
+ *
+ * - 原始 DEM（.raw / .r16 / .u16 为 uint16，.r32 / .f32 为 float）直接内存映射，逐行转换，
+ *   不需要整张读入内存；缺少尺寸时按正方形从文件大小推断
+ * - 图片由调用方解码后用 attachImage 接入（8 位或 16 位单通道）
+ * - 同名的 <文件>.meta 给出数据集配置，每行 "键 值"，# 之后为注释：
+ *     format   u8 / u16 / f32          width / height   采样点数
+ *     endian   little / big            headerBytes      文件头长度（跳过）
+ *     min/max  映射到高度 0 / 1 的源值（缺省时 8/16 位取满量程，float 扫描全图）
+ *     nodata   无效值（输出高度 0）      scale / offset   竖直缩放与偏移（见 VerticalScale）
+ *
+ * readRow 可被多个线程同时调用。
+ *
+ * 撰写者：Zhiyuan Feng
+ */
+
+#ifndef HEIGHTMAP_SOURCE_H
+#define HEIGHTMAP_SOURCE_H
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Mesh/ObjReader.h"
+#include "Parallel/ParallelFor.h"
+#include "Terrain/HeightConvert.h"
+#include "Terrain/HeightField.h"
+#include "Terrain/TileStore.h"
+
+struct HeightmapMeta {
+    enum Format { U8, U16, F32 };
+
+    Format format = U8;
+    int width = 0;
+    int height = 0;
+    bool bigEndian = false;
+    size_t headerBytes = 0;
+    bool hasRange = false;
+    float minValue = 0.0f;
+    float maxValue = 0.0f;
+    bool hasNoData = false;
+    float noData = 0.0f;
+    VerticalScale vertical;
+
+    size_t sampleBytes() const { return format == U8 ? 1 : (format == U16 ? 2 : 4); }
+
+    // 读取 path 对应的 .meta，没有该文件时保持缺省值
+    bool load(const std::string& path) {
+        std::ifstream in(path + ".meta");
+        if (!in.is_open()) return true;
+        std::string line;
+        int lineNo = 0;
+        while (std::getline(in, line)) {
+            ++lineNo;
+            line = line.substr(0, line.find('#'));
+            std::istringstream fields(line);
+            std::string key, value;
+            if (!(fields >> key)) continue;
+            if (!(fields >> value) || !apply(key, value)) {
+                std::cerr << "Error: " << path << ".meta:" << lineNo << ": invalid entry \"" << line << "\"" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    bool apply(const std::string& key, const std::string& value) {
+        try {
+            if (key == "format") {
+                if (value == "u8") format = U8;
+                else if (value == "u16") format = U16;
+                else if (value == "f32") format = F32;
+                else return false;
+            } else if (key == "endian") {
+                if (value != "little" && value != "big") return false;
+                bigEndian = value == "big";
+            } else if (key == "width") {
+                width = std::stoi(value);
+            } else if (key == "height") {
+                height = std::stoi(value);
+            } else if (key == "headerBytes") {
+                headerBytes = static_cast<size_t>(std::stoull(value));
+            } else if (key == "min") {
+                minValue = std::stof(value);
+                hasRange = true;
+            } else if (key == "max") {
+                maxValue = std::stof(value);
+                hasRange = true;
+            } else if (key == "nodata") {
+                noData = std::stof(value);
+                hasNoData = true;
+            } else if (key == "scale") {
+                vertical.scale = std::stof(value);
+            } else if (key == "offset") {
+                vertical.offset = std::stof(value);
+            } else {
+                return false;
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+        return true;
+    }
+};
+
+class HeightmapSource {
+public:
+    // 按扩展名判断是否为原始 DEM
+    static bool isRawPath(const std::string& path) {
+        return rawFormat(path, nullptr);
+    }
+
+    // 内存映射原始 DEM
+    bool openRaw(const std::string& path) {
+        HeightmapMeta meta;
+        rawFormat(path, &meta.format);
+        if (!meta.load(path)) return false;
+        file.reset(new MappedFile(path));
+        if (!file->isOpen() || file->length() <= meta.headerBytes) {
+            std::cerr << "Error: Failed to open heightmap " << path << std::endl;
+            file.reset();
+            return false;
+        }
+        const size_t samples = (file->length() - meta.headerBytes) / meta.sampleBytes();
+        if (meta.width <= 0 && meta.height <= 0) {
+            meta.width = meta.height = static_cast<int>(std::lround(std::sqrt(static_cast<double>(samples))));
+        } else if (meta.width <= 0 || meta.height <= 0) {
+            const int known = std::max(meta.width, meta.height);
+            (meta.width <= 0 ? meta.width : meta.height) = static_cast<int>(samples / known);
+        }
+        if (meta.width < 2 || meta.height < 2 ||
+            static_cast<size_t>(meta.width) * meta.height > samples) {
+            std::cerr << "Error: Heightmap " << path << " is smaller than " << meta.width << "x" << meta.height << std::endl;
+            file.reset();
+            return false;
+        }
+        return attach(reinterpret_cast<const unsigned char*>(file->begin()) + meta.headerBytes, meta);
+    }
+
+    // 接入已解码的图片（width x height 个单通道采样，调用方保证数据存活），.meta 仍可给出高度范围与竖直缩放
+    bool attachImage(const std::string& path, const void* pixels, int width, int height, bool is16Bit) {
+        HeightmapMeta meta;
+        if (!meta.load(path)) return false;
+        meta.format = is16Bit ? HeightmapMeta::U16 : HeightmapMeta::U8;
+        meta.width = width;
+        meta.height = height;
+        meta.bigEndian = false;
+        file.reset();
+        return attach(static_cast<const unsigned char*>(pixels), meta);
+    }
+
+    int width() const { return info.width; }
+    int height() const { return info.height; }
+    const HeightmapMeta& meta() const { return info; }
+
+    void readRow(int row, float* out) const {
+        const unsigned char* src = data + static_cast<size_t>(row) * info.width * info.sampleBytes();
+        const size_t n = static_cast<size_t>(info.width);
+        switch (info.format) {
+        case HeightmapMeta::U8:
+            convertRowU8(src, n, scale, bias, out);
+            if (info.hasNoData) {
+                for (size_t i = 0; i < n; ++i) {
+                    if (src[i] == static_cast<unsigned char>(info.noData)) out[i] = 0.0f;
+                }
+            }
+            break;
+        case HeightmapMeta::U16:
+            convertRowU16(src, n, swapBytes(), scale, bias, out, info.hasNoData, static_cast<uint16_t>(info.noData));
+            break;
+        case HeightmapMeta::F32:
+            convertRowF32(src, n, swapBytes(), scale, bias, out, info.hasNoData, info.noData);
+            break;
+        }
+    }
+
+    TileStore::RowReader rowReader() const {
+        return [this](int row, float* out) { readRow(row, out); };
+    }
+
+    // 整张转换为高度场（按行并行）
+    HeightField toField() const {
+        HeightField field;
+        field.width = info.width;
+        field.height = info.height;
+        field.vertical = info.vertical;
+        field.heights.resize(static_cast<size_t>(info.width) * info.height);
+        parallelFor(0, static_cast<size_t>(info.height), [&](size_t row) {
+            readRow(static_cast<int>(row), field.heights.data() + row * info.width);
+        }, 16);
+        return field;
+    }
+
+private:
+    std::unique_ptr<MappedFile> file;
+    const unsigned char* data = nullptr;
+    HeightmapMeta info;
+    float scale = 1.0f;
+    float bias = 0.0f;
+
+    static bool rawFormat(const std::string& path, HeightmapMeta::Format* format) {
+        const size_t dot = path.find_last_of('.');
+        if (dot == std::string::npos) return false;
+        std::string ext = path.substr(dot + 1);
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        HeightmapMeta::Format f;
+        if (ext == "raw" || ext == "r16" || ext == "u16") f = HeightmapMeta::U16;
+        else if (ext == "r32" || ext == "f32") f = HeightmapMeta::F32;
+        else return false;
+        if (format) *format = f;
+        return true;
+    }
+
+    static bool hostBigEndian() {
+        const uint16_t probe = 1;
+        unsigned char first;
+        std::memcpy(&first, &probe, 1);
+        return first == 0;
+    }
+
+    bool swapBytes() const { return info.bigEndian != hostBigEndian(); }
+
+    // 确定源值范围并算出 clamp(v * scale + bias, 0, 1) 的系数
+    bool attach(const unsigned char* samples, const HeightmapMeta& meta) {
+        data = samples;
+        info = meta;
+        if (!info.hasRange) {
+            info.minValue = 0.0f;
+            if (info.format == HeightmapMeta::U8) info.maxValue = 255.0f;
+            else if (info.format == HeightmapMeta::U16) info.maxValue = 65535.0f;
+            else scanRange();
+        }
+        if (!(info.maxValue > info.minValue)) {
+            std::cerr << "Error: Empty heightmap range [" << info.minValue << ", " << info.maxValue << "]" << std::endl;
+            return false;
+        }
+        scale = 1.0f / (info.maxValue - info.minValue);
+        bias = -info.minValue * scale;
+        return true;
+    }
+
+    // float 数据没有给出范围时扫描全图（按块并行，跳过 NaN 与无效值）
+    void scanRange() {
+        const size_t rowBytes = static_cast<size_t>(info.width) * info.sampleBytes();
+        const size_t threads = parallelThreadCount();
+        std::vector<float> lows(threads, std::numeric_limits<float>::max());
+        std::vector<float> highs(threads, -std::numeric_limits<float>::max());
+        const size_t rowsPerBlock = (static_cast<size_t>(info.height) + threads - 1) / threads;
+        parallelFor(0, threads, [&](size_t t) {
+            const size_t end = std::min(static_cast<size_t>(info.height), (t + 1) * rowsPerBlock);
+            for (size_t row = t * rowsPerBlock; row < end; ++row) {
+                rangeRowF32(data + row * rowBytes, static_cast<size_t>(info.width), swapBytes(), info.hasNoData, info.noData,
+                            lows[t], highs[t]);
+            }
+        }, 1);
+        info.minValue = *std::min_element(lows.begin(), lows.end());
+        info.maxValue = *std::max_element(highs.begin(), highs.end());
+    }
+};
+
+#endif // HEIGHTMAP_SOURCE_H
@@ -0,0 +1,106 @@
+/*
+ * HorizonCulling.h
+ *
+ * 以相机为中心的地平线缓冲：把水平方位角分成若干扇区，每个扇区记录近处地形挡住的最大仰角斜率
+ * （高度差 / 水平距离）。
+ *
+ * - addOccluder：包围盒最小高度以下视为实心地形。只有方位角范围完整覆盖某扇区时才更新该扇区，
+ *   因为这样该扇区内任何方向的视线都必然穿过此遮挡物
+ * - occluded：包围盒能达到的最大斜率在其覆盖的所有扇区中都低于地平线时，整个包围盒被挡住
+ *
+ * 遮挡物必须比被测包围盒更近（遮挡物的最大水平距离小于被测包围盒的最小水平距离），
+ * 调用方按距离排序后交替调用 addOccluder / occluded。世界空间 y 轴须朝上。
+ *
+ * 撰写者：Zhiyuan Feng
+ */
+
+#ifndef HORIZON_CULLING_H
+#define HORIZON_CULLING_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "glm/glm.hpp"
+#include "Terrain/Frustum.h"
+
+class HorizonBuffer {
+public:
+    explicit HorizonBuffer(int binCount = 1024) : bins(binCount) {}
+
+    void reset(const glm::vec3& eyePos) {
+        eye = eyePos;
+        slopes.assign(bins, -std::numeric_limits<float>::max());
+    }
+
+    // 包围盒在水平面上到相机的最小/最大距离
+    void horizontalRange(const AABB& box, float& dMin, float& dMax) const {
+        float nx = std::max(std::max(box.min.x - eye.x, eye.x - box.max.x), 0.0f);
+        float nz = std::max(std::max(box.min.z - eye.z, eye.z - box.max.z), 0.0f);
+        float fx = std::max(std::abs(box.min.x - eye.x), std::abs(box.max.x - eye.x));
+        float fz = std::max(std::abs(box.min.z - eye.z), std::abs(box.max.z - eye.z));
+        dMin = std::sqrt(nx * nx + nz * nz);
+        dMax = std::sqrt(fx * fx + fz * fz);
+    }
+
+    void addOccluder(const AABB& box) {
+        float dMin, dMax, a0, a1;
+        if (!project(box, dMin, dMax, a0, a1)) return;
+        // 遮挡物上高度至少为 min.y 的点距离在 [dMin, dMax] 内，取斜率的下界
+        float dy = box.min.y - eye.y;
+        float slope = dy >= 0.0f ? dy / dMax : dy / dMin;
+        int first = static_cast<int>(std::ceil(a0 / binWidth()));
+        int last = static_cast<int>(std::floor(a1 / binWidth())) - 1;
+        for (int b = first; b <= last; ++b) {
+            float& s = slopes[wrap(b)];
+            s = std::max(s, slope);
+        }
+    }
+
+    bool occluded(const AABB& box) const {
+        float dMin, dMax, a0, a1;
+        if (!project(box, dMin, dMax, a0, a1)) return false;
+        float dy = box.max.y - eye.y;
+        float slope = dy >= 0.0f ? dy / dMin : dy / dMax;
+        int first = static_cast<int>(std::floor(a0 / binWidth()));
+        int last = static_cast<int>(std::floor(a1 / binWidth()));
+        for (int b = first; b <= last; ++b) {
+            if (slopes[wrap(b)] <= slope) return false;
+        }
+        return true;
+    }
+
+private:
+    int bins;
+    glm::vec3 eye = glm::vec3(0.0f);
+    std::vector<float> slopes;
+
+    float binWidth() const { return 2.0f * 3.14159265358979f / static_cast<float>(bins); }
+
+    int wrap(int b) const { return ((b % bins) + bins) % bins; }
+
+    // 水平距离范围与方位角范围 [a0, a1]（以 0 ~ 2pi 为基准，可能越界，由 wrap 处理）。
+    // 相机位于包围盒正上/下方时无法定义方位角范围，返回 false
+    bool project(const AABB& box, float& dMin, float& dMax, float& a0, float& a1) const {
+        horizontalRange(box, dMin, dMax);
+        if (dMin <= 1e-6f) return false;
+        glm::vec2 c(0.5f * (box.min.x + box.max.x) - eye.x, 0.5f * (box.min.z + box.max.z) - eye.z);
+        float center = std::atan2(c.y, c.x);
+        float lo = 0.0f, hi = 0.0f;
+        const float xs[2] = { box.min.x, box.max.x }, zs[2] = { box.min.z, box.max.z };
+        for (float x : xs) {
+            for (float z : zs) {
+                float d = std::atan2(z - eye.z, x - eye.x) - center;
+                if (d > 3.14159265358979f) d -= 2.0f * 3.14159265358979f;
+                if (d < -3.14159265358979f) d += 2.0f * 3.14159265358979f;
+                lo = std::min(lo, d);
+                hi = std::max(hi, d);
+            }
+        }
+        a0 = center + lo + 3.14159265358979f;
+        a1 = center + hi + 3.14159265358979f;
+        return true;
+    }
+};
+
+#endif // HORIZON_CULLING_H
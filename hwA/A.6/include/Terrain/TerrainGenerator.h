@@ -0,0 +1,432 @@
+/*
+ * TerrainGenerator.h
+ *
+ * 程序化地形生成：任意分辨率的归一化高度场（0 ~ 1），可直接写成 TileStore 瓦片文件。
+ *
+ * - 噪声：梯度噪声叠加的 fBm 或 ridged 多重分形，可选域扭曲（用两路低频 fBm 偏移采样坐标）
+ * - 侵蚀（可选）：热力侵蚀（坡度超过休止角的部分向低处滑落）与水力侵蚀（降雨、按水面高差流动、
+ *   按流量冲刷与沉积泥沙、蒸发），都是网格上的逐格更新
+ * - 按 TILE x TILE 的块多线程生成，噪声每次计算 4 个采样（SSE2，无 SSE2 时退回标量）
+ *
+ * 结果只取决于设置（含 seed），与线程数无关：噪声是采样坐标的纯函数，块的列起点都是 4 的倍数，
+ * 同一采样总走同一条（SIMD 或标量）路径；侵蚀每轮只读上一轮的缓冲、每格只写自己。
+ *
+ * 采样 (row, col) 的噪声坐标为 (col / (width - 1), row / (height - 1)) * frequency，
+ * 同一 seed 换分辨率得到的是同一片地形的不同细节。
+ * 不做侵蚀时 writeTiles 逐行生成交给 TileStore，整张高度场不进入内存。
+ *
+ * 配置文件 <名称>.gen 每行 "键 值"，# 之后为注释，键与 TerrainGenSettings 的成员同名
+ * （noise 取 fbm / ridged，scale / offset 为竖直缩放与偏移）。
+ *
+ * 撰写者：Zhiyuan Feng
+ */
+
+#ifndef TERRAIN_GENERATOR_H
+#define TERRAIN_GENERATOR_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Parallel/ParallelFor.h"
+#include "Terrain/HeightConvert.h"
+#include "Terrain/HeightField.h"
+#include "Terrain/TileStore.h"
+
+struct TerrainGenSettings {
+    enum Noise { FBM, RIDGED };
+
+    uint32_t seed = 1;
+    int width = 1025;
+    int height = 1025;
+
+    Noise noise = FBM;
+    int octaves = 8;
+    float frequency = 4.0f;  // 第一层在整张地图上的周期数
+    float lacunarity = 2.0f; // 相邻两层的频率比
+    float gain = 0.5f;       // 相邻两层的振幅比
+    float warp = 0.0f;       // 域扭曲强度（以第一层的周期为单位），0 为不扭曲
+    float warpFrequency = 0.5f; // 扭曲噪声相对第一层的频率
+
+    int thermal = 0;         // 热力侵蚀轮数
+    float talus = 4.0f;      // 休止坡度：每个地图宽度上升的归一化高度
+
+    int hydraulic = 0;       // 水力侵蚀轮数
+    float rain = 0.0002f;    // 每轮每格降水
+    float evaporation = 0.05f;
+    float capacity = 1.0f;   // 泥沙容量 / 流量
+    float erosion = 0.1f;    // 低于容量时的冲刷比例
+    float deposition = 0.1f; // 高于容量时的沉积比例
+
+    VerticalScale vertical;
+
+    bool erodes() const { return thermal > 0 || hydraulic > 0; }
+
+    // 读取 .gen 配置，没有该文件时返回 false
+    bool load(const std::string& path) {
+        std::ifstream in(path);
+        if (!in.is_open()) {
+            std::cerr << "Error: Failed to open " << path << std::endl;
+            return false;
+        }
+        std::string line;
+        int lineNo = 0;
+        while (std::getline(in, line)) {
+            ++lineNo;
+            line = line.substr(0, line.find('#'));
+            std::istringstream fields(line);
+            std::string key, value;
+            if (!(fields >> key)) continue;
+            if (!(fields >> value) || !apply(key, value)) {
+                std::cerr << "Error: " << path << ":" << lineNo << ": invalid entry \"" << line << "\"" << std::endl;
+                return false;
+            }
+        }
+        if (width < 2 || height < 2 || octaves < 1) {
+            std::cerr << "Error: " << path << ": invalid size or octave count" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    bool apply(const std::string& key, const std::string& value) {
+        try {
+            if (key == "noise") {
+                if (value == "fbm") noise = FBM;
+                else if (value == "ridged") noise = RIDGED;
+                else return false;
+            } else if (key == "seed") {
+                seed = static_cast<uint32_t>(std::stoul(value));
+            } else if (key == "width") {
+                width = std::stoi(value);
+            } else if (key == "height") {
+                height = std::stoi(value);
+            } else if (key == "octaves") {
+                octaves = std::stoi(value);
+            } else if (key == "thermal") {
+                thermal = std::stoi(value);
+            } else if (key == "hydraulic") {
+                hydraulic = std::stoi(value);
+            } else {
+                float* target = key == "frequency" ? &frequency : key == "lacunarity" ? &lacunarity
+                              : key == "gain" ? &gain : key == "warp" ? &warp : key == "warpFrequency" ? &warpFrequency
+                              : key == "talus" ? &talus : key == "rain" ? &rain : key == "evaporation" ? &evaporation
+                              : key == "capacity" ? &capacity : key == "erosion" ? &erosion
+                              : key == "deposition" ? &deposition : key == "scale" ? &vertical.scale
+                              : key == "offset" ? &vertical.offset : nullptr;
+                if (!target) return false;
+                *target = std::stof(value);
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+        return true;
+    }
+};
+
+namespace terrain_gen_detail {
+
+// 整数格点的哈希（只用乘法、异或与移位，SIMD 版本逐位相同）
+const uint32_t HASH_X = 0x8da6b343u, HASH_Y = 0xd8163841u, HASH_SEED = 0xcb1ab31fu;
+const uint32_t MIX_1 = 0x2c1b3c6du, MIX_2 = 0x297a2d39u;
+
+inline uint32_t hash(uint32_t x, uint32_t y, uint32_t seed) {
+    uint32_t h = (x * HASH_X) ^ (y * HASH_Y) ^ (seed * HASH_SEED);
+    h ^= h >> 15;
+    h *= MIX_1;
+    h ^= h >> 12;
+    h *= MIX_2;
+    h ^= h >> 15;
+    return h;
+}
+
+// 标量版本的运算（与下面的 F4 接口相同，噪声代码对两者通用）
+inline float floorV(float v) { return std::floor(v); }
+inline float absV(float v) { return std::abs(v); }
+inline float clampV(float v, float lo, float hi) { return std::min(std::max(v, lo), hi); }
+
+// 格点 (floor(x) + ox, floor(y) + oy) 的随机梯度与偏移 (dx, dy) 的点积，梯度各分量在 [-1, 1)
+inline float gradDot(float fx, float fy, uint32_t ox, uint32_t oy, uint32_t seed, float dx, float dy) {
+    const uint32_t h = hash(static_cast<uint32_t>(static_cast<int32_t>(fx)) + ox,
+                            static_cast<uint32_t>(static_cast<int32_t>(fy)) + oy, seed);
+    const float gx = static_cast<float>(static_cast<int32_t>(h & 0xFFu) - 128) * (1.0f / 128.0f);
+    const float gy = static_cast<float>(static_cast<int32_t>((h >> 8) & 0xFFu) - 128) * (1.0f / 128.0f);
+    return gx * dx + gy * dy;
+}
+
+#ifdef HEIGHT_CONVERT_SSE2
+// 4 个 float 的 SSE2 向量
+struct F4 {
+    __m128 v;
+    F4(__m128 value) : v(value) {}
+    F4(float value) : v(_mm_set1_ps(value)) {}
+};
+
+inline F4 operator+(F4 a, F4 b) { return _mm_add_ps(a.v, b.v); }
+inline F4 operator-(F4 a, F4 b) { return _mm_sub_ps(a.v, b.v); }
+inline F4 operator*(F4 a, F4 b) { return _mm_mul_ps(a.v, b.v); }
+
+inline F4 floorV(F4 a) {
+    const __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+    return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, a.v), _mm_set1_ps(1.0f)));
+}
+inline F4 absV(F4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v); }
+inline F4 clampV(F4 a, float lo, float hi) { return _mm_min_ps(_mm_max_ps(a.v, _mm_set1_ps(lo)), _mm_set1_ps(hi)); }
+
+// SSE2 没有 32 位乘法取低位，用两次 32x32->64 位乘法拼出
+inline __m128i mullo32(__m128i a, uint32_t b) {
+    const __m128i vb = _mm_set1_epi32(static_cast<int>(b));
+    const __m128i even = _mm_mul_epu32(a, vb);
+    const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), vb);
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+inline F4 gradDot(F4 fx, F4 fy, uint32_t ox, uint32_t oy, uint32_t seed, F4 dx, F4 dy) {
+    const __m128i x = _mm_add_epi32(_mm_cvttps_epi32(fx.v), _mm_set1_epi32(static_cast<int>(ox)));
+    const __m128i y = _mm_add_epi32(_mm_cvttps_epi32(fy.v), _mm_set1_epi32(static_cast<int>(oy)));
+    __m128i h = _mm_xor_si128(_mm_xor_si128(mullo32(x, HASH_X), mullo32(y, HASH_Y)),
+                              _mm_set1_epi32(static_cast<int>(seed * HASH_SEED)));
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 15));
+    h = mullo32(h, MIX_1);
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 12));
+    h = mullo32(h, MIX_2);
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 15));
+    const __m128i mask = _mm_set1_epi32(0xFF), bias = _mm_set1_epi32(128);
+    const F4 gx = F4(_mm_cvtepi32_ps(_mm_sub_epi32(_mm_and_si128(h, mask), bias))) * F4(1.0f / 128.0f);
+    const F4 gy = F4(_mm_cvtepi32_ps(_mm_sub_epi32(_mm_and_si128(_mm_srli_epi32(h, 8), mask), bias))) * F4(1.0f / 128.0f);
+    return gx * dx + gy * dy;
+}
+#endif
+
+// 五次平滑曲线 6t^5 - 15t^4 + 10t^3
+template <typename V>
+V fade(V t) { return t * t * t * (t * (t * V(6.0f) - V(15.0f)) + V(10.0f)); }
+
+template <typename V>
+V lerpV(V a, V b, V t) { return a + (b - a) * t; }
+
+// 二维梯度噪声，约在 [-1, 1]
+template <typename V>
+V gradientNoise(V x, V y, uint32_t seed) {
+    const V fx = floorV(x), fy = floorV(y);
+    const V dx = x - fx, dy = y - fy;
+    const V n00 = gradDot(fx, fy, 0u, 0u, seed, dx, dy);
+    const V n10 = gradDot(fx, fy, 1u, 0u, seed, dx - V(1.0f), dy);
+    const V n01 = gradDot(fx, fy, 0u, 1u, seed, dx, dy - V(1.0f));
+    const V n11 = gradDot(fx, fy, 1u, 1u, seed, dx - V(1.0f), dy - V(1.0f));
+    const V u = fade(dx), v = fade(dy);
+    return lerpV(lerpV(n00, n10, u), lerpV(n01, n11, u), v);
+}
+
+// 多层叠加：fBm 结果绝大部分在 [-0.5, 0.5]，ridged 在 [0, 1]；每层换种子并平移，避免各层格点对齐
+template <typename V>
+V fractal(V x, V y, uint32_t seed, int octaves, bool ridged, float lacunarity, float gain) {
+    V sum(0.0f), weight(1.0f);
+    float amplitude = 1.0f, total = 0.0f;
+    for (int o = 0; o < octaves; ++o) {
+        V n = gradientNoise(x, y, hash(seed, static_cast<uint32_t>(o), 0x5bd1e995u));
+        if (ridged) {
+            n = V(1.0f) - absV(n);
+            n = n * n * weight;
+            weight = clampV(n * V(2.0f), 0.0f, 1.0f);
+        }
+        sum = sum + n * V(amplitude);
+        total += amplitude;
+        amplitude *= gain;
+        x = x * V(lacunarity) + V(17.31f);
+        y = y * V(lacunarity) + V(-9.87f);
+    }
+    return sum * V(1.0f / total);
+}
+
+} // namespace terrain_gen_detail
+
+class TerrainGenerator {
+public:
+    static const int TILE = 256; // 生成块边长（4 的倍数）
+
+    explicit TerrainGenerator(const TerrainGenSettings& settings) : settings(settings) {}
+
+    const TerrainGenSettings& config() const { return settings; }
+
+    // 第 row 行从 colBegin（4 的倍数）开始的 count 个采样，不含侵蚀；可被多个线程同时调用
+    void generateRow(int row, int colBegin, int count, float* out) const {
+        using namespace terrain_gen_detail;
+        const float stepX = settings.frequency / static_cast<float>(settings.width - 1);
+        const float y = static_cast<float>(row) * (settings.frequency / static_cast<float>(settings.height - 1));
+        int i = 0;
+#ifdef HEIGHT_CONVERT_SSE2
+        for (; i + 4 <= count; i += 4) {
+            const float c = static_cast<float>(colBegin + i);
+            const F4 x = F4(_mm_setr_ps(c, c + 1.0f, c + 2.0f, c + 3.0f)) * F4(stepX);
+            _mm_storeu_ps(out + i, heightAt(x, F4(y)).v);
+        }
+#endif
+        for (; i < count; ++i) {
+            out[i] = heightAt(static_cast<float>(colBegin + i) * stepX, y);
+        }
+    }
+
+    // 整张高度场：按块并行生成后做侵蚀
+    HeightField generate() const {
+        HeightField field;
+        field.width = settings.width;
+        field.height = settings.height;
+        field.vertical = settings.vertical;
+        field.heights.resize(static_cast<size_t>(field.width) * field.height);
+        const int tilesX = (field.width + TILE - 1) / TILE, tilesY = (field.height + TILE - 1) / TILE;
+        parallelFor(0, static_cast<size_t>(tilesX) * tilesY, [&](size_t t) {
+            const int col0 = static_cast<int>(t % tilesX) * TILE, row0 = static_cast<int>(t / tilesX) * TILE;
+            const int cols = std::min(TILE, field.width - col0);
+            for (int row = row0; row < std::min(row0 + TILE, field.height); ++row) {
+                generateRow(row, col0, cols, field.heights.data() + static_cast<size_t>(row) * field.width + col0);
+            }
+        }, 1);
+        if (settings.thermal > 0) {
+            erodeThermal(field, settings.thermal, settings.talus / static_cast<float>(std::max(field.width, field.height)));
+        }
+        if (settings.hydraulic > 0) {
+            erodeHydraulic(field, settings);
+        }
+        return field;
+    }
+
+    // 直接写成瓦片文件；不做侵蚀时逐行生成，不保留整张高度场
+    bool writeTiles(const std::string& path) const {
+        if (settings.erodes()) {
+            return TileStore::build(path, generate());
+        }
+        return TileStore::build(path, settings.width, settings.height, settings.vertical,
+                                [this](int row, float* out) { generateRow(row, 0, settings.width, out); });
+    }
+
+    // 热力侵蚀：相邻两格高差超过 talus 的部分按比例从高处移到低处（每条边的移动量对称，总量守恒）
+    static void erodeThermal(HeightField& field, int iterations, float talus) {
+        const int w = field.width, h = field.height;
+        std::vector<float> next(field.heights.size());
+        for (int it = 0; it < iterations; ++it) {
+            const float* src = field.heights.data();
+            parallelForRange(0, static_cast<size_t>(h), [&](size_t begin, size_t end) {
+                for (size_t r = begin; r < end; ++r) {
+                    for (int c = 0; c < w; ++c) {
+                        const size_t i = r * w + c;
+                        float delta = 0.0f;
+                        auto exchange = [&](size_t n) {
+                            const float diff = src[n] - src[i];
+                            const float excess = std::abs(diff) - talus;
+                            if (excess > 0.0f) delta += diff > 0.0f ? excess : -excess;
+                        };
+                        if (r > 0) exchange(i - w);
+                        if (r + 1 < static_cast<size_t>(h)) exchange(i + w);
+                        if (c > 0) exchange(i - 1);
+                        if (c + 1 < w) exchange(i + 1);
+                        next[i] = src[i] + 0.125f * delta;
+                    }
+                }
+            }, 16);
+            field.heights.swap(next);
+        }
+    }
+
+    // 水力侵蚀：每格有水量与悬浮泥沙。每轮先按水面（地面 + 水）高差算出流向四邻的水量，
+    // 再汇总流入流出，泥沙随水按比例迁移；流量决定泥沙容量，低于容量时冲刷地面、高于时沉积
+    static void erodeHydraulic(HeightField& field, const TerrainGenSettings& s) {
+        const int w = field.width, h = field.height;
+        const size_t n = field.heights.size();
+        std::vector<float> water(n, s.rain), sediment(n, 0.0f), flux(4 * n);
+        std::vector<float> nextHeight(n), nextWater(n), nextSediment(n);
+        // 四邻方向：上、下、左、右；opposite 为从邻格流回本格的方向
+        const int opposite[4] = { 1, 0, 3, 2 };
+        auto neighbour = [w, h](size_t i, int dir, size_t& out) {
+            const size_t r = i / w, c = i % w;
+            switch (dir) {
+            case 0: if (r == 0) return false; out = i - w; return true;
+            case 1: if (r + 1 >= static_cast<size_t>(h)) return false; out = i + w; return true;
+            case 2: if (c == 0) return false; out = i - 1; return true;
+            default: if (c + 1 >= static_cast<size_t>(w)) return false; out = i + 1; return true;
+            }
+        };
+
+        for (int it = 0; it < s.hydraulic; ++it) {
+            const float* ground = field.heights.data();
+            // 流出量：最多流走自身水量，且不超过高差之和的一半（避免来回振荡）
+            parallelForRange(0, n, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    const float surface = ground[i] + water[i];
+                    float drop[4], total = 0.0f;
+                    for (int d = 0; d < 4; ++d) {
+                        size_t j;
+                        drop[d] = neighbour(i, d, j) ? std::max(surface - ground[j] - water[j], 0.0f) : 0.0f;
+                        total += drop[d];
+                    }
+                    const float scale = total > 0.0f ? std::min(water[i], 0.5f * total) / total : 0.0f;
+                    for (int d = 0; d < 4; ++d) {
+                        flux[4 * i + d] = drop[d] * scale;
+                    }
+                }
+            }, 4096);
+            parallelForRange(0, n, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    const float out = flux[4 * i] + flux[4 * i + 1] + flux[4 * i + 2] + flux[4 * i + 3];
+                    float in = 0.0f, sedimentIn = 0.0f;
+                    for (int d = 0; d < 4; ++d) {
+                        size_t j;
+                        if (!neighbour(i, d, j)) continue;
+                        const float f = flux[4 * j + opposite[d]];
+                        in += f;
+                        if (f > 0.0f) sedimentIn += sediment[j] * f / water[j];
+                    }
+                    const float sedimentOut = out > 0.0f ? sediment[i] * out / water[i] : 0.0f;
+                    float g = ground[i];
+                    float carried = sediment[i] - sedimentOut + sedimentIn;
+                    const float capacity = s.capacity * 0.5f * (in + out);
+                    if (carried > capacity) {
+                        const float amount = s.deposition * (carried - capacity);
+                        g += amount;
+                        carried -= amount;
+                    } else {
+                        const float amount = s.erosion * (capacity - carried);
+                        g -= amount;
+                        carried += amount;
+                    }
+                    nextHeight[i] = g;
+                    nextSediment[i] = carried;
+                    nextWater[i] = (water[i] - out + in) * (1.0f - s.evaporation) + s.rain;
+                }
+            }, 4096);
+            field.heights.swap(nextHeight);
+            water.swap(nextWater);
+            sediment.swap(nextSediment);
+        }
+        // 剩余泥沙落回地面
+        parallelFor(0, n, [&](size_t i) {
+            field.heights[i] = std::min(std::max(field.heights[i] + sediment[i], 0.0f), 1.0f);
+        });
+    }
+
+private:
+    TerrainGenSettings settings;
+
+    // 采样坐标 (x, y)（已乘以 frequency）处的归一化高度
+    template <typename V>
+    V heightAt(V x, V y) const {
+        using namespace terrain_gen_detail;
+        if (settings.warp > 0.0f) {
+            const V wx = x * V(settings.warpFrequency), wy = y * V(settings.warpFrequency);
+            const V qx = fractal(wx + V(5.2f), wy + V(1.3f), hash(settings.seed, 1u, 0x68e31da4u), 4, false, 2.0f, 0.5f);
+            const V qy = fractal(wx + V(1.7f), wy + V(9.2f), hash(settings.seed, 2u, 0x68e31da4u), 4, false, 2.0f, 0.5f);
+            x = x + qx * V(settings.warp);
+            y = y + qy * V(settings.warp);
+        }
+        const bool ridged = settings.noise == TerrainGenSettings::RIDGED;
+        const V n = fractal(x, y, settings.seed, settings.octaves, ridged, settings.lacunarity, settings.gain);
+        return clampV(ridged ? n : V(0.5f) + n, 0.0f, 1.0f);
+    }
+};
+
+#endif // TERRAIN_GENERATOR_H
@@ -0,0 +1,105 @@
+/*
+ * TerrainMesh.h
+ *
+ * 由高度场直接在内存中生成地形网格并上传GPU，不再经由 land.obj 文本中转和逐面 addFace。
+ *
+ * - 顶点只含位置（land.vs 只读取 aPos），按行并行生成
+ * - 索引按网格单元并行生成，每个单元两个三角形，顺序与原 land.obj 完全相同
+ * - exportObj 仅供调试，把同一份数据写成 OBJ
+ *
+ * 撰写者：Zhiyuan Feng
+ */
+
+#ifndef TERRAIN_MESH_H
+#define TERRAIN_MESH_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+#include "Parallel/ParallelFor.h"
+#include "Terrain/HeightField.h"
+
+class TerrainMesh {
+public:
+    std::vector<glm::vec3> positions;
+    std::vector<unsigned int> indices;
+
+    // OpenGL相关
+    unsigned int VAO = 0;
+    unsigned int VBO = 0, EBO = 0;
+
+    // 由高度场生成顶点与索引
+    void build(const HeightField& field) {
+        const size_t width = static_cast<size_t>(field.width);
+        const size_t height = static_cast<size_t>(field.height);
+        const float maxX = static_cast<float>(field.width), maxY = static_cast<float>(field.height);
+
+        positions.resize(width * height);
+        parallelFor(0, height, [&](size_t row) {
+            for (size_t col = 0; col < width; ++col) {
+                positions[row * width + col] = glm::vec3(static_cast<float>(row) / maxY, field.heights[row * width + col],
+                                                         static_cast<float>(col) / maxX);
+            }
+        }, 16);
+
+        // 每个单元 (row, col) 占 6 个索引，位置由单元编号直接算出
+        const size_t cellsPerRow = width > 0 ? width - 1 : 0;
+        const size_t cellRows = height > 0 ? height - 1 : 0;
+        indices.resize(6 * cellsPerRow * cellRows);
+        parallelFor(0, cellRows, [&](size_t row) {
+            unsigned int* out = indices.data() + 6 * row * cellsPerRow;
+            for (size_t col = 0; col < cellsPerRow; ++col) {
+                unsigned int v00 = static_cast<unsigned int>(row * width + col);
+                unsigned int v01 = v00 + 1;
+                unsigned int v10 = static_cast<unsigned int>((row + 1) * width + col);
+                unsigned int v11 = v10 + 1;
+                // 两个三角形组成一个矩形
+                *out++ = v00; *out++ = v01; *out++ = v11;
+                *out++ = v11; *out++ = v10; *out++ = v00;
+            }
+        }, 16);
+    }
+
+    // 上传到GPU
+    void setupMesh() {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+
+        glBindVertexArray(VAO);
+
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec3), positions.data(), GL_STATIC_DRAW);
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+
+        // 位置
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+
+        glBindVertexArray(0);
+    }
+
+    GLsizei indexCount() const { return static_cast<GLsizei>(indices.size()); }
+
+    // 调试用：导出为 OBJ（索引从1开始）
+    bool exportObj(const std::string& objName) const {
+        FILE* fid = fopen(objName.c_str(), "w");
+        if (!fid) {
+            return false;
+        }
+        for (const glm::vec3& p : positions) {
+            fprintf(fid, "v %f %f %f\n", p.x, p.y, p.z);
+        }
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            fprintf(fid, "f %u %u %u\n", indices[i] + 1, indices[i + 1] + 1, indices[i + 2] + 1);
+        }
+        fclose(fid);
+        return true;
+    }
+};
+
+#endif // TERRAIN_MESH_H
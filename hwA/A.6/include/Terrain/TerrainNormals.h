@@ -0,0 +1,120 @@
+/*
+ * TerrainNormals.h
+ *
+ * 直接由高度栅格计算地形法线（3x3 Sobel 梯度），不经过网格与半边：
+ * - sobelNormalRow：一行采样的法线，SSE2 每次处理 4 个采样，无 SSE2 时退回标量
+ * - computeNormals：整张高度场按行块多线程计算
+ * - computeTileNormals：TileStore 某级一个瓦片的法线（边界向相邻瓦片取样，瓦片之间没有接缝）
+ *
+ * 法线按 (nx, nz) 两个 int8（* 127）打包，ny = sqrt(1 - nx^2 - nz^2) 恒为正，可直接上传为 GL_RG8_SNORM。
+ * 行方向对应地形局部 x，列方向对应 z（与 HeightField / land.vs 一致）。
+ * kRow / kCol 把 Sobel 结果换算为斜率：高度缩放 / (8 * 相邻采样的水平间距)，见 normalFactors。
+ *
+ * 撰写者：Zhiyuan Feng
+ */
+
+#ifndef TERRAIN_NORMALS_H
+#define TERRAIN_NORMALS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "Parallel/ParallelFor.h"
+#include "Terrain/HeightConvert.h"
+#include "Terrain/HeightField.h"
+#include "Terrain/TileStore.h"
+
+// width x height 个采样铺满 horizontalScale 的局部范围时，第 level 级（采样间隔 2^level）的换算系数
+inline void normalFactors(int width, int height, int level, float heightScale, float horizontalScale, float& kRow, float& kCol) {
+    const float spacing = horizontalScale * static_cast<float>(1u << level);
+    kRow = heightScale * static_cast<float>(height) / (8.0f * spacing);
+    kCol = heightScale * static_cast<float>(width) / (8.0f * spacing);
+}
+
+// above / row / below 为相邻三行，各 n + 2 个采样（左右各多一个边界采样）；输出 n 对 (nx, nz)
+inline void sobelNormalRow(const float* above, const float* row, const float* below, size_t n,
+                           float kRow, float kCol, int8_t* out) {
+    size_t i = 0;
+#ifdef HEIGHT_CONVERT_SSE2
+    const __m128 two = _mm_set1_ps(2.0f), one = _mm_set1_ps(1.0f), s127 = _mm_set1_ps(127.0f);
+    const __m128 kr = _mm_set1_ps(-kRow), kc = _mm_set1_ps(-kCol);
+    for (; i + 4 <= n; i += 4) {
+        const __m128 a0 = _mm_loadu_ps(above + i), a1 = _mm_loadu_ps(above + i + 1), a2 = _mm_loadu_ps(above + i + 2);
+        const __m128 r0 = _mm_loadu_ps(row + i), r2 = _mm_loadu_ps(row + i + 2);
+        const __m128 b0 = _mm_loadu_ps(below + i), b1 = _mm_loadu_ps(below + i + 1), b2 = _mm_loadu_ps(below + i + 2);
+        // 列方向：右列 - 左列；行方向：下行 - 上行
+        const __m128 gCol = _mm_add_ps(_mm_add_ps(_mm_sub_ps(a2, a0), _mm_sub_ps(b2, b0)), _mm_mul_ps(two, _mm_sub_ps(r2, r0)));
+        const __m128 gRow = _mm_add_ps(_mm_add_ps(_mm_sub_ps(b0, a0), _mm_sub_ps(b2, a2)), _mm_mul_ps(two, _mm_sub_ps(b1, a1)));
+        const __m128 nx = _mm_mul_ps(gRow, kr), nz = _mm_mul_ps(gCol, kc);
+        const __m128 inv = _mm_div_ps(s127, _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(nz, nz)), one)));
+        // 四舍五入转整数后交错成 (nx, nz) 并打包为 8 字节
+        const __m128i ix = _mm_cvtps_epi32(_mm_mul_ps(nx, inv)), iz = _mm_cvtps_epi32(_mm_mul_ps(nz, inv));
+        const __m128i pairs = _mm_packs_epi32(_mm_unpacklo_epi32(ix, iz), _mm_unpackhi_epi32(ix, iz));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + 2 * i), _mm_packs_epi16(pairs, pairs));
+    }
+#endif
+    for (; i < n; ++i) {
+        const float gCol = (above[i + 2] - above[i]) + 2.0f * (row[i + 2] - row[i]) + (below[i + 2] - below[i]);
+        const float gRow = (below[i] - above[i]) + 2.0f * (below[i + 1] - above[i + 1]) + (below[i + 2] - above[i + 2]);
+        const float nx = -gRow * kRow, nz = -gCol * kCol;
+        const float inv = 127.0f / std::sqrt(nx * nx + nz * nz + 1.0f);
+        out[2 * i] = static_cast<int8_t>(std::lrint(nx * inv));
+        out[2 * i + 1] = static_cast<int8_t>(std::lrint(nz * inv));
+    }
+}
+
+// 整张高度场的法线，out 为 width * height 对 (nx, nz)；边界采样取最近的内部采样
+inline void computeNormals(const HeightField& field, float kRow, float kCol, std::vector<int8_t>& out) {
+    const int w = field.width, h = field.height;
+    out.resize(static_cast<size_t>(w) * h * 2);
+    if (field.empty()) return;
+    parallelForRange(0, static_cast<size_t>(h), [&](size_t begin, size_t end) {
+        // 三行带左右边界的滚动缓冲
+        std::vector<float> padded(3 * static_cast<size_t>(w + 2));
+        auto fill = [&](int r, float* dst) {
+            const float* src = field.heights.data() + static_cast<size_t>(std::min(std::max(r, 0), h - 1)) * w;
+            std::copy(src, src + w, dst + 1);
+            dst[0] = src[0];
+            dst[w + 1] = src[w - 1];
+        };
+        float* rows[3] = { padded.data(), padded.data() + (w + 2), padded.data() + 2 * (w + 2) };
+        fill(static_cast<int>(begin) - 1, rows[0]);
+        fill(static_cast<int>(begin), rows[1]);
+        for (size_t r = begin; r < end; ++r) {
+            fill(static_cast<int>(r) + 1, rows[2]);
+            sobelNormalRow(rows[0], rows[1], rows[2], static_cast<size_t>(w), kRow, kCol, out.data() + r * w * 2);
+            std::rotate(rows, rows + 1, rows + 3);
+        }
+    }, 64);
+}
+
+// TileStore 第 level 级瓦片 (tx, ty) 的法线，out 为 tileSamples()^2 对 (nx, nz)，布局与瓦片相同
+inline void computeTileNormals(const TileStore& store, int level, int tx, int ty, float kRow, float kCol, int8_t* out) {
+    const int S = store.tileSamples(), T = store.tileSize();
+    const int row0 = ty * T - 1, col0 = tx * T - 1; // 带边界的块左上角（本级采样坐标）
+    const uint16_t* tile = store.tile(level, tx, ty);
+    std::vector<float> patch(static_cast<size_t>(S + 2) * (S + 2));
+    for (int r = 0; r < S + 2; ++r) {
+        float* dst = patch.data() + static_cast<size_t>(r) * (S + 2);
+        if (r == 0 || r == S + 1) {
+            for (int c = 0; c < S + 2; ++c) {
+                dst[c] = store.levelSample(level, row0 + r, col0 + c);
+            }
+            continue;
+        }
+        const uint16_t* src = tile + static_cast<size_t>(r - 1) * S;
+        for (int c = 0; c < S; ++c) {
+            dst[c + 1] = TileStore::decode(src[c]);
+        }
+        dst[0] = store.levelSample(level, row0 + r, col0);
+        dst[S + 1] = store.levelSample(level, row0 + r, col0 + S + 1);
+    }
+    for (int r = 0; r < S; ++r) {
+        const float* above = patch.data() + static_cast<size_t>(r) * (S + 2);
+        sobelNormalRow(above, above + (S + 2), above + 2 * (S + 2), static_cast<size_t>(S), kRow, kCol,
+                       out + static_cast<size_t>(r) * S * 2);
+    }
+}
+
+#endif // TERRAIN_NORMALS_H
@@ -0,0 +1,310 @@
+/*
+ * TerrainQuery.h
+ *
+ * 地形高度与射线查询（供相机碰撞、拾取等使用），直接读取 TileStore 的第0级采样：
+ * - heightAt：世界坐标 (x, z) 处的地面高度，采样间双线性插值；地形范围外返回 -inf
+ * - heightsAt：批量查询，SSE2 每次计算 4 个点的采样坐标与插值权重，点数多时多线程
+ * - raycast：射线与地面（每个单元为双线性曲面，与 heightAt 一致）的第一个交点。
+ *   沿最大值 mipmap（每个节点为所覆盖单元的最大高度，由 TileStore 的分块最大高度逐级合并）
+ *   自顶向下、由近到远遍历，射线在节点区间内的最低点高于节点最大高度时整块跳过；
+ *   到达分块后按单元逐格步进求精确交点
+ *
+ * 局部 -> 世界变换由 setTransform 给出（即 model * CDLODTerrain::localTransform(...)），须为轴对齐的缩放与平移。
+ * 内部在采样空间 (行, 归一化高度, 列) 中计算，射线参数 t 与世界空间相同。
+ *
+ * 撰写者：Zhiyuan Feng
+ */
+
+#ifndef TERRAIN_QUERY_H
+#define TERRAIN_QUERY_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "glm/glm.hpp"
+#include "Parallel/ParallelFor.h"
+#include "Terrain/HeightConvert.h"
+#include "Terrain/TileStore.h"
+
+class TerrainQuery {
+public:
+    // 由瓦片存储构建最大值 mipmap；store 须在本对象之后销毁
+    bool build(const TileStore& tileStore) {
+        store = &tileStore;
+        width = tileStore.width();
+        height = tileStore.height();
+        blockSize = tileStore.blockSize();
+        levels.clear();
+
+        Level base;
+        base.countX = tileStore.blocksX();
+        base.countY = tileStore.blocksY();
+        base.maxHeight.resize(static_cast<size_t>(base.countX) * base.countY);
+        const float* minMax = tileStore.blockMinMax();
+        for (size_t i = 0; i < base.maxHeight.size(); ++i) {
+            base.maxHeight[i] = minMax[2 * i + 1];
+        }
+        levels.push_back(std::move(base));
+        while (levels.back().countX > 1 || levels.back().countY > 1) {
+            const Level& child = levels.back();
+            Level parent;
+            parent.countX = (child.countX + 1) / 2;
+            parent.countY = (child.countY + 1) / 2;
+            parent.maxHeight.assign(static_cast<size_t>(parent.countX) * parent.countY, -std::numeric_limits<float>::max());
+            for (int cy = 0; cy < child.countY; ++cy) {
+                for (int cx = 0; cx < child.countX; ++cx) {
+                    float& m = parent.maxHeight[static_cast<size_t>(cy / 2) * parent.countX + cx / 2];
+                    m = std::max(m, child.maxHeight[static_cast<size_t>(cy) * child.countX + cx]);
+                }
+            }
+            levels.push_back(std::move(parent));
+        }
+        return true;
+    }
+
+    void setTransform(const glm::mat4& localToWorld) {
+        // 采样空间 (行, h, 列) -> 局部 (行 / H, h, 列 / W) -> 世界
+        sampleToWorld = localToWorld;
+        sampleToWorld[0] *= 1.0f / static_cast<float>(height);
+        sampleToWorld[2] *= 1.0f / static_cast<float>(width);
+        worldToSample = glm::inverse(sampleToWorld);
+        hasTransform = true;
+    }
+
+    bool ready() const { return store != nullptr && hasTransform; }
+
+    // 世界坐标 (x, z) 处的地面高度（世界 y），地形范围外返回 -inf
+    float heightAt(float x, float z) const {
+        float y;
+        heightsAt(&x, &z, 1, &y);
+        return y;
+    }
+
+    // 批量查询：xs / zs / out 各 n 个
+    void heightsAt(const float* xs, const float* zs, size_t n, float* out) const {
+        if (!ready()) {
+            std::fill(out, out + n, -std::numeric_limits<float>::infinity());
+            return;
+        }
+        parallelForRange(0, n, [&](size_t begin, size_t end) {
+            heightsRange(xs, zs, begin, end, out);
+        }, 4096);
+    }
+
+    // 射线与地面的第一个交点，dir 无须归一化；命中时 t 为 origin + t * dir 中的参数
+    bool raycast(const glm::vec3& origin, const glm::vec3& dir, float maxT, float& t) const {
+        if (!ready()) return false;
+        const glm::vec3 o = glm::vec3(worldToSample * glm::vec4(origin, 1.0f));
+        const glm::vec3 d = glm::vec3(worldToSample * glm::vec4(dir, 0.0f));
+        Ray ray{ o.x, o.y, o.z, d.x, d.y, d.z };
+        double hit;
+        if (!visitNode(ray, static_cast<int>(levels.size()) - 1, 0, 0, 0.0, static_cast<double>(maxT), hit)) return false;
+        t = static_cast<float>(hit);
+        return true;
+    }
+
+private:
+    struct Level {
+        int countX = 0; // 列方向节点数
+        int countY = 0; // 行方向节点数
+        std::vector<float> maxHeight;
+    };
+
+    // 采样空间中的射线：x 为行，y 为归一化高度，z 为列
+    struct Ray {
+        double ox, oy, oz;
+        double dx, dy, dz;
+        double y(double t) const { return oy + t * dy; }
+    };
+
+    const TileStore* store = nullptr;
+    int width = 0, height = 0;
+    int blockSize = 1;
+    std::vector<Level> levels; // levels[k] 每个节点覆盖 blockSize * 2^k 个单元
+    glm::mat4 sampleToWorld = glm::mat4(1.0f);
+    glm::mat4 worldToSample = glm::mat4(1.0f);
+    bool hasTransform = false;
+
+    void heightsRange(const float* xs, const float* zs, size_t begin, size_t end, float* out) const {
+        // 轴对齐变换：行 = ax * x + bx，列 = az * z + bz，世界 y = sy * h + ty
+        const float ax = worldToSample[0][0], bx = worldToSample[3][0];
+        const float az = worldToSample[2][2], bz = worldToSample[3][2];
+        const float sy = sampleToWorld[1][1], ty = sampleToWorld[3][1];
+        const float maxRow = static_cast<float>(height - 1), maxCol = static_cast<float>(width - 1);
+        const float outside = -std::numeric_limits<float>::infinity();
+        size_t i = begin;
+#ifdef HEIGHT_CONVERT_SSE2
+        const __m128 vax = _mm_set1_ps(ax), vbx = _mm_set1_ps(bx), vaz = _mm_set1_ps(az), vbz = _mm_set1_ps(bz);
+        const __m128 vsy = _mm_set1_ps(sy), vty = _mm_set1_ps(ty), zero = _mm_setzero_ps();
+        const __m128 vmaxRow = _mm_set1_ps(maxRow), vmaxCol = _mm_set1_ps(maxCol), vout = _mm_set1_ps(outside);
+        const __m128 cellMaxRow = _mm_set1_ps(maxRow - 1.0f), cellMaxCol = _mm_set1_ps(maxCol - 1.0f);
+        for (; i + 4 <= end; i += 4) {
+            const __m128 r = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(xs + i), vax), vbx);
+            const __m128 c = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(zs + i), vaz), vbz);
+            const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(r, zero), _mm_cmple_ps(r, vmaxRow)),
+                                             _mm_and_ps(_mm_cmpge_ps(c, zero), _mm_cmple_ps(c, vmaxCol)));
+            // 单元左上角（截断到最后一个单元，使右/下边界上的点仍落在单元内）
+            const __m128 r0 = _mm_min_ps(_mm_max_ps(floor4(r), zero), cellMaxRow);
+            const __m128 c0 = _mm_min_ps(_mm_max_ps(floor4(c), zero), cellMaxCol);
+            const __m128 fr = _mm_sub_ps(r, r0), fc = _mm_sub_ps(c, c0);
+            alignas(16) float rows[4], cols[4], h00[4], h01[4], h10[4], h11[4];
+            _mm_store_ps(rows, r0);
+            _mm_store_ps(cols, c0);
+            for (int k = 0; k < 4; ++k) {
+                const int row = static_cast<int>(rows[k]), col = static_cast<int>(cols[k]);
+                h00[k] = store->sample(row, col);
+                h01[k] = store->sample(row, col + 1);
+                h10[k] = store->sample(row + 1, col);
+                h11[k] = store->sample(row + 1, col + 1);
+            }
+            const __m128 top = lerp4(_mm_load_ps(h00), _mm_load_ps(h01), fc);
+            const __m128 bottom = lerp4(_mm_load_ps(h10), _mm_load_ps(h11), fc);
+            const __m128 y = _mm_add_ps(_mm_mul_ps(lerp4(top, bottom, fr), vsy), vty);
+            _mm_storeu_ps(out + i, _mm_or_ps(_mm_and_ps(inside, y), _mm_andnot_ps(inside, vout)));
+        }
+#endif
+        for (; i < end; ++i) {
+            const float r = xs[i] * ax + bx, c = zs[i] * az + bz;
+            if (!(r >= 0.0f && r <= maxRow && c >= 0.0f && c <= maxCol)) {
+                out[i] = outside;
+                continue;
+            }
+            out[i] = bilinear(r, c) * sy + ty;
+        }
+    }
+
+#ifdef HEIGHT_CONVERT_SSE2
+    // 非负数的向下取整（SSE2 没有 floor 指令：截断后对负数修正）
+    static __m128 floor4(__m128 v) {
+        const __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(v));
+        return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, v), _mm_set1_ps(1.0f)));
+    }
+
+    static __m128 lerp4(__m128 a, __m128 b, __m128 f) { return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), f)); }
+#endif
+
+    // 采样空间 (行, 列) 处的归一化高度
+    float bilinear(float r, float c) const {
+        const int r0 = std::min(static_cast<int>(r), height - 2), c0 = std::min(static_cast<int>(c), width - 2);
+        const float fr = r - static_cast<float>(r0), fc = c - static_cast<float>(c0);
+        const float top = store->sample(r0, c0) + (store->sample(r0, c0 + 1) - store->sample(r0, c0)) * fc;
+        const float bottom = store->sample(r0 + 1, c0) + (store->sample(r0 + 1, c0 + 1) - store->sample(r0 + 1, c0)) * fc;
+        return top + (bottom - top) * fr;
+    }
+
+    // 射线与采样空间中行 [r0, r1]、列 [c0, c1] 范围的参数区间，限制在 [tMin, tMax] 内
+    static bool slab(const Ray& ray, double r0, double r1, double c0, double c1, double& tMin, double& tMax) {
+        const double o[2] = { ray.ox, ray.oz }, d[2] = { ray.dx, ray.dz };
+        const double lo[2] = { r0, c0 }, hi[2] = { r1, c1 };
+        for (int a = 0; a < 2; ++a) {
+            if (std::abs(d[a]) < 1e-12) {
+                if (o[a] < lo[a] || o[a] > hi[a]) return false;
+                continue;
+            }
+            double t0 = (lo[a] - o[a]) / d[a], t1 = (hi[a] - o[a]) / d[a];
+            if (t0 > t1) std::swap(t0, t1);
+            tMin = std::max(tMin, t0);
+            tMax = std::min(tMax, t1);
+        }
+        return tMin <= tMax;
+    }
+
+    // 第 level 级节点 (nx 列, ny 行)：在 [tMin, tMax] 内求第一个交点
+    bool visitNode(const Ray& ray, int level, int nx, int ny, double tMin, double tMax, double& hit) const {
+        const int cells = blockSize << level;
+        const int r0 = ny * cells, c0 = nx * cells;
+        const int r1 = std::min(r0 + cells, height - 1), c1 = std::min(c0 + cells, width - 1);
+        if (!slab(ray, r0, r1, c0, c1, tMin, tMax)) return false;
+        const Level& lv = levels[level];
+        if (std::min(ray.y(tMin), ray.y(tMax)) > lv.maxHeight[static_cast<size_t>(ny) * lv.countX + nx]) return false;
+        if (level == 0) return marchCells(ray, r0, r1, c0, c1, tMin, tMax, hit);
+
+        // 子节点按进入射线的先后访问，第一个命中即最近的交点
+        const Level& child = levels[level - 1];
+        struct Entry { double t; int x, y; };
+        Entry entries[4];
+        int count = 0;
+        for (int cy = 2 * ny; cy < std::min(2 * ny + 2, child.countY); ++cy) {
+            for (int cx = 2 * nx; cx < std::min(2 * nx + 2, child.countX); ++cx) {
+                const int childCells = cells / 2;
+                double t0 = tMin, t1 = tMax;
+                if (slab(ray, cy * childCells, std::min((cy + 1) * childCells, height - 1), cx * childCells,
+                         std::min((cx + 1) * childCells, width - 1), t0, t1)) {
+                    entries[count++] = Entry{ t0, cx, cy };
+                }
+            }
+        }
+        for (int i = 1; i < count; ++i) {
+            for (int j = i; j > 0 && entries[j].t < entries[j - 1].t; --j) std::swap(entries[j], entries[j - 1]);
+        }
+        for (int i = 0; i < count; ++i) {
+            if (visitNode(ray, level - 1, entries[i].x, entries[i].y, tMin, tMax, hit)) return true;
+        }
+        return false;
+    }
+
+    // 分块内按单元逐格步进（2D DDA）
+    bool marchCells(const Ray& ray, int r0, int r1, int c0, int c1, double tMin, double tMax, double& hit) const {
+        const double tStart = tMin;
+        int row = std::min(std::max(static_cast<int>(std::floor(ray.ox + tStart * ray.dx)), r0), r1 - 1);
+        int col = std::min(std::max(static_cast<int>(std::floor(ray.oz + tStart * ray.dz)), c0), c1 - 1);
+        const int stepRow = ray.dx > 0.0 ? 1 : -1, stepCol = ray.dz > 0.0 ? 1 : -1;
+        double t = tMin;
+        while (t <= tMax && row >= r0 && row < r1 && col >= c0 && col < c1) {
+            const double tRow = std::abs(ray.dx) < 1e-12 ? std::numeric_limits<double>::max()
+                                                          : (row + (stepRow > 0 ? 1 : 0) - ray.ox) / ray.dx;
+            const double tCol = std::abs(ray.dz) < 1e-12 ? std::numeric_limits<double>::max()
+                                                          : (col + (stepCol > 0 ? 1 : 0) - ray.oz) / ray.dz;
+            const double tExit = std::min(std::min(tRow, tCol), tMax);
+            if (intersectCell(ray, row, col, t, tExit, hit)) return true;
+            // 射线在本单元内结束（含竖直射线），不能再步进到相邻单元
+            if (tExit >= tMax) break;
+            if (tRow < tCol) row += stepRow;
+            else col += stepCol;
+            t = tExit;
+        }
+        return false;
+    }
+
+    // 射线在 [ta, tb] 内与单元 (row, col) 的双线性曲面 h = a + b u + c v + e u v 的第一个交点（u 为行内偏移，v 为列内偏移）
+    bool intersectCell(const Ray& ray, int row, int col, double ta, double tb, double& hit) const {
+        if (ta > tb) return false;
+        const double h00 = store->sample(row, col), h01 = store->sample(row, col + 1);
+        const double h10 = store->sample(row + 1, col), h11 = store->sample(row + 1, col + 1);
+        const double a = h00, b = h10 - h00, c = h01 - h00, e = h00 - h01 - h10 + h11;
+        const double ux = ray.ox - row, vz = ray.oz - col;
+        // f(t) = 射线高度 - 曲面高度 = A t^2 + B t + C，由正变为非正处即交点
+        const double A = -e * ray.dx * ray.dz;
+        const double B = ray.dy - (b * ray.dx + c * ray.dz + e * (ux * ray.dz + vz * ray.dx));
+        const double C = ray.oy - (a + b * ux + c * vz + e * ux * vz);
+        auto f = [&](double t) { return (A * t + B) * t + C; };
+        if (f(ta) <= 0.0) {
+            hit = ta;
+            return true;
+        }
+        double roots[2];
+        int count = 0;
+        if (std::abs(A) < 1e-12) {
+            if (std::abs(B) > 1e-15) roots[count++] = -C / B;
+        } else {
+            const double disc = B * B - 4.0 * A * C;
+            if (disc >= 0.0) {
+                const double s = std::sqrt(disc);
+                // 数值稳定的求根公式
+                const double q = -0.5 * (B + (B >= 0.0 ? s : -s));
+                roots[count++] = q / A;
+                if (q != 0.0) roots[count++] = C / q;
+            }
+        }
+        double best = std::numeric_limits<double>::max();
+        for (int i = 0; i < count; ++i) {
+            if (roots[i] >= ta && roots[i] <= tb) best = std::min(best, roots[i]);
+        }
+        if (best == std::numeric_limits<double>::max()) return false;
+        hit = best;
+        return true;
+    }
+};
+
+#endif // TERRAIN_QUERY_H
@@ -0,0 +1,426 @@
+/*
+ * TileStore.h
+ *
+ * 分块高度图存储：一次性预处理把高度图写成固定大小瓦片组成的多级金字塔，运行时内存映射按需读取，
+ * 整张高度图无需进入内存。
+ *
+ * 文件布局（小端，瓦片与分块数据按 64 字节对齐）：
+ *   Header    魔数、版本、字节序标记、第0级尺寸、瓦片边长、分块边长、级数、分块数、
+ *             竖直缩放与偏移（数据集配置）、源数据的取值映射（原始 DEM 的 min / max / nodata）、各段偏移
+ *   LevelInfo 每级的采样点数、瓦片数与第一个瓦片的偏移
+ *   分块      第0级每 blockSize x blockSize 个单元的 (最小, 最大) 高度，供四叉树包围盒使用
+ *   瓦片      逐级、逐行存放；每个瓦片 (tileSize + 1)^2 个 uint16 采样（相邻瓦片共享边），不足处复制边缘
+ *
+ * 第 p 级采样点 i 取第0级采样点 min(i * 2^p, width - 1)，直到整级可放进一个瓦片为止。
+ * 预处理按行批量（批内多线程）读入源数据，只缓存每级一条瓦片带，不要求源数据整体在内存中。
+ * 小高度图可用 buildInMemory 在内存中构建同样的布局，运行时走同一条路径。
+ *
+ * 撰写者：Zhiyuan Feng
+ */
+
+#ifndef TILE_STORE_H
+#define TILE_STORE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Mesh/ObjReader.h"
+#include "Parallel/ParallelFor.h"
+#include "Terrain/HeightConvert.h"
+#include "Terrain/HeightField.h"
+
+class TileStore {
+public:
+    static constexpr uint32_t VERSION = 3;
+    static constexpr int MAX_LEVELS = 32;
+
+    struct LevelInfo {
+        uint32_t width;   // 本级采样点数
+        uint32_t height;
+        uint32_t tilesX;  // 本级瓦片数
+        uint32_t tilesY;
+        uint64_t offset;  // 第一个瓦片的偏移
+    };
+
+    // 源数据到归一化高度的映射（原始 DEM 的 .meta 配置），记录在文件头中，供调用方判断瓦片文件是否过期
+    struct SourceRange {
+        float minValue = 0.0f;
+        float maxValue = 0.0f;
+        float noData = 0.0f;
+        uint32_t hasNoData = 0;
+
+        bool operator==(const SourceRange& other) const {
+            return minValue == other.minValue && maxValue == other.maxValue && hasNoData == other.hasNoData &&
+                   (!hasNoData || noData == other.noData);
+        }
+        bool operator!=(const SourceRange& other) const { return !(*this == other); }
+    };
+
+    // 逐行读取源高度（归一化到 0 ~ 1），out 长度为 width；会被多个线程同时调用
+    using RowReader = std::function<void(int row, float* out)>;
+
+    // 预处理：把高度图写成瓦片文件（先写临时文件再重命名）
+    static bool build(const std::string& path, int width, int height, const VerticalScale& vertical, const RowReader& readRow,
+                      int tileSize = 256, int blockSize = 8) {
+        return build(path, width, height, vertical, SourceRange(), readRow, tileSize, blockSize);
+    }
+
+    static bool build(const std::string& path, int width, int height, const VerticalScale& vertical, const SourceRange& range,
+                      const RowReader& readRow, int tileSize = 256, int blockSize = 8) {
+        Header header;
+        std::vector<LevelInfo> levelInfos;
+        if (!makeLayout(width, height, tileSize, blockSize, header, levelInfos)) return false;
+        header.heightScale = vertical.scale;
+        header.heightOffset = vertical.offset;
+        header.sourceRange = range;
+
+        const std::string tempPath = path + ".tmp";
+        {
+            std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+            if (!out.is_open()) {
+                std::cerr << "Error: Failed to write tile store " << path << std::endl;
+                return false;
+            }
+            // 预先撑开整个文件，之后按偏移写入
+            out.seekp(static_cast<std::streamoff>(header.fileSize - 1));
+            out.put('\0');
+            writeAll(header, levelInfos, readRow, [&](uint64_t offset, const void* data, size_t size) {
+                out.seekp(static_cast<std::streamoff>(offset));
+                out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+            });
+            if (!out) {
+                std::cerr << "Error: Failed to write tile store " << path << std::endl;
+                return false;
+            }
+        }
+        std::remove(path.c_str());
+        if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    static bool build(const std::string& path, const HeightField& field, int tileSize = 256, int blockSize = 8) {
+        return build(path, field.width, field.height, field.vertical, fieldReader(field), tileSize, blockSize);
+    }
+
+    // 在内存中构建同样布局的存储（不落盘）
+    bool buildInMemory(const HeightField& field, int tileSize = 256, int blockSize = 8) {
+        close();
+        Header header;
+        std::vector<LevelInfo> levelInfos;
+        if (!makeLayout(field.width, field.height, tileSize, blockSize, header, levelInfos)) return false;
+        header.heightScale = field.vertical.scale;
+        header.heightOffset = field.vertical.offset;
+        memory.assign(static_cast<size_t>(header.fileSize), 0);
+        writeAll(header, levelInfos, fieldReader(field), [&](uint64_t offset, const void* data, size_t size) {
+            std::memcpy(memory.data() + offset, data, size);
+        });
+        return attach(memory.data(), memory.size());
+    }
+
+    // 内存映射瓦片文件并校验布局
+    bool open(const std::string& path) {
+        close();
+        file.reset(new MappedFile(path, false));
+        if (!file->isOpen() || !attach(file->begin(), file->length())) {
+            std::cerr << "Error: Invalid tile store " << path << std::endl;
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        file.reset();
+        memory.clear();
+        memory.shrink_to_fit();
+        base = nullptr;
+        levelInfos.clear();
+    }
+
+    bool empty() const { return base == nullptr; }
+    int width() const { return static_cast<int>(header.width); }
+    int height() const { return static_cast<int>(header.height); }
+    int tileSize() const { return static_cast<int>(header.tileSize); }
+    int tileSamples() const { return static_cast<int>(header.tileSize) + 1; } // 瓦片每边采样数
+    int blockSize() const { return static_cast<int>(header.blockSize); }
+    int levelCount() const { return static_cast<int>(header.levelCount); }
+    VerticalScale vertical() const { return VerticalScale{ header.heightScale, header.heightOffset }; }
+    const SourceRange& sourceRange() const { return header.sourceRange; }
+    const LevelInfo& level(int p) const { return levelInfos[p]; }
+    size_t tileBytes() const { return static_cast<size_t>(tileSamples()) * tileSamples() * sizeof(uint16_t); }
+
+    // 瓦片数据，tileSamples() 行 x tileSamples() 列
+    const uint16_t* tile(int p, int tx, int ty) const {
+        const LevelInfo& info = levelInfos[p];
+        return reinterpret_cast<const uint16_t*>(base + info.offset + (static_cast<uint64_t>(ty) * info.tilesX + tx) * tileStride());
+    }
+
+    // 第0级分块的 (最小, 最大) 高度，blocksX() x blocksY() 个，每个两个 float
+    int blocksX() const { return static_cast<int>(header.blocksX); }
+    int blocksY() const { return static_cast<int>(header.blocksY); }
+    const float* blockMinMax() const { return reinterpret_cast<const float*>(base + header.blockOffset); }
+
+    // 第0级采样点的高度
+    float sample(int row, int col) const { return levelSample(0, row, col); }
+
+    // 第 p 级采样点的高度（坐标截断到本级范围内）
+    float levelSample(int p, int row, int col) const {
+        const int T = tileSize();
+        const LevelInfo& info = levelInfos[p];
+        row = std::min(std::max(row, 0), static_cast<int>(info.height) - 1);
+        col = std::min(std::max(col, 0), static_cast<int>(info.width) - 1);
+        int tx = std::min(col / T, static_cast<int>(info.tilesX) - 1), ty = std::min(row / T, static_cast<int>(info.tilesY) - 1);
+        return decode(tile(p, tx, ty)[(row - ty * T) * tileSamples() + (col - tx * T)]);
+    }
+
+    static uint16_t encode(float h) {
+        uint16_t v;
+        encodeRowU16(&h, 1, &v);
+        return v;
+    }
+    static float decode(uint16_t v) { return static_cast<float>(v) / 65535.0f; }
+
+private:
+    static constexpr uint64_t ALIGNMENT = 64;
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint32_t width;
+        uint32_t height;
+        uint32_t tileSize;
+        uint32_t blockSize;
+        uint32_t levelCount;
+        uint32_t blocksX;
+        uint32_t blocksY;
+        float heightScale;
+        float heightOffset;
+        SourceRange sourceRange;
+        uint64_t blockOffset;
+        uint64_t fileSize;
+    };
+
+    Header header = {};
+    std::vector<LevelInfo> levelInfos;
+    std::unique_ptr<MappedFile> file;
+    std::vector<char> memory;
+    const char* base = nullptr;
+
+    static uint64_t alignUp(uint64_t offset) { return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT; }
+    uint64_t tileStride() const { return alignUp(tileBytes()); }
+
+    static Header makeHeader() {
+        Header h = {};
+        std::memcpy(h.magic, "TERRTIL", 8);
+        h.version = VERSION;
+        h.byteOrder = 0x01020304u;
+        return h;
+    }
+
+    static RowReader fieldReader(const HeightField& field) {
+        return [&field](int row, float* out) {
+            std::memcpy(out, field.heights.data() + static_cast<size_t>(row) * field.width, sizeof(float) * field.width);
+        };
+    }
+
+    // 计算各级尺寸与各段偏移
+    static bool makeLayout(int width, int height, int tileSize, int blockSize, Header& header, std::vector<LevelInfo>& infos) {
+        if (width < 2 || height < 2 || tileSize < 1 || blockSize < 1) {
+            std::cerr << "Error: Invalid tile store layout" << std::endl;
+            return false;
+        }
+        header = makeHeader();
+        header.width = static_cast<uint32_t>(width);
+        header.height = static_cast<uint32_t>(height);
+        header.tileSize = static_cast<uint32_t>(tileSize);
+        header.blockSize = static_cast<uint32_t>(blockSize);
+        header.blocksX = static_cast<uint32_t>((width - 2) / blockSize + 1);
+        header.blocksY = static_cast<uint32_t>((height - 2) / blockSize + 1);
+
+        infos.clear();
+        const uint64_t T = static_cast<uint64_t>(tileSize);
+        const uint64_t stride = alignUp((T + 1) * (T + 1) * sizeof(uint16_t));
+        uint64_t offset = alignUp(alignUp(sizeof(Header) + sizeof(LevelInfo) * MAX_LEVELS) +
+                                  sizeof(float) * 2 * header.blocksX * header.blocksY);
+        header.blockOffset = alignUp(sizeof(Header) + sizeof(LevelInfo) * MAX_LEVELS);
+        for (int p = 0; p < MAX_LEVELS; ++p) {
+            LevelInfo info;
+            info.width = static_cast<uint32_t>(((static_cast<uint64_t>(width) - 1) + (1ull << p) - 1) >> p) + 1;
+            info.height = static_cast<uint32_t>(((static_cast<uint64_t>(height) - 1) + (1ull << p) - 1) >> p) + 1;
+            info.tilesX = static_cast<uint32_t>((info.width - 2) / T + 1);
+            info.tilesY = static_cast<uint32_t>((info.height - 2) / T + 1);
+            info.offset = offset;
+            offset += stride * info.tilesX * info.tilesY;
+            infos.push_back(info);
+            if (info.tilesX == 1 && info.tilesY == 1) break;
+        }
+        header.levelCount = static_cast<uint32_t>(infos.size());
+        header.fileSize = offset;
+        return true;
+    }
+
+    // 逐行读入源数据，生成分块包围高度与各级瓦片，经 sink(偏移, 数据, 字节数) 写出
+    template <typename Sink>
+    static void writeAll(const Header& header, const std::vector<LevelInfo>& infos, const RowReader& readRow, Sink&& sink) {
+        const int width = static_cast<int>(header.width), height = static_cast<int>(header.height);
+        const int T = static_cast<int>(header.tileSize), B = static_cast<int>(header.blockSize);
+        const int S = T + 1;
+        const int blocksX = static_cast<int>(header.blocksX), blocksY = static_cast<int>(header.blocksY);
+        const uint64_t stride = alignUp(static_cast<uint64_t>(S) * S * sizeof(uint16_t));
+
+        sink(0, &header, sizeof(Header));
+        std::vector<LevelInfo> table(MAX_LEVELS, LevelInfo{});
+        std::copy(infos.begin(), infos.end(), table.begin());
+        sink(sizeof(Header), table.data(), sizeof(LevelInfo) * MAX_LEVELS);
+
+        // 每级一条瓦片带：S 行，带满（或到最后一行）时切成瓦片写出，最后一行留作下一条带的第一行
+        struct Band {
+            std::vector<uint16_t> rows;
+            uint32_t tileRow = 0;  // 当前瓦片行
+            uint32_t nextRow = 0;  // 本级下一个待填的行
+            int filled = 0;
+        };
+        std::vector<Band> bands(infos.size());
+        for (size_t p = 0; p < infos.size(); ++p) {
+            bands[p].rows.resize(static_cast<size_t>(S) * infos[p].width);
+        }
+        std::vector<uint16_t> tileBuffer(static_cast<size_t>(S) * S);
+        auto flush = [&](size_t p) {
+            const LevelInfo& info = infos[p];
+            const Band& band = bands[p];
+            for (uint32_t tx = 0; tx < info.tilesX; ++tx) {
+                for (int r = 0; r < S; ++r) {
+                    const uint16_t* src = band.rows.data() + static_cast<size_t>(std::min(r, band.filled - 1)) * info.width;
+                    for (int c = 0; c < S; ++c) {
+                        tileBuffer[static_cast<size_t>(r) * S + c] = src[std::min<uint64_t>(static_cast<uint64_t>(tx) * T + c, info.width - 1)];
+                    }
+                }
+                sink(info.offset + (static_cast<uint64_t>(band.tileRow) * info.tilesX + tx) * stride, tileBuffer.data(),
+                     tileBuffer.size() * sizeof(uint16_t));
+            }
+        };
+
+        // 分块 (最小, 最大)：每块包含边界上的采样点，按块行累积，块行结束时写出
+        std::vector<float> blockRow(static_cast<size_t>(2) * blocksX);
+        auto resetBlockRow = [&]() {
+            for (int b = 0; b < blocksX; ++b) {
+                blockRow[2 * b] = 1e30f;
+                blockRow[2 * b + 1] = -1e30f;
+            }
+        };
+        auto accumulate = [&](const uint16_t* row) {
+            for (int c = 0; c < width; ++c) {
+                const float h = decode(row[c]);
+                int b = c / B;
+                if (b < blocksX) {
+                    blockRow[2 * b] = std::min(blockRow[2 * b], h);
+                    blockRow[2 * b + 1] = std::max(blockRow[2 * b + 1], h);
+                }
+                if (c % B == 0 && c > 0) {
+                    blockRow[2 * (b - 1)] = std::min(blockRow[2 * (b - 1)], h);
+                    blockRow[2 * (b - 1) + 1] = std::max(blockRow[2 * (b - 1) + 1], h);
+                }
+            }
+        };
+        auto writeBlockRow = [&](int by) {
+            sink(header.blockOffset + sizeof(float) * 2 * static_cast<uint64_t>(by) * blocksX, blockRow.data(),
+                 blockRow.size() * sizeof(float));
+        };
+        resetBlockRow();
+        int blockY = 0;
+
+        // 每批 BATCH 行并行读取、转换并量化，再顺序写入瓦片带
+        constexpr int BATCH = 64;
+        std::vector<float> batchHeights(static_cast<size_t>(BATCH) * width);
+        std::vector<uint16_t> batchSamples(static_cast<size_t>(BATCH) * width);
+        for (int r = 0; r < height; ++r) {
+            const int batchRow = r % BATCH;
+            if (batchRow == 0) {
+                const int count = std::min(BATCH, height - r);
+                parallelFor(0, static_cast<size_t>(count), [&](size_t i) {
+                    float* heights = batchHeights.data() + i * width;
+                    readRow(r + static_cast<int>(i), heights);
+                    encodeRowU16(heights, static_cast<size_t>(width), batchSamples.data() + i * width);
+                }, 1);
+            }
+            const uint16_t* row = batchSamples.data() + static_cast<size_t>(batchRow) * width;
+
+            if (r % B == 0 && r > 0) {
+                accumulate(row);
+                writeBlockRow(blockY);
+                resetBlockRow();
+                blockY = r / B;
+            }
+            if (blockY < blocksY) {
+                accumulate(row);
+            }
+
+            for (size_t p = 0; p < infos.size(); ++p) {
+                const LevelInfo& info = infos[p];
+                Band& band = bands[p];
+                while (band.nextRow < info.height && std::min<uint64_t>(static_cast<uint64_t>(band.nextRow) << p, height - 1) == static_cast<uint64_t>(r)) {
+                    int local = static_cast<int>(band.nextRow - band.tileRow * T);
+                    uint16_t* dst = band.rows.data() + static_cast<size_t>(local) * info.width;
+                    if (p == 0) {
+                        std::copy(row, row + width, dst);
+                    } else {
+                        for (uint32_t j = 0; j < info.width; ++j) {
+                            dst[j] = row[std::min<uint64_t>(static_cast<uint64_t>(j) << p, width - 1)];
+                        }
+                    }
+                    band.filled = local + 1;
+                    if (local == T || band.nextRow == info.height - 1) {
+                        flush(p);
+                        if (local == T) {
+                            std::copy(dst, dst + info.width, band.rows.begin());
+                            band.filled = 1;
+                            ++band.tileRow;
+                        }
+                    }
+                    ++band.nextRow;
+                }
+            }
+        }
+        if (blockY < blocksY) {
+            writeBlockRow(blockY);
+        }
+    }
+
+    // 校验头部与各级布局，成功后 tile / blockMinMax 指向 data
+    bool attach(const char* data, size_t size) {
+        if (size < sizeof(Header) + sizeof(LevelInfo) * MAX_LEVELS) return false;
+        Header h;
+        std::memcpy(&h, data, sizeof(h));
+        const Header expected = makeHeader();
+        if (std::memcmp(h.magic, expected.magic, sizeof(h.magic)) != 0 || h.version != expected.version ||
+            h.byteOrder != expected.byteOrder || h.fileSize != size) {
+            return false;
+        }
+        Header layout;
+        std::vector<LevelInfo> infos;
+        if (!makeLayout(static_cast<int>(h.width), static_cast<int>(h.height), static_cast<int>(h.tileSize),
+                        static_cast<int>(h.blockSize), layout, infos) ||
+            layout.levelCount != h.levelCount || layout.fileSize != h.fileSize || layout.blockOffset != h.blockOffset) {
+            return false;
+        }
+        if (std::memcmp(data + sizeof(Header), infos.data(), sizeof(LevelInfo) * infos.size()) != 0) return false;
+        header = h;
+        levelInfos = infos;
+        base = data;
+        return true;
+    }
+};
+
+#endif // TILE_STORE_H
@@ -0,0 +1,120 @@
+/*
+ * TileStreamer.h
+ *
+ * 后台 I/O 线程：按主线程给出的请求顺序从 TileStore 读取瓦片。瓦片文件是内存映射的，
+ * 读取即触发缺页，这一步放在后台线程，主线程只拿已经读入内存的数据上传 GPU。
+ * 瓦片的法线也在后台线程中计算（见 TerrainNormals.h）。
+ *
+ * - request 用本帧的请求列表替换尚未开始读取的旧请求，相机移动后过时的请求自动作废
+ * - takeLoaded 取走已读完的瓦片
+ * - 正在读取或已读完未取走的瓦片不会被重复请求
+ *
+ * 撰写者：Zhiyuan Feng
+ */
+
+#ifndef TILE_STREAMER_H
+#define TILE_STREAMER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include "Terrain/TerrainNormals.h"
+#include "Terrain/TileStore.h"
+
+class TileStreamer {
+public:
+    struct LoadedTile {
+        uint64_t key;
+        std::vector<uint16_t> samples;
+        std::vector<int8_t> normals; // 每个采样一对 (nx, nz)
+    };
+
+    static uint64_t makeKey(int level, int tx, int ty) {
+        return (static_cast<uint64_t>(level) << 56) | (static_cast<uint64_t>(ty) << 28) | static_cast<uint64_t>(tx);
+    }
+    static int keyLevel(uint64_t key) { return static_cast<int>(key >> 56); }
+    static int keyTileY(uint64_t key) { return static_cast<int>((key >> 28) & 0xFFFFFFFull); }
+    static int keyTileX(uint64_t key) { return static_cast<int>(key & 0xFFFFFFFull); }
+
+    // horizontalScale：整张高度图在局部 x / z 方向的跨度，用于换算法线
+    TileStreamer(const TileStore& tileStore, float horizontalScale)
+        : store(tileStore), horizontal(horizontalScale), worker(&TileStreamer::run, this) {}
+
+    ~TileStreamer() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        worker.join();
+    }
+
+    TileStreamer(const TileStreamer&) = delete;
+    TileStreamer& operator=(const TileStreamer&) = delete;
+
+    // 替换待读队列，keys 按优先级从高到低排列
+    void request(const std::vector<uint64_t>& keys) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.clear();
+            for (uint64_t key : keys) {
+                if (busy.count(key) == 0) pending.push_back(key);
+            }
+        }
+        wake.notify_one();
+    }
+
+    // 取走已读完的瓦片
+    void takeLoaded(std::vector<LoadedTile>& out) {
+        std::lock_guard<std::mutex> lock(mutex);
+        out.swap(loaded);
+        loaded.clear();
+        for (const LoadedTile& tile : out) {
+            busy.erase(tile.key);
+        }
+    }
+
+private:
+    const TileStore& store;
+    float horizontal;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<uint64_t> pending;
+    std::unordered_set<uint64_t> busy; // 正在读取或已读完未取走
+    std::vector<LoadedTile> loaded;
+    bool stopping = false;
+    std::thread worker; // 须最后构造
+
+    void run() {
+        for (;;) {
+            uint64_t key;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || !pending.empty(); });
+                if (stopping) return;
+                key = pending.front();
+                pending.pop_front();
+                busy.insert(key);
+            }
+
+            LoadedTile tile;
+            tile.key = key;
+            tile.samples.resize(store.tileBytes() / sizeof(uint16_t));
+            std::memcpy(tile.samples.data(), store.tile(keyLevel(key), keyTileX(key), keyTileY(key)), store.tileBytes());
+            float kRow, kCol;
+            normalFactors(store.width(), store.height(), keyLevel(key), store.vertical().scale, horizontal, kRow, kCol);
+            tile.normals.resize(tile.samples.size() * 2);
+            computeTileNormals(store, keyLevel(key), keyTileX(key), keyTileY(key), kRow, kCol, tile.normals.data());
+
+            std::lock_guard<std::mutex> lock(mutex);
+            loaded.push_back(std::move(tile));
+        }
+    }
+};
+
+#endif // TILE_STREAMER_H
@@ -0,0 +1,128 @@
+/*
+ * WaterReflection.h
+ *
+ * 平面水面反射的渲染目标：反射通道用关于水面镜像的视图矩阵把场景画进一张降分辨率的纹理，
+ * 水面着色器再按片段的屏幕坐标（投影纹理坐标）采样该纹理。
+ *
+ * - resolutionDivisor：反射纹理为视口尺寸的 1 / 1、1 / 2 或 1 / 4
+ * - updateInterval：每 N 帧重绘一次反射，其余帧沿用上一次的结果
+ * - 视口尺寸或分辨率档位变化、或调用 invalidate 后，下一次 begin 必定重绘
+ *
+ * 用法：if (reflection.begin()) { 以 reflectedView 绘制场景; reflection.end(); }
+ * GL 对象随上下文一起销毁（与 CDLODTerrain 相同），只在尺寸变化时重建。
+ *
+ * 撰写者：Zhiyuan Feng
+ */
+
+#ifndef WATER_REFLECTION_H
+#define WATER_REFLECTION_H
+
+#include <algorithm>
+#include <iostream>
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+
+class WaterReflection {
+public:
+    struct Settings {
+        int resolutionDivisor = 2; // 1：全分辨率，2：一半，4：四分之一
+        int updateInterval = 1;    // 每隔几帧重绘一次
+    };
+
+    Settings settings;
+
+    WaterReflection() = default;
+    WaterReflection(const WaterReflection&) = delete;
+    WaterReflection& operator=(const WaterReflection&) = delete;
+
+    // 关于水平面 y = planeY 的镜像变换，反射通道的视图矩阵为 view * reflectionMatrix(planeY)
+    static glm::mat4 reflectionMatrix(float planeY) {
+        glm::mat4 m(1.0f);
+        m[1][1] = -1.0f;
+        m[3][1] = 2.0f * planeY;
+        return m;
+    }
+
+    // 本帧需要重绘时绑定反射帧缓冲并设置视口，返回 true；否则返回 false，不改变任何状态
+    bool begin() {
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        const int divisor = std::max(1, settings.resolutionDivisor);
+        const int w = std::max(1, viewport[2] / divisor), h = std::max(1, viewport[3] / divisor);
+        if (w != width || h != height) {
+            if (!allocate(w, h)) return false;
+            dirty = true;
+        }
+        if (!dirty && ++framesSinceUpdate < std::max(1, settings.updateInterval)) {
+            return false;
+        }
+        dirty = false;
+        framesSinceUpdate = 0;
+
+        std::copy(viewport, viewport + 4, savedViewport);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glViewport(0, 0, width, height);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        return true;
+    }
+
+    // 恢复默认帧缓冲与原视口
+    void end() {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(savedViewport[0], savedViewport[1], savedViewport[2], savedViewport[3]);
+    }
+
+    // 反射内容已过时（例如水面被剔除期间没有更新），下一次 begin 必定重绘
+    void invalidate() { dirty = true; }
+
+    GLuint texture() const { return colorTexture; }
+
+private:
+    GLuint framebuffer = 0, colorTexture = 0, depthBuffer = 0;
+    int width = 0, height = 0;
+    int framesSinceUpdate = 0;
+    bool dirty = true;
+    GLint savedViewport[4] = {};
+
+    bool allocate(int w, int h) {
+        release();
+        glGenTextures(1, &colorTexture);
+        glBindTexture(GL_TEXTURE_2D, colorTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glGenRenderbuffers(1, &depthBuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, w, h);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+        const bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (!complete) {
+            std::cerr << "Error: Reflection framebuffer is incomplete" << std::endl;
+            release();
+            return false;
+        }
+        width = w;
+        height = h;
+        return true;
+    }
+
+    void release() {
+        if (framebuffer) glDeleteFramebuffers(1, &framebuffer);
+        if (colorTexture) glDeleteTextures(1, &colorTexture);
+        if (depthBuffer) glDeleteRenderbuffers(1, &depthBuffer);
+        framebuffer = colorTexture = depthBuffer = 0;
+        width = height = 0;
+    }
+};
+
+#endif // WATER_REFLECTION_H
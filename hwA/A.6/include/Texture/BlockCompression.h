@@ -0,0 +1,310 @@
+/*
+ * BlockCompression.h
+ *
+ * BCn 块压缩的 CPU 编码器（不需要 GPU，离线转换用）。每个 4x4 像素块独立编码，按块行多线程处理：
+ * - BC1（DXT1）：两个 RGB565 端点 + 每像素 2 位索引，8 字节 / 块，不含 alpha
+ * - BC3（DXT5）：BC4 编码的 alpha + BC1 编码的颜色，16 字节 / 块
+ * - BC5（RGTC2）：R、G 两个通道各一个 BC4 块，16 字节 / 块，用于法线等双通道数据
+ *
+ * 颜色端点：协方差矩阵的主轴（幂迭代）上投影最远的两个像素，再用最小二乘按索引重新拟合一次，取误差小者。
+ * 像素到端点连线的投影与量化每次处理 4 个像素（SSE2，无 SSE2 时退回标量，两者结果相同）。
+ * 图片宽高不是 4 的倍数时，边缘块重复最后一行 / 列。
+ *
+ * 撰写者：Zhiyuan Feng
+ */
+
+#ifndef BLOCK_COMPRESSION_H
+#define BLOCK_COMPRESSION_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "Parallel/ParallelFor.h"
+#include "Texture/TextureImage.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BLOCK_COMPRESSION_SSE2 1
+#endif
+
+enum class BlockFormat { BC1, BC3, BC5 };
+
+inline size_t blockBytes(BlockFormat format) { return format == BlockFormat::BC1 ? 8 : 16; }
+
+// width x height 的一张图压缩后的字节数
+inline size_t compressedSize(BlockFormat format, int width, int height) {
+    return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * blockBytes(format);
+}
+
+namespace bc_detail {
+
+inline uint16_t pack565(const float rgb[3]) {
+    auto quantize = [](float v, int levels) {
+        return static_cast<int>(std::nearbyint(std::min(std::max(v, 0.0f), 255.0f) * levels / 255.0f));
+    };
+    return static_cast<uint16_t>((quantize(rgb[0], 31) << 11) | (quantize(rgb[1], 63) << 5) | quantize(rgb[2], 31));
+}
+
+inline void unpack565(uint16_t c, float rgb[3]) {
+    const int r = c >> 11, g = (c >> 5) & 63, b = c & 31;
+    rgb[0] = static_cast<float>((r << 3) | (r >> 2));
+    rgb[1] = static_cast<float>((g << 2) | (g >> 4));
+    rgb[2] = static_cast<float>((b << 3) | (b >> 2));
+}
+
+// 16 个 RGBA 像素相对 origin 在 dir 上的投影（不除以 |dir|），alpha 不参与
+inline void projectColors(const uint8_t rgba[64], const float origin[3], const float dir[3], float t[16]) {
+#ifdef BLOCK_COMPRESSION_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 ox = _mm_set1_ps(origin[0]), oy = _mm_set1_ps(origin[1]), oz = _mm_set1_ps(origin[2]);
+    const __m128 dx = _mm_set1_ps(dir[0]), dy = _mm_set1_ps(dir[1]), dz = _mm_set1_ps(dir[2]);
+    for (int i = 0; i < 16; i += 4) {
+        const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + 4 * i));
+        const __m128i lo = _mm_unpacklo_epi8(px, zero), hi = _mm_unpackhi_epi8(px, zero);
+        __m128 r = _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero));
+        __m128 g = _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero));
+        __m128 b = _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero));
+        __m128 a = _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero));
+        _MM_TRANSPOSE4_PS(r, g, b, a); // 每个像素一个向量 -> 每个通道一个向量
+        const __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(r, ox), dx), _mm_mul_ps(_mm_sub_ps(g, oy), dy)),
+                                      _mm_mul_ps(_mm_sub_ps(b, oz), dz));
+        _mm_storeu_ps(t + i, dot);
+    }
+#else
+    for (int i = 0; i < 16; ++i) {
+        const uint8_t* p = rgba + 4 * i;
+        t[i] = (p[0] - origin[0]) * dir[0] + (p[1] - origin[1]) * dir[1] + (p[2] - origin[2]) * dir[2];
+    }
+#endif
+}
+
+// steps[i] = round(clamp(t[i] * scale, 0, maxStep))
+inline void quantize(const float t[16], float scale, int maxStep, int steps[16]) {
+#ifdef BLOCK_COMPRESSION_SSE2
+    const __m128 s = _mm_set1_ps(scale), hi = _mm_set1_ps(static_cast<float>(maxStep));
+    for (int i = 0; i < 16; i += 4) {
+        const __m128 v = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(t + i), s), _mm_setzero_ps()), hi);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(steps + i), _mm_cvtps_epi32(v)); // 就近舍入（偶数）
+    }
+#else
+    for (int i = 0; i < 16; ++i) {
+        steps[i] = static_cast<int>(std::nearbyint(std::min(std::max(t[i] * scale, 0.0f), static_cast<float>(maxStep))));
+    }
+#endif
+}
+
+// 16 个字节的最小值与最大值
+inline void minMax16(const uint8_t v[16], int& lo, int& hi) {
+#ifdef BLOCK_COMPRESSION_SSE2
+    __m128i mn = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v)), mx = mn;
+    // 每次把高半部分折叠到低半部分
+    mn = _mm_min_epu8(mn, _mm_srli_si128(mn, 8)); mx = _mm_max_epu8(mx, _mm_srli_si128(mx, 8));
+    mn = _mm_min_epu8(mn, _mm_srli_si128(mn, 4)); mx = _mm_max_epu8(mx, _mm_srli_si128(mx, 4));
+    mn = _mm_min_epu8(mn, _mm_srli_si128(mn, 2)); mx = _mm_max_epu8(mx, _mm_srli_si128(mx, 2));
+    mn = _mm_min_epu8(mn, _mm_srli_si128(mn, 1)); mx = _mm_max_epu8(mx, _mm_srli_si128(mx, 1));
+    lo = _mm_cvtsi128_si32(mn) & 0xFF;
+    hi = _mm_cvtsi128_si32(mx) & 0xFF;
+#else
+    lo = hi = v[0];
+    for (int i = 1; i < 16; ++i) {
+        lo = std::min(lo, static_cast<int>(v[i]));
+        hi = std::max(hi, static_cast<int>(v[i]));
+    }
+#endif
+}
+
+// 颜色主轴上投影最远的两个像素作为初始端点
+inline void principalEndpoints(const uint8_t rgba[64], float e0[3], float e1[3]) {
+    float mean[3] = { 0.0f, 0.0f, 0.0f };
+    for (int i = 0; i < 16; ++i) {
+        for (int c = 0; c < 3; ++c) mean[c] += rgba[4 * i + c];
+    }
+    for (int c = 0; c < 3; ++c) mean[c] /= 16.0f;
+
+    float cov[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f }; // rr rg rb gg gb bb
+    for (int i = 0; i < 16; ++i) {
+        const float r = rgba[4 * i] - mean[0], g = rgba[4 * i + 1] - mean[1], b = rgba[4 * i + 2] - mean[2];
+        cov[0] += r * r; cov[1] += r * g; cov[2] += r * b;
+        cov[3] += g * g; cov[4] += g * b; cov[5] += b * b;
+    }
+
+    // 幂迭代求主轴
+    float axis[3] = { 1.0f, 1.0f, 1.0f };
+    for (int iteration = 0; iteration < 4; ++iteration) {
+        const float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+        const float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+        const float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+        const float m = std::max(std::max(std::abs(x), std::abs(y)), std::abs(z));
+        if (m < 1e-6f) break; // 单色块
+        axis[0] = x / m; axis[1] = y / m; axis[2] = z / m;
+    }
+
+    float t[16];
+    projectColors(rgba, mean, axis, t);
+    const int lo = static_cast<int>(std::min_element(t, t + 16) - t);
+    const int hi = static_cast<int>(std::max_element(t, t + 16) - t);
+    for (int c = 0; c < 3; ++c) {
+        e0[c] = rgba[4 * hi + c];
+        e1[c] = rgba[4 * lo + c];
+    }
+}
+
+// 按量化后的端点 c0、c1 为每个像素选择调色板位置（0 为 c0，3 为 c1），返回平方误差
+inline float fitSteps(const uint8_t rgba[64], uint16_t c0, uint16_t c1, int steps[16]) {
+    float p0[3], p1[3];
+    unpack565(c0, p0);
+    unpack565(c1, p1);
+    const float dir[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+    const float dd = dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2];
+    if (dd < 1e-6f) {
+        std::fill(steps, steps + 16, 0);
+    } else {
+        float t[16];
+        projectColors(rgba, p0, dir, t);
+        quantize(t, 3.0f / dd, 3, steps);
+    }
+    float error = 0.0f;
+    for (int i = 0; i < 16; ++i) {
+        const float w = steps[i] / 3.0f;
+        for (int c = 0; c < 3; ++c) {
+            const float d = p0[c] + (p1[c] - p0[c]) * w - rgba[4 * i + c];
+            error += d * d;
+        }
+    }
+    return error;
+}
+
+// 固定索引，最小二乘求端点；退化时返回 false
+inline bool refitEndpoints(const uint8_t rgba[64], const int steps[16], float e0[3], float e1[3]) {
+    float aa = 0.0f, bb = 0.0f, ab = 0.0f, ax[3] = { 0.0f, 0.0f, 0.0f }, bx[3] = { 0.0f, 0.0f, 0.0f };
+    for (int i = 0; i < 16; ++i) {
+        const float b = steps[i] / 3.0f, a = 1.0f - b;
+        aa += a * a; bb += b * b; ab += a * b;
+        for (int c = 0; c < 3; ++c) {
+            ax[c] += a * rgba[4 * i + c];
+            bx[c] += b * rgba[4 * i + c];
+        }
+    }
+    const float det = aa * bb - ab * ab;
+    if (std::abs(det) < 1e-6f) return false;
+    for (int c = 0; c < 3; ++c) {
+        e0[c] = (ax[c] * bb - bx[c] * ab) / det;
+        e1[c] = (bx[c] * aa - ax[c] * ab) / det;
+    }
+    return true;
+}
+
+// BC1 颜色块（BC3 的颜色部分相同）；总是写成 c0 > c1 的四色模式
+inline void encodeColorBlock(const uint8_t rgba[64], uint8_t out[8]) {
+    float e0[3], e1[3];
+    principalEndpoints(rgba, e0, e1);
+    uint16_t c0 = pack565(e0), c1 = pack565(e1);
+    int steps[16];
+    const float error = fitSteps(rgba, c0, c1, steps);
+
+    if (refitEndpoints(rgba, steps, e0, e1)) {
+        const uint16_t r0 = pack565(e0), r1 = pack565(e1);
+        int refit[16];
+        if (fitSteps(rgba, r0, r1, refit) < error) {
+            c0 = r0;
+            c1 = r1;
+            std::copy(refit, refit + 16, steps);
+        }
+    }
+
+    if (c0 < c1) {
+        std::swap(c0, c1);
+        for (int& s : steps) s = 3 - s;
+    } else if (c0 == c1) {
+        std::fill(steps, steps + 16, 0);
+    }
+    static const uint32_t indexOf[4] = { 0, 2, 3, 1 }; // 调色板位置 -> BC1 索引
+    uint32_t bits = 0;
+    for (int i = 0; i < 16; ++i) {
+        bits |= indexOf[steps[i]] << (2 * i);
+    }
+    out[0] = static_cast<uint8_t>(c0); out[1] = static_cast<uint8_t>(c0 >> 8);
+    out[2] = static_cast<uint8_t>(c1); out[3] = static_cast<uint8_t>(c1 >> 8);
+    for (int i = 0; i < 4; ++i) out[4 + i] = static_cast<uint8_t>(bits >> (8 * i));
+}
+
+// BC4 单通道块：端点取最大、最小值（八值模式）
+inline void encodeValueBlock(const uint8_t v[16], uint8_t out[8]) {
+    int lo, hi;
+    minMax16(v, lo, hi);
+    out[0] = static_cast<uint8_t>(hi);
+    out[1] = static_cast<uint8_t>(lo);
+    uint64_t bits = 0;
+    if (hi > lo) {
+        float t[16];
+        for (int i = 0; i < 16; ++i) t[i] = static_cast<float>(v[i] - lo);
+        int steps[16];
+        quantize(t, 7.0f / (hi - lo), 7, steps);
+        for (int i = 0; i < 16; ++i) {
+            // 位置 7 为最大值（索引 0），0 为最小值（索引 1），中间为索引 2 ~ 7
+            const uint64_t index = steps[i] == 7 ? 0 : steps[i] == 0 ? 1 : 8 - steps[i];
+            bits |= index << (3 * i);
+        }
+    }
+    for (int i = 0; i < 6; ++i) out[2 + i] = static_cast<uint8_t>(bits >> (8 * i));
+}
+
+// 取出 (bx, by) 处的 4x4 块并扩展为 RGBA：单通道为灰度，双通道为 灰度 + alpha
+inline void loadBlock(const TextureImage& image, int bx, int by, uint8_t rgba[64]) {
+    const int n = image.channels;
+    for (int y = 0; y < 4; ++y) {
+        const int sy = std::min(by * 4 + y, image.height - 1);
+        for (int x = 0; x < 4; ++x) {
+            const int sx = std::min(bx * 4 + x, image.width - 1);
+            const uint8_t* p = image.pixels.data() + (static_cast<size_t>(sy) * image.width + sx) * n;
+            uint8_t* q = rgba + 4 * (4 * y + x);
+            q[0] = p[0];
+            q[1] = n >= 3 ? p[1] : p[0];
+            q[2] = n >= 3 ? p[2] : p[0];
+            q[3] = n == 4 ? p[3] : n == 2 ? p[1] : 255;
+        }
+    }
+}
+
+} // namespace bc_detail
+
+// 压缩一张图，结果追加到 out 末尾（块按行优先排列）
+inline void compressImage(const TextureImage& image, BlockFormat format, std::vector<uint8_t>& out) {
+    using namespace bc_detail;
+    const int blocksX = (image.width + 3) / 4, blocksY = (image.height + 3) / 4;
+    const size_t bytes = blockBytes(format), start = out.size();
+    out.resize(start + compressedSize(format, image.width, image.height));
+    uint8_t* base = out.data() + start;
+
+    parallelForRange(0, static_cast<size_t>(blocksY), [&](size_t rowBegin, size_t rowEnd) {
+        uint8_t rgba[64], channel[16];
+        for (size_t by = rowBegin; by < rowEnd; ++by) {
+            for (int bx = 0; bx < blocksX; ++bx) {
+                uint8_t* block = base + (by * blocksX + bx) * bytes;
+                loadBlock(image, bx, static_cast<int>(by), rgba);
+                switch (format) {
+                    case BlockFormat::BC1:
+                        encodeColorBlock(rgba, block);
+                        break;
+                    case BlockFormat::BC3:
+                        for (int i = 0; i < 16; ++i) channel[i] = rgba[4 * i + 3];
+                        encodeValueBlock(channel, block);
+                        encodeColorBlock(rgba, block + 8);
+                        break;
+                    case BlockFormat::BC5:
+                        // 取源图的前两个通道：双通道源的第二通道在 loadBlock 中位于 alpha
+                        for (int c = 0; c < 2; ++c) {
+                            const int source = c == 1 && image.channels == 2 ? 3 : c;
+                            for (int i = 0; i < 16; ++i) channel[i] = rgba[4 * i + source];
+                            encodeValueBlock(channel, block + 8 * c);
+                        }
+                        break;
+                }
+            }
+        }
+    }, 16);
+}
+
+#endif // BLOCK_COMPRESSION_H
@@ -0,0 +1,172 @@
+/*
+ * DdsFile.h
+ *
+ * 预压缩纹理的容器：标准 DDS 文件（"DDS " + 124 字节头部），FourCC 为 DXT1 / DXT5 / ATI2（BC1 / BC3 / BC5）。
+ * 数据按 面 -> mipmap 级别 依次排列（立方体贴图 6 个面，顺序 +X, -X, +Y, -Y, +Z, -Z）。
+ *
+ * - buildDds：在 CPU 上生成 mipmap 链并逐级压缩（见 BlockCompression.h），不需要 GPU
+ * - writeDds / readDds：读写文件；读取时检查头部与数据长度
+ *
+ * 行顺序与运行时 stb_image 解码的结果一致（本程序开启了上下翻转），上传时不再翻转；
+ * 因此用其他工具查看这些文件时图像是上下颠倒的。
+ *
+ * 撰写者：Zhiyuan Feng
+ */
+
+#ifndef DDS_FILE_H
+#define DDS_FILE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Texture/BlockCompression.h"
+#include "Texture/TextureImage.h"
+
+struct DdsTexture {
+    BlockFormat format = BlockFormat::BC1;
+    int width = 0, height = 0;
+    int levels = 1; // 每个面的 mipmap 级数
+    int faces = 1;  // 1 或 6（立方体贴图）
+    std::vector<uint8_t> data;
+
+    int levelWidth(int level) const { return std::max(width >> level, 1); }
+    int levelHeight(int level) const { return std::max(height >> level, 1); }
+    size_t levelSize(int level) const { return compressedSize(format, levelWidth(level), levelHeight(level)); }
+
+    size_t faceSize() const {
+        size_t size = 0;
+        for (int level = 0; level < levels; ++level) size += levelSize(level);
+        return size;
+    }
+
+    // 第 face 个面第 level 级在 data 中的偏移
+    size_t offset(int face, int level) const {
+        size_t result = faceSize() * face;
+        for (int i = 0; i < level; ++i) result += levelSize(i);
+        return result;
+    }
+};
+
+namespace dds_detail {
+
+const uint32_t MAGIC = 0x20534444; // "DDS "
+const uint32_t FLAGS_REQUIRED = 0x1 | 0x2 | 0x4 | 0x1000; // CAPS | HEIGHT | WIDTH | PIXELFORMAT
+const uint32_t FLAG_MIPMAPCOUNT = 0x20000, FLAG_LINEARSIZE = 0x80000;
+const uint32_t PF_FOURCC = 0x4;
+const uint32_t CAPS_COMPLEX = 0x8, CAPS_TEXTURE = 0x1000, CAPS_MIPMAP = 0x400000;
+const uint32_t CAPS2_CUBEMAP_ALL_FACES = 0x200 | 0xFC00;
+
+struct Header {
+    uint32_t size, flags, height, width, pitchOrLinearSize, depth, mipMapCount, reserved1[11];
+    struct {
+        uint32_t size, flags, fourCC, rgbBitCount, rBitMask, gBitMask, bBitMask, aBitMask;
+    } pixelFormat;
+    uint32_t caps, caps2, caps3, caps4, reserved2;
+};
+static_assert(sizeof(Header) == 124, "DDS header must be 124 bytes");
+
+constexpr uint32_t fourCC(char a, char b, char c, char d) {
+    return static_cast<uint32_t>(static_cast<uint8_t>(a)) | (static_cast<uint32_t>(static_cast<uint8_t>(b)) << 8) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(c)) << 16) | (static_cast<uint32_t>(static_cast<uint8_t>(d)) << 24);
+}
+
+inline uint32_t fourCCOf(BlockFormat format) {
+    switch (format) {
+        case BlockFormat::BC3: return fourCC('D', 'X', 'T', '5');
+        case BlockFormat::BC5: return fourCC('A', 'T', 'I', '2');
+        default: return fourCC('D', 'X', 'T', '1');
+    }
+}
+
+inline bool formatOf(uint32_t code, BlockFormat& format) {
+    if (code == fourCC('D', 'X', 'T', '1')) format = BlockFormat::BC1;
+    else if (code == fourCC('D', 'X', 'T', '5')) format = BlockFormat::BC3;
+    else if (code == fourCC('A', 'T', 'I', '2') || code == fourCC('B', 'C', '5', 'U')) format = BlockFormat::BC5;
+    else return false;
+    return true;
+}
+
+} // namespace dds_detail
+
+// 压缩 faces（1 张或立方体贴图的 6 张，大小须相同）；mipmaps 为 true 时生成到 1x1 的整条链
+inline bool buildDds(const std::vector<TextureImage>& faces, BlockFormat format, bool mipmaps, DdsTexture& out) {
+    if (faces.size() != 1 && faces.size() != 6) return false;
+    for (const TextureImage& face : faces) {
+        if (face.width != faces[0].width || face.height != faces[0].height || face.channels < 1 || face.channels > 4) {
+            return false;
+        }
+    }
+    out = DdsTexture();
+    out.format = format;
+    out.width = faces[0].width;
+    out.height = faces[0].height;
+    out.faces = static_cast<int>(faces.size());
+    while (mipmaps && (out.levelWidth(out.levels - 1) > 1 || out.levelHeight(out.levels - 1) > 1)) ++out.levels;
+
+    out.data.reserve(out.faceSize() * out.faces);
+    for (const TextureImage& face : faces) {
+        TextureImage level = face;
+        for (int i = 0; i < out.levels; ++i) {
+            if (i > 0) level = halfSize(level);
+            compressImage(level, format, out.data);
+        }
+    }
+    return true;
+}
+
+inline bool writeDds(const std::string& path, const DdsTexture& texture) {
+    using namespace dds_detail;
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    header.size = sizeof(Header);
+    header.flags = FLAGS_REQUIRED | FLAG_LINEARSIZE | (texture.levels > 1 ? FLAG_MIPMAPCOUNT : 0);
+    header.height = static_cast<uint32_t>(texture.height);
+    header.width = static_cast<uint32_t>(texture.width);
+    header.pitchOrLinearSize = static_cast<uint32_t>(texture.levelSize(0));
+    header.mipMapCount = static_cast<uint32_t>(texture.levels);
+    header.pixelFormat.size = 32;
+    header.pixelFormat.flags = PF_FOURCC;
+    header.pixelFormat.fourCC = fourCCOf(texture.format);
+    header.caps = CAPS_TEXTURE | (texture.levels > 1 || texture.faces > 1 ? CAPS_COMPLEX : 0) |
+                  (texture.levels > 1 ? CAPS_MIPMAP : 0);
+    header.caps2 = texture.faces == 6 ? CAPS2_CUBEMAP_ALL_FACES : 0;
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) return false;
+    out.write(reinterpret_cast<const char*>(&MAGIC), sizeof(MAGIC));
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(texture.data.data()), static_cast<std::streamsize>(texture.data.size()));
+    return static_cast<bool>(out);
+}
+
+inline bool readDds(const std::string& path, DdsTexture& texture) {
+    using namespace dds_detail;
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) return false;
+    uint32_t magic = 0;
+    Header header;
+    if (!in.read(reinterpret_cast<char*>(&magic), sizeof(magic)) || magic != MAGIC ||
+        !in.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.size != sizeof(Header) ||
+        !(header.pixelFormat.flags & PF_FOURCC)) {
+        return false;
+    }
+    texture = DdsTexture();
+    if (!formatOf(header.pixelFormat.fourCC, texture.format) || header.width == 0 || header.height == 0 ||
+        header.width > 16384 || header.height > 16384) {
+        return false;
+    }
+    texture.width = static_cast<int>(header.width);
+    texture.height = static_cast<int>(header.height);
+    texture.levels = (header.flags & FLAG_MIPMAPCOUNT) && header.mipMapCount > 0 ? static_cast<int>(header.mipMapCount) : 1;
+    texture.faces = (header.caps2 & CAPS2_CUBEMAP_ALL_FACES) == CAPS2_CUBEMAP_ALL_FACES ? 6 : 1;
+    if (texture.levels > 15) return false;
+
+    texture.data.resize(texture.faceSize() * texture.faces);
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(texture.data.data()),
+                                     static_cast<std::streamsize>(texture.data.size())));
+}
+
+#endif // DDS_FILE_H
@@ -0,0 +1,53 @@
+/*
+ * TextureImage.h
+ *
+ * CPU 侧的 8 位图片与 mipmap 缩小，供纹理加载线程（TextureStreamer）与离线压缩（DdsFile）共用。
+ *
+ * - 像素按行优先紧密排列，每像素 channels（1 ~ 4）个字节
+ * - halfSize 为 2x2 盒式滤波（奇数边长时重复最后一行 / 列），与 glGenerateMipmap 的结果接近
+ *
+ * 撰写者：Zhiyuan Feng
+ */
+
+#ifndef TEXTURE_IMAGE_H
+#define TEXTURE_IMAGE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+struct TextureImage {
+    int width = 0, height = 0, channels = 0;
+    std::vector<unsigned char> pixels;
+};
+
+// 把 width x height 的 src 缩小为 w x h（w = max(width / 2, 1)，h 同理）写入 dst
+inline void downsampleBox(const unsigned char* src, int width, int height, int channels,
+                          unsigned char* dst, int w, int h) {
+    const size_t rowBytes = static_cast<size_t>(width) * channels;
+    for (int y = 0; y < h; ++y) {
+        const unsigned char* row0 = src + std::min(2 * y, height - 1) * rowBytes;
+        const unsigned char* row1 = src + std::min(2 * y + 1, height - 1) * rowBytes;
+        for (int x = 0; x < w; ++x) {
+            const size_t x0 = static_cast<size_t>(std::min(2 * x, width - 1)) * channels;
+            const size_t x1 = static_cast<size_t>(std::min(2 * x + 1, width - 1)) * channels;
+            for (int c = 0; c < channels; ++c) {
+                *dst++ = static_cast<unsigned char>((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) >> 2);
+            }
+        }
+    }
+}
+
+// 下一级 mipmap
+inline TextureImage halfSize(const TextureImage& image) {
+    TextureImage half;
+    half.width = std::max(image.width / 2, 1);
+    half.height = std::max(image.height / 2, 1);
+    half.channels = image.channels;
+    half.pixels.resize(static_cast<size_t>(half.width) * half.height * half.channels);
+    downsampleBox(image.pixels.data(), image.width, image.height, image.channels,
+                  half.pixels.data(), half.width, half.height);
+    return half;
+}
+
+#endif // TEXTURE_IMAGE_H
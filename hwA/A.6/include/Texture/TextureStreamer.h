@@ -0,0 +1,354 @@
+/*
+ * TextureStreamer.h
+ *
+ * 纹理的后台加载：工作线程解码图片并在 CPU 上生成整条 mipmap 链，主线程每帧通过像素解包缓冲（PBO）上传。
+ * 请求时立即返回纹理 ID，并先填入 1x1 的占位颜色，数据到达后原地替换同一纹理对象，
+ * 调用方不需要重新绑定，第一帧不必等待任何图片解码。
+ *
+ * - 解码函数由调用方提供（如 stb_image），本文件不依赖具体的图片库；解码函数须可在多个线程同时调用
+ * - load2D / loadCubemap 须在 GL 线程调用；update 每帧调用一次，按字节预算上传已解码的纹理
+ * - mipmap 为 2x2 盒式滤波（见 TextureImage.h），与 glGenerateMipmap 的结果接近
+ * - 路径以 .dds 结尾时读取预压缩的 BC1 / BC3 / BC5 纹理（见 DdsFile.h），整条 mipmap 链用 glCompressedTexImage2D 直接上传
+ * - 加载失败的纹理保持占位颜色并输出错误
+ *
+ * GL 对象随上下文一起销毁（与 CDLODTerrain 相同）；析构时等待工作线程结束。
+ *
+ * 撰写者：Zhiyuan Feng
+ */
+
+#ifndef TEXTURE_STREAMER_H
+#define TEXTURE_STREAMER_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "glad/glad.h"
+#include "Texture/DdsFile.h"
+#include "Texture/TextureImage.h"
+
+// S3TC 属于扩展（EXT_texture_compression_s3tc），glad 的核心头文件中没有这两个常量
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+class TextureStreamer {
+public:
+    // 解码后的图片：行优先、逐行紧密排列，每像素 channels 个字节
+    using Image = TextureImage;
+
+    // 解码 path；desiredChannels 为 0 时保留文件的通道数，否则转换为该通道数
+    using Decoder = std::function<bool(const std::string& path, int desiredChannels, Image& image)>;
+    // 立方体贴图每个面解码后的处理（在工作线程中执行），face 为 GL_TEXTURE_CUBE_MAP_POSITIVE_X 起的序号
+    using FaceTransform = std::function<void(int face, Image& image)>;
+
+    unsigned char placeholder[4] = { 128, 128, 128, 255 }; // 占位颜色 (RGBA)
+    size_t uploadBudget = 32u << 20;                       // 每次 update 最多上传的字节数（至少上传一个纹理）
+
+    // threads 为 0 时使用 (硬件线程数 - 1) 个工作线程（至少 1 个）
+    explicit TextureStreamer(Decoder decoder, unsigned int threads = 0) : decode(std::move(decoder)) {
+        if (threads == 0) {
+            const unsigned int hardware = std::thread::hardware_concurrency();
+            threads = hardware > 1 ? hardware - 1 : 1;
+        }
+        for (unsigned int i = 0; i < threads; ++i) {
+            workers.emplace_back(&TextureStreamer::run, this);
+        }
+    }
+
+    ~TextureStreamer() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    // 请求一张二维纹理，立即返回（已填入占位颜色的）纹理 ID
+    GLuint load2D(const std::string& path, GLenum wrapMode, bool mipmaps = true) {
+        auto job = std::make_unique<Job>();
+        job->target = GL_TEXTURE_2D;
+        job->paths.push_back(path);
+        job->mipmaps = mipmaps;
+
+        glGenTextures(1, &job->texture);
+        glBindTexture(GL_TEXTURE_2D, job->texture);
+        uploadPlaceholder(GL_TEXTURE_2D);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapMode);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapMode);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return submit(std::move(job));
+    }
+
+    // 请求一张立方体贴图（RGB，无 mipmap）。faces 按 +X, -X, +Y, -Y, +Z, -Z 排列，
+    // 空路径的面填黑色；所有面须为同样大小的正方形
+    GLuint loadCubemap(const std::vector<std::string>& faces, FaceTransform transform = nullptr) {
+        auto job = std::make_unique<Job>();
+        job->paths = faces;
+        job->paths.resize(6);
+        job->transform = std::move(transform);
+        return submitCubemap(std::move(job));
+    }
+
+    // 请求一张预压缩的立方体贴图（含 6 个面的 .dds 文件）
+    GLuint loadCubemap(const std::string& ddsPath) {
+        auto job = std::make_unique<Job>();
+        job->paths.push_back(ddsPath);
+        return submitCubemap(std::move(job));
+    }
+
+    // 上传已解码的纹理（GL 线程，每帧一次），返回本次完成的纹理数
+    int update() {
+        std::vector<std::unique_ptr<Job>> ready;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            size_t bytes = 0;
+            while (!decoded.empty() && (ready.empty() || bytes + decoded.front()->data.size() <= uploadBudget)) {
+                bytes += decoded.front()->data.size();
+                ready.push_back(std::move(decoded.front()));
+                decoded.pop_front();
+            }
+        }
+        for (const auto& job : ready) {
+            upload(*job);
+        }
+        outstanding -= static_cast<int>(ready.size());
+        return static_cast<int>(ready.size());
+    }
+
+    // 尚未上传完成的纹理数
+    int pending() const { return outstanding; }
+
+private:
+    // mipmap 链中的一张图（立方体贴图每个面各一张）
+    struct Level {
+        GLenum target;
+        int level, width, height;
+        size_t offset, size;
+    };
+
+    struct Job {
+        GLuint texture = 0;
+        GLenum target = GL_TEXTURE_2D;
+        std::vector<std::string> paths;
+        bool mipmaps = false;
+        FaceTransform transform;
+        // 以下由工作线程填写
+        bool ok = false;
+        int channels = 0;
+        GLenum compressedFormat = 0;     // 非 0 时 data 为压缩块
+        std::vector<unsigned char> data; // 所有 Level 依次紧密排列
+        std::vector<Level> levels;
+    };
+
+    Decoder decode;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::unique_ptr<Job>> queued;  // 等待解码
+    std::deque<std::unique_ptr<Job>> decoded; // 等待上传
+    int outstanding = 0;                      // 只在 GL 线程读写
+    bool stopping = false;
+    GLuint pixelBuffer = 0;
+    std::vector<std::thread> workers; // 须最后构造
+
+    GLuint submitCubemap(std::unique_ptr<Job> job) {
+        job->target = GL_TEXTURE_CUBE_MAP;
+        glGenTextures(1, &job->texture);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, job->texture);
+        for (int face = 0; face < 6; ++face) {
+            uploadPlaceholder(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face);
+        }
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+        return submit(std::move(job));
+    }
+
+    GLuint submit(std::unique_ptr<Job> job) {
+        const GLuint texture = job->texture;
+        ++outstanding;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queued.push_back(std::move(job));
+        }
+        wake.notify_one();
+        return texture;
+    }
+
+    void uploadPlaceholder(GLenum target) const {
+        glTexImage2D(target, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+        if (target == GL_TEXTURE_2D) glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, 0);
+    }
+
+    void run() {
+        for (;;) {
+            std::unique_ptr<Job> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || !queued.empty(); });
+                if (stopping) return;
+                job = std::move(queued.front());
+                queued.pop_front();
+            }
+
+            job->ok = job->target == GL_TEXTURE_CUBE_MAP ? prepareCubemap(*job) : prepare2D(*job);
+            if (!job->ok) {
+                job->data.clear();
+                job->data.shrink_to_fit();
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            decoded.push_back(std::move(job));
+        }
+    }
+
+    static bool isDds(const std::string& path) {
+        return path.size() >= 4 && (path.compare(path.size() - 4, 4, ".dds") == 0 || path.compare(path.size() - 4, 4, ".DDS") == 0);
+    }
+
+    // 读取预压缩的纹理；faces 为期望的面数
+    static bool prepareDds(Job& job, int faces) {
+        DdsTexture dds;
+        if (!readDds(job.paths[0], dds) || dds.faces != faces) {
+            std::cerr << "Compressed texture failed to load: " << job.paths[0] << std::endl;
+            return false;
+        }
+        static const GLenum formats[3] = { GL_COMPRESSED_RGB_S3TC_DXT1_EXT, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, GL_COMPRESSED_RG_RGTC2 };
+        job.compressedFormat = formats[static_cast<int>(dds.format)];
+        const int levels = job.target == GL_TEXTURE_2D && !job.mipmaps ? 1 : dds.levels;
+        for (int face = 0; face < faces; ++face) {
+            const GLenum target = faces == 6 ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : GL_TEXTURE_2D;
+            for (int level = 0; level < levels; ++level) {
+                job.levels.push_back({ target, level, dds.levelWidth(level), dds.levelHeight(level),
+                                       dds.offset(face, level), dds.levelSize(level) });
+            }
+        }
+        job.data = std::move(dds.data);
+        std::cout << "Compressed texture loaded: " << job.paths[0] << ", width: " << dds.width << ", height: " << dds.height
+                  << ", levels: " << levels << std::endl;
+        return true;
+    }
+
+    bool prepare2D(Job& job) const {
+        if (isDds(job.paths[0])) return prepareDds(job, 1);
+        Image image;
+        if (!decode(job.paths[0], 0, image) || image.channels < 1 || image.channels > 4) {
+            std::cerr << "Texture failed to load: " << job.paths[0] << std::endl;
+            return false;
+        }
+        job.channels = image.channels;
+        job.data = std::move(image.pixels);
+
+        // 在 data 末尾依次追加各级 mipmap
+        int width = image.width, height = image.height;
+        size_t offset = 0;
+        job.levels.push_back({ GL_TEXTURE_2D, 0, width, height, 0, job.data.size() });
+        for (int level = 1; job.mipmaps && (width > 1 || height > 1); ++level) {
+            const int w = std::max(width / 2, 1), h = std::max(height / 2, 1);
+            const size_t next = job.data.size();
+            job.data.resize(next + static_cast<size_t>(w) * h * job.channels);
+            downsampleBox(job.data.data() + offset, width, height, job.channels, job.data.data() + next, w, h);
+            job.levels.push_back({ GL_TEXTURE_2D, level, w, h, next, job.data.size() - next });
+            width = w;
+            height = h;
+            offset = next;
+        }
+        std::cout << "Texture loaded: " << job.paths[0] << ", width: " << image.width << ", height: " << image.height
+                  << ", components: " << job.channels << ", levels: " << job.levels.size() << std::endl;
+        return true;
+    }
+
+    bool prepareCubemap(Job& job) const {
+        if (job.paths.size() == 1) return prepareDds(job, 6);
+        Image faces[6];
+        int size = 0;
+        for (int face = 0; face < 6; ++face) {
+            if (job.paths[face].empty()) continue;
+            Image& image = faces[face];
+            if (!decode(job.paths[face], 3, image) || image.width != image.height || (size != 0 && image.width != size)) {
+                std::cerr << "Cubemap face failed to load: " << job.paths[face] << std::endl;
+                return false;
+            }
+            size = image.width;
+            if (job.transform) job.transform(face, image);
+        }
+        if (size == 0) return false;
+
+        job.channels = 3;
+        const size_t faceBytes = static_cast<size_t>(size) * size * 3;
+        job.data.assign(faceBytes * 6, 0); // 空路径的面保持黑色
+        for (int face = 0; face < 6; ++face) {
+            if (!faces[face].pixels.empty()) {
+                std::memcpy(job.data.data() + faceBytes * face, faces[face].pixels.data(), faceBytes);
+            }
+            job.levels.push_back({ static_cast<GLenum>(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face), 0, size, size, faceBytes * face, faceBytes });
+        }
+        std::cout << "Cubemap loaded, face size: " << size << std::endl;
+        return true;
+    }
+
+    // 经 PBO 上传整条链：重新分配缓冲存储（orphan）避免等待上一次上传，映射失败时直接从内存上传
+    void upload(const Job& job) {
+        if (!job.ok) return;
+        static const GLenum formats[4] = { GL_RED, GL_RG, GL_RGB, GL_RGBA };
+        static const GLint internalFormats[4] = { GL_R8, GL_RG8, GL_RGB8, GL_RGBA8 };
+        const GLenum format = job.compressedFormat ? 0 : formats[job.channels - 1];
+        const GLint internalFormat = job.compressedFormat ? 0 : internalFormats[job.channels - 1];
+
+        if (pixelBuffer == 0) glGenBuffers(1, &pixelBuffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(job.data.size()), nullptr, GL_STREAM_DRAW);
+        void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(job.data.size()),
+                                        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (mapped) {
+            std::memcpy(mapped, job.data.data(), job.data.size());
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        } else {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glBindTexture(job.target, job.texture);
+        for (const Level& level : job.levels) {
+            // 绑定 PBO 时像素指针是缓冲内的偏移
+            const void* pixels = mapped ? reinterpret_cast<const void*>(level.offset) : job.data.data() + level.offset;
+            if (job.compressedFormat) {
+                glCompressedTexImage2D(level.target, level.level, job.compressedFormat, level.width, level.height, 0,
+                                       static_cast<GLsizei>(level.size), pixels);
+            } else {
+                glTexImage2D(level.target, level.level, internalFormat, level.width, level.height, 0,
+                             format, GL_UNSIGNED_BYTE, pixels);
+            }
+        }
+        if (job.target == GL_TEXTURE_2D) {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, job.levels.back().level);
+        }
+        glBindTexture(job.target, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+};
+
+#endif // TEXTURE_STREAMER_H
@@ -6,8 +6,18 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 #include "Shader/Shader.h"
+#include "Shader/ShaderVariants.h"
+#include "Shader/UniformBuffer.h"
 #include "camera_class/camera.h"
-#include "Mesh/Mesh.h"
+#include "Terrain/HeightField.h"
+#include "Terrain/HeightmapSource.h"
+#include "Terrain/TerrainGenerator.h"
+#include "Terrain/TerrainMesh.h"
+#include "Terrain/TileStore.h"
+#include "Terrain/CDLODTerrain.h"
+#include "Terrain/TerrainQuery.h"
+#include "Terrain/WaterReflection.h"
+#include "Texture/TextureStreamer.h"
 #include <iostream>
 #include <vector>
 #include <string>
@@ -26,25 +36,81 @@
 
 using namespace std;
 
-// 该函数声明用于加载单个纹理。
-// 输入参数：纹理文件路径和纹理的环绕模式（如 GL_CLAMP_TO_EDGE 或 GL_REPEAT）
-// 返回值：加载的纹理的ID。
-unsigned int load_single_texture(char const * path, GLuint WRAP_MODE);
+// 该函数声明用于解码一张图片（stb_image），供纹理加载线程调用。
+// 输入参数：图片路径和期望的通道数（0 表示保留文件的通道数）
+// 返回值：是否成功。
+bool decode_image(const std::string &path, int desiredChannels, TextureStreamer::Image &image);
+
+// 天空盒的五个面（后、右、前、左、上）换成立方体贴图的面顺序（+X, -X, +Y, -Y, +Z, -Z）；
+// 底面（水面）不绘制，留空填黑色，只为满足完整性
+std::vector<std::string> skybox_cube_faces(const std::vector<std::string> &skyboxFiles);
+
+// 天空盒除顶面外各面旋转 180 度（像素整体逆序），加载图片与离线压缩时都要做
+void rotate_skybox_face(int face, TextureStreamer::Image &image);
+
+// 预压缩纹理的路径：图片换成 .dds 扩展名；天空盒为所在目录下的 SkyBox.dds
+std::string dds_path(const std::string &file);
+std::string skybox_dds_path(const std::vector<std::string> &skyboxFiles);
+
+// dds 存在且不比任何一个源图片旧时返回 true
+bool dds_is_fresh(const std::string &dds, const std::vector<std::string> &sources);
+
+// 离线压缩（不创建窗口，不需要 GPU）：inputs 为 1 张图片或立方体贴图的 6 个面（空路径为黑色面），
+// format 为 "bc1" / "bc3" / "bc5"，为空时按通道数选择（有 alpha 用 BC3，否则 BC1）
+bool compress_texture(const std::vector<std::string> &inputs, const std::string &output, bool mipmaps,
+                      const std::string &format, const TextureStreamer::FaceTransform &transform = nullptr);
+
+// 着色器中 Camera uniform块的 C++ 布局（std140）
+struct CameraUniforms {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec3 viewPos;
+    float padding;
+};
 
 class TerrainEngine {
 private:
     GLuint skyboxVAO, skyboxVBO;
-    GLuint skyBox_Textures[5]; // 天空盒纹理数组
+    GLuint skyBox_Cubemap; // 天空盒立方体贴图
     GLuint water_Texture; // 水面纹理
     GLuint landTex, detailTex; // 地面纹理和细节纹理
     Shader skyShader, waterShader; // 天空盒和水面着色器
 
     float cloudSpeed = 0.01, waterSpeed = 0.3f, waterAlpha = 0.56f, waterScale = 0.3f; // 水面的相关参数
 
-    Mesh landMesh; // 地形网格对象，需要实现zyMesh类，来处理地形的顶点和网格
+    HeightField landField;   // 高度场（只在由图片加载时保留）
+    TileStore landTiles;     // 分块高度数据：瓦片文件内存映射，或由图片在内存中构建
+    CDLODTerrain landLOD;    // 分块四叉树地形，按相机距离选择细节级别
+    TerrainQuery landQuery;  // 地面高度与射线查询（相机碰撞等）
+    WaterReflection reflection; // 水面反射纹理（降分辨率、可隔帧更新）
+    TextureStreamer textures;   // 纹理在后台线程解码，数据到达前显示占位颜色
+
+    static const GLuint CAMERA_BINDING = 0; // Camera uniform块的绑定点
+    UniformBuffer cameraBuffer;  // 各程序共享的相机矩阵
+    CameraUniforms cameraData{}; // 上一次上传的内容，相同时不再上传
+
+    // 设置本通道的相机：与上一次相同时不上传（反射通道与主通道各上传一次）
+    void setCamera(const glm::mat4 &view, const glm::mat4 &proj);
+
+    // 程序创建或热重载后：绑定 Camera uniform块，设置固定的纹理单元
+    void setupSkyShader(Shader &shader) const;
+    void setupWaterShader(Shader &shader) const;
+    void setupLandShader(Shader &shader) const;
 
 public:
-    Shader landShader; // 地形着色器
+    // 每帧的剔除统计
+    struct CullReport {
+        CDLODTerrain::CullStats land;       // 地面
+        CDLODTerrain::CullStats reflection; // 反射通道的地面（本帧未重绘反射时为 0）
+        bool waterVisible = false;          // 水面是否在视锥内（不可见时跳过反射通道）
+    };
+
+    ShaderVariants landShaders; // 地形着色器（变体：FLAT_SHADING）
+    bool flatShading = false;   // 地面使用平直着色（每个三角形一个法线）
+    glm::vec3 lightDir = glm::vec3(1.0f); // 平行光方向（指向光源，世界坐标）
+    CullReport cullReport;
+    bool exportLandObj = false; // 调试用：把生成的地形另存为 ./resource/land.obj
+    bool writeLandTiles = false; // 预处理：把高度图另存为 <高度图>.tiles，之后可直接加载该瓦片文件
 
     // 常量：天空盒的顶点数量和属性步幅
     static const GLsizei skyBox_verts_num = 36; 
@@ -59,20 +125,38 @@ public:
     void loadTextures(std::vector<std::string> skyboxFiles, std::string waterFile, 
                        std::string landFile, std::string detailFile, std::string heightMapFile);
 
-    // 渲染天空盒
+    // 渲染天空盒（深度固定在远平面，须在不透明物体之后绘制）
     void drawSkybox(glm::mat4 const &model, glm::mat4 const &view, glm::mat4 const &proj, float deltaTime);
 
     // 渲染水面
     void drawWater(const glm::mat4 &model, const glm::mat4 &view, const glm::mat4 &proj, const Camera &camera, float deltaTime);
 
-    // 渲染地形
-    void drawLand(glm::mat4 const &model, glm::mat4 const &view, glm::mat4 const &proj, bool isUp);
+    // 渲染地形；isReflection 时 view 为关于水面镜像的视图矩阵
+    void drawLand(glm::mat4 const &model, glm::mat4 const &view, glm::mat4 const &proj, bool isReflection);
+
+    // 地面高度与射线查询（世界坐标，变换在主通道 drawLand 时更新）
+    const TerrainQuery &terrainQuery() const { return landQuery; }
+
+    // 反射质量：分辨率档位与更新间隔
+    WaterReflection::Settings &reflectionSettings() { return reflection.settings; }
 
     // 处理窗口大小变化时的回调函数
     void framebufferSizeCallback(GLFWwindow* window, int width, int height);
 
-    // 加载高度图并生成地形
-    std::string loadHeightMap(std::string &hmapFile);
+    // 加载高度图并生成地形网格
+    bool loadHeightMap(std::string &hmapFile);
+
+    // 输出本帧的剔除统计
+    void printCullReport() const;
+
+    // 上传后台线程解码好的纹理（每帧调用），返回尚未完成的纹理数
+    int uploadTextures() {
+        textures.update();
+        return textures.pending();
+    }
+
+    // 重新编译源码有修改的着色器（热重载），返回成功重载的程序数
+    int reloadShaders();
 };
 
 
@@ -127,76 +211,137 @@ const float TerrainEngine::cubeVertices[TerrainEngine::skyBox_attrib_stride * Te
 };
 
 
-// 该函数加载指定文件的高度图，处理数据生成地形的顶点位置和索引，并将这些数据写入一个OBJ文件。
-// 函数返回生成的OBJ文件路径。
-std::string TerrainEngine::loadHeightMap(std::string &hmapFile) {
-    float max_height = 255.0f;
-    int width, height, nChannels;
+// 该函数加载指定文件的高度图，构建地形四叉树（各级节点的高度范围）。
+// .tiles 文件（TileStore 预处理结果）直接内存映射，瓦片在绘制时由后台线程按需读取；
+// 原始 DEM（16 位 / 浮点，见 HeightmapSource）第一次加载时逐行预处理成 <文件>.tiles，之后直接映射该文件
+// （DEM 或 .meta 比瓦片文件新、或尺寸与取值配置不一致时重新预处理）；
+// 图片（8 位或 16 位）则整张读入后在内存中构建同样的瓦片布局。
+// .gen 为程序化地形配置（见 TerrainGenerator），生成结果写入 <文件>.tiles，配置更新后重新生成。
+// 只有 exportLandObj 打开时才生成整张分辨率的网格并另存为 OBJ。
+bool TerrainEngine::loadHeightMap(std::string &hmapFile) {
+    const std::string tileSuffix = ".tiles";
+    auto openTiles = [this](const std::string& path) {
+        if (!landTiles.open(path) || !landLOD.build(landTiles) || !landQuery.build(landTiles)) {
+            return false;
+        }
+        std::cout << "width: " << landTiles.width() << " height: " << landTiles.height()
+                  << " levels: " << landTiles.levelCount() << std::endl;
+        return true;
+    };
+    // 瓦片文件存在且不早于所有源文件（不存在的源文件忽略，如缺省的 .meta）
+    auto newerThanSources = [](const std::string& tilesFile, std::initializer_list<std::string> sources) {
+        std::error_code error;
+        const auto tilesTime = std::filesystem::last_write_time(tilesFile, error);
+        if (error) return false;
+        for (const std::string& source : sources) {
+            const auto sourceTime = std::filesystem::last_write_time(source, error);
+            if (!error && sourceTime > tilesTime) return false;
+        }
+        return true;
+    };
+    if (hmapFile.size() > tileSuffix.size() && hmapFile.compare(hmapFile.size() - tileSuffix.size(), tileSuffix.size(), tileSuffix) == 0) {
+        return openTiles(hmapFile);
+    }
 
-    // 加载高度图文件
-    unsigned char *raw_data_char = stbi_load(hmapFile.c_str(), &width, &height, &nChannels, 1);
-    if (raw_data_char == NULL) {
-        printf("Error: invalid heightmap!\n");
+    const std::string genSuffix = ".gen";
+    if (hmapFile.size() > genSuffix.size() && hmapFile.compare(hmapFile.size() - genSuffix.size(), genSuffix.size(), genSuffix) == 0) {
+        TerrainGenSettings settings;
+        if (!settings.load(hmapFile)) {
+            return false;
+        }
+        // 生成结果只取决于配置，瓦片文件比配置新且尺寸一致时直接使用
+        const std::string tilesFile = hmapFile + tileSuffix;
+        const bool upToDate = newerThanSources(tilesFile, { hmapFile }) && landTiles.open(tilesFile) &&
+                              landTiles.width() == settings.width && landTiles.height() == settings.height;
+        landTiles.close();
+        if (!upToDate) {
+            std::cout << "Generating " << tilesFile << " ..." << std::endl;
+            if (!TerrainGenerator(settings).writeTiles(tilesFile)) {
+                return false;
+            }
+        }
+        return openTiles(tilesFile);
     }
 
-    std::cout << "width: " << width << " height: " << height << std::endl;
-    
-    float max_x = (float)width, max_y = (float)height;
-    
-    std::vector<float> land_pos;
-    std::vector<unsigned int> land_indices;
-    std::string objName = "./resource/land.obj";
-    
-    FILE *fid = fopen(objName.c_str(), "w+");
-    unsigned tri_cnt = 0;
-
-    // 遍历高度图的每个像素，生成对应的顶点位置
-    for (int row = 0; row < height; row++) {
-        for (int col = 0; col < width; col++) {
-            land_pos.push_back((float)row / max_y);
-            land_pos.push_back((float)((int)raw_data_char[row * width + col]) / max_height);  // 注意计算方式 row * width + col
-            land_pos.push_back((float)col / max_x);
-            fprintf(fid, "v %f %f %f\n", land_pos[3 * tri_cnt], land_pos[3 * tri_cnt + 1], land_pos[3 * tri_cnt + 2]);
-            tri_cnt++;
+    HeightmapSource source;
+    if (HeightmapSource::isRawPath(hmapFile)) {
+        if (!source.openRaw(hmapFile)) {
+            printf("Error: invalid heightmap!\n");
+            return false;
+        }
+        // 瓦片文件比 DEM 与 .meta 新、且尺寸、竖直配置与取值映射（min / max / nodata）一致时直接使用，
+        // 否则先预处理（源数据不整体进入内存）
+        const std::string tilesFile = hmapFile + tileSuffix;
+        const HeightmapMeta& meta = source.meta();
+        TileStore::SourceRange range;
+        range.minValue = meta.minValue;
+        range.maxValue = meta.maxValue;
+        range.hasNoData = meta.hasNoData ? 1u : 0u;
+        range.noData = meta.noData;
+        const bool upToDate = newerThanSources(tilesFile, { hmapFile, hmapFile + ".meta" }) && landTiles.open(tilesFile) &&
+                              landTiles.width() == source.width() && landTiles.height() == source.height() &&
+                              landTiles.vertical().scale == meta.vertical.scale &&
+                              landTiles.vertical().offset == meta.vertical.offset && landTiles.sourceRange() == range;
+        landTiles.close();
+        if (!upToDate) {
+            std::cout << "Building " << tilesFile << " ..." << std::endl;
+            if (!TileStore::build(tilesFile, source.width(), source.height(), meta.vertical, range, source.rowReader())) {
+                return false;
+            }
         }
+        return openTiles(tilesFile);
     }
 
-    std::cout << "Height map loaded." << std::endl;
+    int width, height, nChannels;
 
-    // 生成地形的索引数据
-    tri_cnt = 0;
-    for (int row = 0; row < height - 1; row++) {
-        for (int col = 0; col < width - 1; col++) {
-            // 生成两个三角形，形成一个矩形
-            land_indices.push_back(row * width + col);
-            land_indices.push_back(row * width + col + 1);
-            land_indices.push_back((row + 1) * width + col + 1);
-            fprintf(fid, "f %u %u %u\n", land_indices[3 * tri_cnt] + 1, land_indices[3 * tri_cnt + 1] + 1, land_indices[3 * tri_cnt + 2] + 1);
-            tri_cnt++;
-
-            // 第二个三角形
-            land_indices.push_back((row + 1) * width + col + 1);
-            land_indices.push_back((row + 1) * width + col);
-            land_indices.push_back(row * width + col);
-            fprintf(fid, "f %u %u %u\n", land_indices[3 * tri_cnt] + 1, land_indices[3 * tri_cnt + 1] + 1, land_indices[3 * tri_cnt + 2] + 1);
-            tri_cnt++;
-        }
+    // 加载高度图文件（16 位图片保留全部精度）
+    const bool is16Bit = stbi_is_16_bit(hmapFile.c_str()) != 0;
+    void *pixels = is16Bit ? static_cast<void*>(stbi_load_16(hmapFile.c_str(), &width, &height, &nChannels, 1))
+                           : static_cast<void*>(stbi_load(hmapFile.c_str(), &width, &height, &nChannels, 1));
+    if (pixels == NULL) {
+        printf("Error: invalid heightmap!\n");
+        return false;
     }
-    
-    fclose(fid);
 
+    std::cout << "width: " << width << " height: " << height << (is16Bit ? " (16-bit)" : "") << std::endl;
+
+    const bool attached = source.attachImage(hmapFile, pixels, width, height, is16Bit);
+    if (attached) {
+        landField = source.toField();
+    }
+    stbi_image_free(pixels);
+    if (!attached) {
+        return false;
+    }
+
+    if (writeLandTiles) {
+        TileStore::build(hmapFile + tileSuffix, landField);
+    }
+    if (!landTiles.buildInMemory(landField) || !landLOD.build(landTiles) || !landQuery.build(landTiles)) {
+        return false;
+    }
     std::cout << "Height map loaded." << std::endl;
 
-    return objName;  // 返回生成的OBJ文件路径
+    if (exportLandObj) {
+        TerrainMesh landMesh;
+        landMesh.build(landField);
+        landMesh.exportObj("./resource/land.obj");
+    }
+    return true;
 }
 
 // 该构造函数初始化天空盒、地形、和水面等相关着色器，并生成对应的VAO和VBO。
 // 该过程会加载着色器程序和纹理，用于渲染不同的地形和水面效果。
 TerrainEngine::TerrainEngine(std::string skybox_vs, std::string skybox_fs, std::string water_vs, std::string water_fs,
                              std::string land_vs, std::string land_fs) :
-    skyBox_Textures{0}, skyShader(skybox_vs.c_str(), skybox_fs.c_str()), waterShader(water_vs.c_str(), water_fs.c_str()),
-    landShader(land_vs.c_str(), land_fs.c_str()) {
-
+    skyBox_Cubemap(0), skyShader(skybox_vs.c_str(), skybox_fs.c_str()), waterShader(water_vs.c_str(), water_fs.c_str()),
+    textures(decode_image), landShaders(land_vs, land_fs) {
+
+    // 天空盒与水面的程序已在初始化列表中提交编译与链接，地形的默认变体也先只提交，
+    // 三个程序都在编译中时才开始等待（下面 setup 中的 bindUniformBlock 会等待链接完成），驱动可以同时编译；
+    // 地形的 FLAT_SHADING 变体第一次用到时再编译
+    landShaders.setup = [this](Shader &shader) { setupLandShader(shader); };
+    landShaders.request();
     std::cout << "Shaders loaded." << std::endl;
 
     // Generate VAO, VBO for skybox
@@ -231,89 +376,176 @@ TerrainEngine::TerrainEngine(std::string skybox_vs, std::string skybox_fs, std::
     glBindVertexArray(0);
 
     std::cout << "Skybox VAO and VBO set up." << std::endl;
+
+    // 相机矩阵放在共享的 UBO 中，每个通道只上传一次
+    cameraBuffer.create(sizeof(CameraUniforms), CAMERA_BINDING);
+    setupSkyShader(skyShader);
+    setupWaterShader(waterShader);
+    landShaders.get();
+    glUseProgram(0);
+}
+
+// 纹理单元固定不变，只在程序创建与重载后设置
+void TerrainEngine::setupSkyShader(Shader &shader) const {
+    shader.bindUniformBlock("Camera", CAMERA_BINDING);
+    shader.use();
+    shader.setInt("skybox", 0);
+}
+
+void TerrainEngine::setupWaterShader(Shader &shader) const {
+    shader.bindUniformBlock("Camera", CAMERA_BINDING);
+    shader.use();
+    shader.setInt("texture", 0);
+    shader.setInt("reflection_Texture", 1);
+}
+
+void TerrainEngine::setupLandShader(Shader &shader) const {
+    shader.bindUniformBlock("Camera", CAMERA_BINDING);
+    shader.use();
+    shader.setInt("land_Texture", 0);
+    shader.setInt("detail_Texture", 1);
+}
+
+int TerrainEngine::reloadShaders() {
+    int reloaded = 0;
+    if (skyShader.reloadIfChanged()) {
+        setupSkyShader(skyShader);
+        ++reloaded;
+    }
+    if (waterShader.reloadIfChanged()) {
+        setupWaterShader(waterShader);
+        ++reloaded;
+    }
+    reloaded += landShaders.reloadIfChanged();
+    glUseProgram(0);
+    return reloaded;
+}
+
+void TerrainEngine::setCamera(const glm::mat4 &view, const glm::mat4 &proj) {
+    if (view == cameraData.view && proj == cameraData.projection) {
+        return;
+    }
+    cameraData.view = view;
+    cameraData.projection = proj;
+    cameraData.viewPos = glm::vec3(glm::inverse(view)[3]);
+    cameraBuffer.update(&cameraData, sizeof(CameraUniforms));
 }
 
 void TerrainEngine::loadTextures(std::vector<std::string> skyboxFiles, std::string waterFile,
                                   std::string landFile, std::string detailFile, std::string heightMapFile) {
     // 确保天空盒文件路径数量为5个
     assert(skyboxFiles.size() == 5);
-    for (unsigned i = 0; i < skyboxFiles.size(); i++) {
-        std::cout << "Loading skybox texture: " << skyboxFiles[i].c_str() << std::endl;
-        skyBox_Textures[i] = load_single_texture(skyboxFiles[i].c_str(), GL_CLAMP_TO_EDGE);
-        assert(skyBox_Textures[i] != 0);
-        if (skyBox_Textures[i] == 0) {
-            std::cerr << "Failed to load texture: " << skyboxFiles[i] << std::endl;
-        } else {
-            std::cout << "Loaded texture: " << skyboxFiles[i] << " with ID: " << skyBox_Textures[i] << std::endl;
-        }
-    }
+    // 有预压缩的纹理（--compress-textures 生成，且不比源图片旧）时直接上传压缩块，否则解码图片
+    const std::string skyboxDds = skybox_dds_path(skyboxFiles);
+    skyBox_Cubemap = dds_is_fresh(skyboxDds, skyboxFiles) ? textures.loadCubemap(skyboxDds)
+                                                          : textures.loadCubemap(skybox_cube_faces(skyboxFiles), rotate_skybox_face);
+
+    // 加载水面、地面和细节纹理（后台解码，下面读取高度图的同时进行）
+    auto preferCompressed = [](const std::string &file) {
+        return dds_is_fresh(dds_path(file), { file }) ? dds_path(file) : file;
+    };
+    water_Texture = textures.load2D(preferCompressed(waterFile), GL_REPEAT);
+    landTex = textures.load2D(preferCompressed(landFile), GL_CLAMP_TO_EDGE);
+    detailTex = textures.load2D(preferCompressed(detailFile), GL_CLAMP_TO_EDGE);
 
-    // 加载水面纹理
-    water_Texture = load_single_texture(waterFile.c_str(), GL_REPEAT);
-    assert(water_Texture != 0);
+    std::cout << "before load_height_map" << std::endl;
 
-    // 加载地面和细节纹理
-    landTex = load_single_texture(landFile.c_str(), GL_CLAMP_TO_EDGE);
-    detailTex = load_single_texture(detailFile.c_str(), GL_CLAMP_TO_EDGE);
-    assert(landTex != 0 && detailTex != 0);
+    // 获取并处理高度图，构建地形四叉树（地形纹理坐标在 land.vs 中由采样坐标计算）
+    if (loadHeightMap(heightMapFile)) {
+        std::cout << "landTiles.levelCount() = " << landTiles.levelCount() << std::endl;
 
-    std::cout << "before load_height_map" << std::endl;
+        // 上传共享网格与常驻瓦片，启动瓦片读取线程
+        landLOD.setupMesh();
+    }
+}
 
-    // 获取并处理高度图，生成地形网格数据
-    landMesh = Mesh(loadHeightMap(heightMapFile), false, false);  // 不设置纹理和法线
+// 该函数用于加载一个单一的纹理文件，并返回纹理ID。
+// 纹理参数指定纹理的环绕模式（如重复或夹紧）。
+bool decode_image(const std::string &path, int desiredChannels, TextureStreamer::Image &image) {
+    unsigned char *data = stbi_load(path.c_str(), &image.width, &image.height, &image.channels, desiredChannels);
+    if (!data) {
+        return false;
+    }
+    if (desiredChannels != 0) {
+        image.channels = desiredChannels;
+    }
+    image.pixels.assign(data, data + static_cast<size_t>(image.width) * image.height * image.channels);
+    stbi_image_free(data);
+    return true;
+}
 
-    std::cout << "landMesh.vertexList.size() = " << landMesh.vertices.size() << std::endl;
+std::vector<std::string> skybox_cube_faces(const std::vector<std::string> &skyboxFiles) {
+    return { skyboxFiles[1], skyboxFiles[3], skyboxFiles[4], "", skyboxFiles[2], skyboxFiles[0] };
+}
 
-    // 计算每个顶点的纹理坐标
-    for (size_t iv = 0; iv < landMesh.vertices.size(); iv++) {
-        // 根据地形的坐标计算纹理坐标
-        landMesh.vertices[iv].texCoords.x = landMesh.vertices[iv].position.z;
-        landMesh.vertices[iv].texCoords.y = landMesh.vertices[iv].position.x;
+void rotate_skybox_face(int face, TextureStreamer::Image &image) {
+    if (face == 2) return; // +Y
+    unsigned char *first = image.pixels.data(), *last = first + image.pixels.size() - 3;
+    for (; first < last; first += 3, last -= 3) {
+        std::swap_ranges(first, first + 3, last);
     }
+}
 
-    // 完成地形网格的设置
-    landMesh.setupMesh();
+std::string dds_path(const std::string &file) {
+    return std::filesystem::path(file).replace_extension(".dds").generic_string();
 }
 
-// 该函数用于加载一个单一的纹理文件，并返回纹理ID。
-// 纹理参数指定纹理的环绕模式（如重复或夹紧）。
-unsigned int load_single_texture(char const * path, GLuint WRAP_MODE) {
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
+std::string skybox_dds_path(const std::vector<std::string> &skyboxFiles) {
+    return (std::filesystem::path(skyboxFiles[0]).parent_path() / "SkyBox.dds").generic_string();
+}
 
-    int width, height, nrComponents;
-    unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
+bool dds_is_fresh(const std::string &dds, const std::vector<std::string> &sources) {
+    std::error_code error;
+    const auto ddsTime = std::filesystem::last_write_time(dds, error);
+    if (error) return false;
+    for (const std::string &source : sources) {
+        const auto sourceTime = std::filesystem::last_write_time(source, error);
+        if (!error && sourceTime > ddsTime) return false;
+    }
+    return true;
+}
 
-    if (data) {
-        std::cout << "Texture loaded: " << path << ", width: " << width << ", height: " << height << ", components: " << nrComponents << std::endl;
-    } else {
-        std::cout << "Texture failed to load: " << path << std::endl;
-    }
-
-    if (data) {
-        GLenum format;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, WRAP_MODE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, WRAP_MODE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        stbi_image_free(data);
-    } else {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
+bool compress_texture(const std::vector<std::string> &inputs, const std::string &output, bool mipmaps,
+                      const std::string &format, const TextureStreamer::FaceTransform &transform) {
+    const bool cubemap = inputs.size() == 6;
+    std::vector<TextureImage> faces(inputs.size());
+    int reference = -1; // 第一个非空的面，黑色面取它的大小
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (inputs[i].empty()) continue;
+        if (!decode_image(inputs[i], cubemap ? 3 : 0, faces[i])) {
+            std::cerr << "Texture failed to load: " << inputs[i] << std::endl;
+            return false;
+        }
+        if (transform) transform(static_cast<int>(i), faces[i]);
+        if (reference < 0) reference = static_cast<int>(i);
+    }
+    if (reference < 0) return false;
+    for (TextureImage &face : faces) {
+        if (face.pixels.empty()) {
+            face = faces[reference];
+            std::fill(face.pixels.begin(), face.pixels.end(), 0);
+        }
     }
 
-    return textureID;
+    BlockFormat blockFormat = faces[0].channels == 2 || faces[0].channels == 4 ? BlockFormat::BC3 : BlockFormat::BC1;
+    if (format == "bc1") blockFormat = BlockFormat::BC1;
+    else if (format == "bc3") blockFormat = BlockFormat::BC3;
+    else if (format == "bc5") blockFormat = BlockFormat::BC5;
+    else if (!format.empty()) {
+        std::cerr << "Unknown block format: " << format << std::endl;
+        return false;
+    }
+
+    DdsTexture dds;
+    if (!buildDds(faces, blockFormat, mipmaps, dds) || !writeDds(output, dds)) {
+        std::cerr << "Failed to write " << output << std::endl;
+        return false;
+    }
+    size_t sourceBytes = 0;
+    for (const TextureImage &face : faces) sourceBytes += face.pixels.size();
+    std::cout << "Compressed " << output << ": " << dds.width << "x" << dds.height << ", " << dds.faces << " face(s), "
+              << dds.levels << " level(s), " << dds.data.size() << " bytes (source level 0: " << sourceBytes << " bytes)" << std::endl;
+    return true;
 }
 
 void TerrainEngine::drawSkybox(glm::mat4 const & model, glm::mat4 const & view, glm::mat4 const & proj, float deltaTime) {
@@ -322,107 +554,126 @@ void TerrainEngine::drawSkybox(glm::mat4 const & model, glm::mat4 const & view,
     y_shift += deltaTime;  // 更新y轴云层偏移
     glm::vec3 transVec = glm::vec3(cloudSpeed) * glm::vec3(cos(x_shift), 0.0, cos(y_shift));  // 计算偏移向量
 
+    setCamera(view, proj);
     skyShader.use();
     skyShader.setMat4("model", glm::translate(model, transVec));  // 设置模型矩阵
-    skyShader.setMat4("view", view);  // 设置视图矩阵
-    skyShader.setMat4("projection", proj);  // 设置投影矩阵
-    skyShader.setInt("texture", 0);  // 设置纹理单元
 
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, skyBox_Cubemap);  // 绑定天空盒立方体贴图
+
+    // 天空盒深度为 1（见 skybox.vs），被地面、水面挡住的片段在深度测试中被提前丢弃
+    glDepthFunc(GL_LEQUAL);
+    glDepthMask(GL_FALSE);
     glBindVertexArray(skyboxVAO);  // 绑定Skybox VAO
-    for (unsigned i = 0; i < 5; i++) {
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, skyBox_Textures[i]);  // 绑定天空盒纹理
-        if (skyBox_Textures[i] == 0) {
-            std::cerr << "Error: Texture ID for face " << i << " is invalid." << std::endl;
-        }
-        glDrawArrays(GL_TRIANGLES, i * 6, 6);  // 绘制每个面
-        glBindTexture(GL_TEXTURE_2D, 0);  // 解绑纹理
-    }
+    glDrawArrays(GL_TRIANGLES, 0, 5 * 6);  // 一次绘制五个面（不含底面）
     glBindVertexArray(0);  // 解绑VAO
+    glDepthMask(GL_TRUE);
+    glDepthFunc(GL_LESS);
 }
 
 void TerrainEngine::drawWater(glm::mat4 const &model, glm::mat4 const &view, glm::mat4 const &proj, Camera const &camera, float deltaTime) {
-    const static glm::mat4 mirror_y({
-        {1, 0, 0, 0},
-        {0, -1, 0, 0},  // y轴翻转
-        {0, 0, 1, 0},
-        {0, 0, 0, 1}
-    });
-
-    // 计算镜像模型
-    const static glm::mat4 mirror_y_skybox_model = mirror_y * model;
-    const static glm::mat4 mirror_y_land_model = mirror_y * model;
-
-    // 启用深度测试
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);  // 默认深度测试模式
-
-    // 绘制天空盒（镜像）
-    drawSkybox(mirror_y_skybox_model, view, proj, deltaTime);
-
-    // 绘制地面（镜像）
-    drawLand(mirror_y_land_model, view, proj, false);
-
     // 动态水面效果
     static float x_shift = 0, y_shift = 0;
     x_shift += deltaTime * waterSpeed;  // 更新水面x轴位移
     y_shift += deltaTime * waterSpeed * 0.8f;  // 更新水面y轴位移
 
-    // 开启混合模式绘制水面
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);  // 设置混合模式
-    glDepthMask(GL_FALSE);  // 禁用深度写入
-
     glm::mat4 water_model = model;
     water_model[3][1] = 0.04 * 50.0f;  // 设置水面Y坐标
 
+    // 水面即天空盒底面；相机在水面之上且水面不在视锥内时看不到反射，跳过反射通道
+    AABB waterBounds = AABB{ glm::vec3(-0.5f, -0.5f, -0.5f), glm::vec3(0.5f, -0.5f, 0.5f) }.transformed(water_model);
+    cullReport.waterVisible = Frustum::fromMatrix(proj * view).intersects(waterBounds);
+    cullReport.reflection = CDLODTerrain::CullStats();
+    if (!cullReport.waterVisible && camera.Position.y > waterBounds.max.y) {
+        reflection.invalidate();
+        return;
+    }
+
+    // 反射通道：以关于水面镜像的视图矩阵把天空盒与地面画进反射纹理（水面以下的部分由裁剪平面去掉），
+    // 地面只选择镜像视锥内的节点
+    const float waterY = waterBounds.max.y;
+    const glm::mat4 reflectedView = view * WaterReflection::reflectionMatrix(waterY);
+    if (reflection.begin()) {
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_LESS);
+
+        drawLand(model, reflectedView, proj, true);
+
+        // 天空盒：镜像相机位于水面下方，把天空盒一并移到水面下方，使其仍包住相机；云层偏移只在主通道推进
+        drawSkybox(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 2.0f * waterY, 0.0f)) * model, reflectedView, proj, 0.0f);
+        reflection.end();
+    }
+
+    // 水面：按片段的屏幕坐标采样反射纹理，与水面纹理混合（不透明，写入深度，之后的天空盒在水面处被丢弃）
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);  // 默认深度测试模式
+
+    setCamera(view, proj);
     waterShader.use();
-    waterShader.setMat4("view", view);  // 设置视图矩阵
-    waterShader.setMat4("projection", proj);  // 设置投影矩阵
     waterShader.setMat4("model", water_model);  // 设置水面模型矩阵
     waterShader.setFloat("texture_scale", 10.0f);  // 设置纹理缩放
     waterShader.setFloat("xShift", waterScale * sin(x_shift));  // 设置水面x轴偏移
     waterShader.setFloat("yShift", waterScale * sin(y_shift));  // 设置水面y轴偏移
-    waterShader.setFloat("water_alpha", waterAlpha);  // 设置水面透明度
-    waterShader.setInt("texture", 0);  // 设置纹理单元
+    waterShader.setFloat("water_alpha", waterAlpha);  // 设置水面纹理所占比例
 
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, water_Texture);  // 绑定水面纹理
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, reflection.texture());  // 绑定反射纹理
+    glActiveTexture(GL_TEXTURE0);
 
     glBindVertexArray(skyboxVAO);  // 使用skyBox的VAO来绘制水面
     glDrawArrays(GL_TRIANGLES, 5 * 6, 6);  // 绘制水面
     glBindVertexArray(0);
-
-    // 关闭混合模式并恢复深度写入
-    glDepthMask(GL_TRUE);  // 启用深度写入
-    glDisable(GL_BLEND);
 }
 
-void TerrainEngine::drawLand(glm::mat4 const & model, glm::mat4 const & view, glm::mat4 const & proj, bool isUp) {
+void TerrainEngine::drawLand(glm::mat4 const & model, glm::mat4 const & view, glm::mat4 const & proj, bool isReflection) {
+    // 竖直缩放与偏移来自数据集配置
+    const float waterHeight = -0.46f;
+    const VerticalScale vertical = landTiles.vertical();
+    float offset = vertical.offset;
+    float clipHeight = waterHeight; // 水面以下的部分不绘制
+
+    // 按相机位置与视锥选择本帧要绘制的节点（反射通道用镜像相机与镜像视锥单独选择）。
+    // 整体低于裁剪高度的节点直接跳过；地平线剔除只用于主通道（镜像相机在地面下方）
+    glm::vec3 cameraPos = glm::vec3(glm::inverse(view)[3]);
+    const glm::mat4 localToWorld = model * CDLODTerrain::localTransform(vertical.scale, offset);
+    if (!isReflection) {
+        landQuery.setTransform(localToWorld);
+    }
+    landLOD.select(localToWorld, cameraPos, proj * view,
+                   (clipHeight - offset) / vertical.scale, !isReflection);
+    (isReflection ? cullReport.reflection : cullReport.land) = landLOD.cullStats();
+
+    setCamera(view, proj);
+    Shader &landShader = flatShading ? landShaders.get({ "FLAT_SHADING" }) : landShaders.get();
     landShader.use();
-    landShader.setFloat("heightScale", 0.05f);  // 设置地面高度缩放
+    landShader.setFloat("heightScale", vertical.scale);  // 设置地面高度缩放
     landShader.setMat4("model", model);  // 设置模型矩阵
-    landShader.setMat4("view", view);  // 设置视图矩阵
-    landShader.setMat4("projection", proj);  // 设置投影矩阵
-    
-    glBindVertexArray(landMesh.VAO);  // 绑定地面VAO
+    landShader.setVec3("lightDir", glm::normalize(lightDir));  // 设置光照方向
 
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, landTex);  // 绑定地面纹理
-    landShader.setInt("land_Texture", 0);  // 设置地面纹理单元
     glActiveTexture(GL_TEXTURE1);
     glBindTexture(GL_TEXTURE_2D, detailTex);  // 绑定细节纹理
-    landShader.setInt("detail_Texture", 1);  // 设置细节纹理单元
     landShader.setFloat("detail_scale", 30.0);  // 设置细节纹理的缩放
-    landShader.setBool("isUp", isUp);  // 设置是否是上面
-    if (isUp) {
-        landShader.setFloat("offset", -0.48f);  // 上面偏移
-    } else {
-        landShader.setFloat("offset", 0.44f);  // 下面偏移
-    }
-    
-    glDrawElements(GL_TRIANGLES, landMesh.indices.size(), GL_UNSIGNED_INT, 0);  // 绘制地面网格
-    glBindVertexArray(0);  // 解绑VAO
+    landShader.setFloat("offset", offset);
+    landShader.setFloat("clipHeight", clipHeight);
+
+    glEnable(GL_CLIP_DISTANCE0);
+    landLOD.draw(landShader);  // 一次实例化绘制所有选中的节点
+    glDisable(GL_CLIP_DISTANCE0);
+}
+
+void TerrainEngine::printCullReport() const {
+    auto printStats = [](const char* name, const CDLODTerrain::CullStats& stats) {
+        std::cout << name << ": tested " << stats.nodesTested << ", frustum " << stats.frustumCulled
+                  << ", below clip " << stats.heightCulled << ", horizon " << stats.horizonCulled
+                  << ", drawn " << stats.patchesDrawn << std::endl;
+    };
+    printStats("land", cullReport.land);
+    printStats("reflection", cullReport.reflection);
+    std::cout << "water: " << (cullReport.waterVisible ? "visible" : "culled") << std::endl;
 }
 
 // 窗口大小变化时的回调函数
@@ -461,6 +712,10 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos) {
 float deltaTime = 0.0f;  
 float lastFrame = 0.0f; 
 
+bool showCullReport = false; // 每秒输出一次剔除统计
+int reflectionDivisor = 2;   // 反射纹理分辨率：1 全分辨率，2 一半，4 四分之一
+bool flatShading = false;    // 地面平直着色 / 平滑着色
+
 // 键盘输入回调函数
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
 
@@ -470,6 +725,23 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
         glfwSetInputMode(window, GLFW_CURSOR, (cursorMode == GLFW_CURSOR_DISABLED) ? GLFW_CURSOR_NORMAL : GLFW_CURSOR_DISABLED);
     }
 
+    // 切换剔除统计输出
+    if (key == GLFW_KEY_C && action == GLFW_PRESS) {
+        showCullReport = !showCullReport;
+    }
+
+    // 切换反射分辨率（全 / 一半 / 四分之一）
+    if (key == GLFW_KEY_R && action == GLFW_PRESS) {
+        reflectionDivisor = reflectionDivisor >= 4 ? 1 : reflectionDivisor * 2;
+        std::cout << "Reflection resolution: 1/" << reflectionDivisor << std::endl;
+    }
+
+    // 切换地面平直着色 / 平滑着色（着色器变体）
+    if (key == GLFW_KEY_F && action == GLFW_PRESS) {
+        flatShading = !flatShading;
+        std::cout << "Land shading: " << (flatShading ? "flat" : "smooth") << std::endl;
+    }
+
     // 控制相机移动
     if (action == GLFW_PRESS || action == GLFW_REPEAT) {
         if (key == GLFW_KEY_W) camera.ProcessKeyboard(FORWARD, deltaTime);
@@ -486,7 +758,38 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
     camera.ProcessMouseScroll((float)yoffset);
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+
+    // 设置纹理加载时翻转（离线压缩的纹理同样翻转，上传时不再处理）
+    stbi_set_flip_vertically_on_load(true);
+
+    // 纹理文件
+    const std::vector<std::string> skyboxFiles = {
+        "./data/SkyBox/SkyBox0.bmp", "./data/SkyBox/SkyBox1.bmp",
+        "./data/SkyBox/SkyBox2.bmp", "./data/SkyBox/SkyBox3.bmp",
+        "./data/SkyBox/SkyBox4.bmp"
+    };
+    const std::string waterFile = "./data/SkyBox/SkyBox5.bmp";
+    const std::string landFile = "./data/terrain-texture3.bmp";
+    const std::string detailFile = "./data/detail.bmp";
+
+    // 离线压缩纹理，完成后退出（不创建窗口）：
+    //   --compress-textures                       把上面的纹理压缩为同名 .dds（天空盒为 SkyBox.dds）
+    //   --compress <图片> <输出.dds> [bc1|bc3|bc5]  压缩任意一张图片（含 mipmap）
+    if (argc > 1 && std::string(argv[1]) == "--compress-textures") {
+        bool ok = compress_texture(skybox_cube_faces(skyboxFiles), skybox_dds_path(skyboxFiles), false, "bc1", rotate_skybox_face);
+        for (const std::string &file : { waterFile, landFile, detailFile }) {
+            ok = compress_texture({ file }, dds_path(file), true, "") && ok;
+        }
+        return ok ? 0 : 1;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--compress") {
+        if (argc < 4) {
+            std::cerr << "用法: main --compress <图片> <输出.dds> [bc1|bc3|bc5]" << std::endl;
+            return 1;
+        }
+        return compress_texture({ argv[2] }, argv[3], true, argc > 4 ? argv[4] : "") ? 0 : 1;
+    }
 
     // 初始化GLFW
     if (!glfwInit()) {
@@ -494,9 +797,6 @@ int main() {
         return -1;
     }
 
-    // 设置纹理加载时翻转
-    stbi_set_flip_vertically_on_load(true);
-
     // 设置OpenGL版本（4.6）
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
@@ -551,21 +851,18 @@ int main() {
     std::cout << "TerrainEngine着色器创建成功！" << std::endl;
 
     // 加载纹理
-    std::vector<std::string> skyboxFiles = {
-        "./data/SkyBox/SkyBox0.bmp", "./data/SkyBox/SkyBox1.bmp",
-        "./data/SkyBox/SkyBox2.bmp", "./data/SkyBox/SkyBox3.bmp",
-        "./data/SkyBox/SkyBox4.bmp"
-    };
-    engine.loadTextures(skyboxFiles, "./data/SkyBox/SkyBox5.bmp", 
-                         "./data/terrain-texture3.bmp", "./data/detail.bmp", "./data/heightmap.bmp");
+    // 高度图可由命令行指定：图片、原始 DEM、.tiles 或程序化地形配置 .gen
+    const std::string heightMapFile = argc > 1 ? argv[1] : "./data/heightmap.bmp";
+    engine.loadTextures(skyboxFiles, waterFile, landFile, detailFile, heightMapFile);
 
-    std::cout << "纹理加载成功！" << std::endl;
+    std::cout << "纹理已提交后台加载，高度图加载成功！" << std::endl;
 
     glm::vec3 lightPos(0.2f, 0.2f, 0.2f);  // 设置光源位置
 
     // 设置目标FPS
     const float targetFPS = 30.0f;
     const float targetDeltaTime = 1.0f / targetFPS; // 每帧的时间
+    const float cameraClearance = 0.2f; // 相机与地面的最小距离（世界坐标）
 
     // 禁用面剔除，避免在渲染过程中遮挡
     glDisable(GL_CULL_FACE);     // 禁用面剔除
@@ -579,6 +876,13 @@ int main() {
     std::cout << "空格键 - 向上移动" << std::endl;
     std::cout << "左Shift - 向下移动" << std::endl;
     std::cout << "P - 切换光标模式" << std::endl;
+    std::cout << "C - 切换剔除统计输出" << std::endl;
+    std::cout << "R - 切换反射分辨率" << std::endl;
+    std::cout << "F - 切换地面平直着色 / 平滑着色" << std::endl;
+    std::cout << "（着色器文件保存后自动重新加载）" << std::endl;
+
+    // 反射质量：低端设备可改为四分之一分辨率、每 2 ~ 3 帧更新一次
+    engine.reflectionSettings().updateInterval = 1;
 
 
     // 主渲染循环
@@ -597,6 +901,15 @@ int main() {
         // 处理事件
         glfwPollEvents();
 
+        // 相机不穿入地面：保持在地面以上一小段距离（地形范围外不限制）
+        const float groundHeight = engine.terrainQuery().heightAt(camera.Position.x, camera.Position.z);
+        if (camera.Position.y < groundHeight + cameraClearance) {
+            camera.Position.y = groundHeight + cameraClearance;
+        }
+
+        // 上传后台解码好的纹理（未到达的纹理先显示占位颜色）
+        engine.uploadTextures();
+
         // 清空缓冲区
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -605,21 +918,35 @@ int main() {
         glm::mat4 view = camera.GetViewMatrix();
         glm::mat4 projection = glm::perspective(glm::radians(100.0f), 800.0f / 600.0f, 0.1f, 10000.0f);
 
-        // 设置地面相关着色器参数
+        engine.reflectionSettings().resolutionDivisor = reflectionDivisor;
+        engine.flatShading = flatShading;
+
+        // 着色器热重载：每 0.5 秒检查一次文件修改时间
+        static float lastShaderCheck = 0.0f;
+        if (currentFrame - lastShaderCheck >= 0.5f) {
+            lastShaderCheck = currentFrame;
+            engine.reloadShaders();
+        }
+
+        // 设置地面相关参数（光源方向在 drawLand 中传给着色器）
         model = glm::scale(model, glm::vec3(50.0f));
-        engine.landShader.setVec3("lightPos", lightPos);
-        engine.landShader.setVec3("viewPos", camera.Position);
+        engine.lightDir = lightPos;
 
         // 绘制地面
-        engine.drawLand(model, view, projection, true);
+        engine.drawLand(model, view, projection, false);
 
         // 绘制水面
         engine.drawWater(model, view, projection, camera, deltaTime);
 
-        // 绘制天空盒
-        glDepthFunc(GL_ALWAYS); // 禁用深度测试
+        // 最后绘制天空盒（只填充没有被地面、水面覆盖的像素）
         engine.drawSkybox(model, view, projection, deltaTime);
-        glDepthFunc(GL_LESS);   // 恢复深度测试
+
+        // 输出剔除统计
+        static float lastReport = 0.0f;
+        if (showCullReport && currentFrame - lastReport >= 1.0f) {
+            engine.printCullReport();
+            lastReport = currentFrame;
+        }
 
         // 交换缓冲区
         glfwSwapBuffers(window);
@@ -9,11 +9,12 @@
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
+#include "Texture/TextureStreamer.h"
 
 const int WIDTH = 800;
 const int HEIGHT = 600;
 
-GLuint loadTexture(const char* path);
+bool decodeImage(const std::string& path, int desiredChannels, TextureStreamer::Image& image);
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 
 // ɫ
@@ -69,8 +70,10 @@ int main() {
     // ɫ
     GLuint shaderProgram = createShaderProgram();
 
-    // 
-    GLuint starTexture = loadTexture("src/Star.bmp");
+    // ̨߳̽벢 mipmapǰΪ͸ռλݲɼ
+    TextureStreamer textures(decodeImage, 1);
+    textures.placeholder[3] = 0;
+    GLuint starTexture = textures.load2D("src/Star.bmp", GL_REPEAT);
 
     // ǵĳʼ
     const float maxRadius = 1.5f; // Ӱ뾶
@@ -129,6 +132,8 @@ int main() {
         float deltaTime = 0.005f; // ÿѭʱ䲽ģʱ
         elapsedTime += deltaTime;
 
+        textures.update(); // ϴѽ
+
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         glEnable(GL_DEPTH_TEST);
@@ -195,29 +200,15 @@ int main() {
     return 0;
 }
 
-GLuint loadTexture(const char* path) {
-    GLuint textureID;
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-
-    int width, height, nrChannels;
-    unsigned char* data = stbi_load(path, &width, &height, &nrChannels, 0);
-    if (data) {
-        GLenum format = (nrChannels == 4) ? GL_RGBA : GL_RGB;
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-        std::cout << "Texture loaded successfully: " << path << std::endl;
-    } else {
-        std::cerr << "Failed to load texture: " << path << std::endl;
+bool decodeImage(const std::string& path, int desiredChannels, TextureStreamer::Image& image) {
+    unsigned char* data = stbi_load(path.c_str(), &image.width, &image.height, &image.channels, desiredChannels);
+    if (!data) {
+        return false;
     }
+    if (desiredChannels != 0) image.channels = desiredChannels;
+    image.pixels.assign(data, data + static_cast<size_t>(image.width) * image.height * image.channels);
     stbi_image_free(data);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    return textureID;
+    return true;
 }
 
 void checkShaderCompileStatus(GLuint shader, const std::string& type) {
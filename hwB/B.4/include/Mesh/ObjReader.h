@@ -0,0 +1,367 @@
+/*
+ * ObjReader.h
+ *
+ * OBJ 文件读取：内存映射整个文件，按换行对齐切成若干块，每块由一个线程用 std::from_chars
+ * 解析 v / vt / vn / f 记录，最后按块顺序合并，结果与逐行串行读取完全一致。
+ *
+ * 支持的语法：
+ * - f a / f a/b / f a//c / f a/b/c，任意边数的多边形（n-gon）
+ * - 负索引（相对于此前已定义的元素，合并时按块的前缀计数换算）
+ * - v 行末尾的 w 或顶点颜色、注释、o / g / s / usemtl 等其他记录会被忽略
+ *
+ * ObjData 中的多边形以 CSR 形式保存（faceOffsets + corners），
+ * triangulate 按扇形把多边形拆为三角形索引。
+ *
+ * 撰写者：Zhiyuan Feng
+ */
+
+#ifndef OBJ_READER_H
+#define OBJ_READER_H
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "glm/glm.hpp"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// 多边形的一个角：位置 / 纹理坐标 / 法线的 0 基索引，缺省为 -1
+struct ObjCorner {
+    int32_t position;
+    int32_t texCoord;
+    int32_t normal;
+};
+
+struct ObjData {
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> texCoords;
+    std::vector<glm::vec3> normals;
+    std::vector<ObjCorner> corners;
+    std::vector<uint32_t> faceOffsets; // 面 f 的角为 corners[faceOffsets[f] .. faceOffsets[f+1])
+
+    size_t faceCount() const { return faceOffsets.empty() ? 0 : faceOffsets.size() - 1; }
+
+    // 扇形三角化，输出位置索引（每3个一个三角形）
+    std::vector<unsigned int> triangulate() const {
+        std::vector<unsigned int> triangles;
+        triangles.reserve(3 * (corners.size() - std::min(corners.size(), 2 * faceCount())));
+        for (size_t f = 0; f < faceCount(); ++f) {
+            for (uint32_t c = faceOffsets[f] + 1; c + 1 < faceOffsets[f + 1]; ++c) {
+                triangles.push_back(static_cast<unsigned int>(corners[faceOffsets[f]].position));
+                triangles.push_back(static_cast<unsigned int>(corners[c].position));
+                triangles.push_back(static_cast<unsigned int>(corners[c + 1].position));
+            }
+        }
+        return triangles;
+    }
+};
+
+// 只读内存映射文件；sequential 为 false 时提示系统按随机访问预读
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path, bool sequential = true) {
+#ifdef _WIN32
+        fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                 FILE_ATTRIBUTE_NORMAL | (sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS), nullptr);
+        if (fileHandle == INVALID_HANDLE_VALUE) return;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(fileHandle, &fileSize)) return;
+        size = static_cast<size_t>(fileSize.QuadPart);
+        opened = true;
+        if (size == 0) return;
+        mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mappingHandle) { opened = false; return; }
+        data = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+        if (!data) opened = false;
+#else
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) != 0) return;
+        size = static_cast<size_t>(st.st_size);
+        opened = true;
+        if (size == 0) return;
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) { opened = false; return; }
+        data = static_cast<const char*>(mapped);
+        madvise(mapped, size, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+#endif
+    }
+
+    ~MappedFile() {
+#ifdef _WIN32
+        if (data) UnmapViewOfFile(data);
+        if (mappingHandle) CloseHandle(mappingHandle);
+        if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+#else
+        if (data) munmap(const_cast<char*>(data), size);
+        if (fd >= 0) ::close(fd);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isOpen() const { return opened; }
+    const char* begin() const { return data; }
+    const char* end() const { return data + size; }
+    size_t length() const { return size; }
+
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+    bool opened = false;
+#ifdef _WIN32
+    HANDLE fileHandle = INVALID_HANDLE_VALUE;
+    HANDLE mappingHandle = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+namespace obj_detail {
+
+constexpr int64_t MISSING = INT64_MIN;
+
+// 一块文本的解析结果；角索引为 64 位原始值，合并时再换算并检查范围
+struct Chunk {
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> texCoords;
+    std::vector<glm::vec3> normals;
+    std::vector<int64_t> corners;            // 每角3个：位置 / 纹理 / 法线
+    std::vector<uint32_t> faceSizes;
+    std::vector<size_t> relativeSlots;       // corners 中需要加上块起始计数的槽（负索引）
+    std::string error;
+};
+
+inline bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+inline const char* skipBlank(const char* p, const char* end) {
+    while (p < end && isBlank(*p)) ++p;
+    return p;
+}
+
+inline bool parseFloat(const char*& p, const char* end, float& value) {
+    p = skipBlank(p, end);
+    if (p < end && *p == '+') ++p; // from_chars 不接受前导 '+'
+    std::from_chars_result result = std::from_chars(p, end, value);
+    if (result.ec != std::errc()) return false;
+    p = result.ptr;
+    return true;
+}
+
+// 解析一个 OBJ 索引，0 基化；负索引转为块内相对值并记录槽位
+inline bool parseIndex(const char*& p, const char* end, size_t localCount, Chunk& chunk, size_t slot) {
+    int64_t value = 0;
+    std::from_chars_result result = std::from_chars(p, end, value);
+    if (result.ec != std::errc() || value == 0) return false;
+    p = result.ptr;
+    if (value > 0) {
+        chunk.corners[slot] = value - 1;
+    } else {
+        chunk.corners[slot] = static_cast<int64_t>(localCount) + value;
+        chunk.relativeSlots.push_back(slot);
+    }
+    return true;
+}
+
+inline void parseChunk(const char* p, const char* end, Chunk& chunk) {
+    while (p < end && chunk.error.empty()) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+        if (!lineEnd) lineEnd = end;
+        const char* q = skipBlank(p, lineEnd);
+        if (q + 1 < lineEnd && q[0] == 'v' && isBlank(q[1])) {
+            glm::vec3 v;
+            ++q;
+            if (!parseFloat(q, lineEnd, v.x) || !parseFloat(q, lineEnd, v.y) || !parseFloat(q, lineEnd, v.z)) {
+                chunk.error = "bad vertex";
+            }
+            chunk.positions.push_back(v);
+        } else if (q + 2 < lineEnd && q[0] == 'v' && q[1] == 't' && isBlank(q[2])) {
+            glm::vec2 t(0.0f);
+            q += 2;
+            if (!parseFloat(q, lineEnd, t.x)) chunk.error = "bad texture coordinate";
+            parseFloat(q, lineEnd, t.y); // 一维纹理坐标时 v 取 0
+            chunk.texCoords.push_back(t);
+        } else if (q + 2 < lineEnd && q[0] == 'v' && q[1] == 'n' && isBlank(q[2])) {
+            glm::vec3 n;
+            q += 2;
+            if (!parseFloat(q, lineEnd, n.x) || !parseFloat(q, lineEnd, n.y) || !parseFloat(q, lineEnd, n.z)) {
+                chunk.error = "bad normal";
+            }
+            chunk.normals.push_back(n);
+        } else if (q + 1 < lineEnd && q[0] == 'f' && isBlank(q[1])) {
+            ++q;
+            uint32_t numCorners = 0;
+            while (chunk.error.empty()) {
+                q = skipBlank(q, lineEnd);
+                if (q >= lineEnd || *q == '#') break;
+                size_t slot = chunk.corners.size();
+                chunk.corners.insert(chunk.corners.end(), { MISSING, MISSING, MISSING });
+                if (!parseIndex(q, lineEnd, chunk.positions.size(), chunk, slot)) {
+                    chunk.error = "bad face index";
+                    break;
+                }
+                if (q < lineEnd && *q == '/') {
+                    ++q;
+                    if (q < lineEnd && *q != '/' && !isBlank(*q) && !parseIndex(q, lineEnd, chunk.texCoords.size(), chunk, slot + 1)) {
+                        chunk.error = "bad face texture index";
+                        break;
+                    }
+                    if (q < lineEnd && *q == '/') {
+                        ++q;
+                        if (q < lineEnd && !isBlank(*q) && !parseIndex(q, lineEnd, chunk.normals.size(), chunk, slot + 2)) {
+                            chunk.error = "bad face normal index";
+                            break;
+                        }
+                    }
+                }
+                if (q < lineEnd && !isBlank(*q)) {
+                    chunk.error = "bad face index";
+                    break;
+                }
+                ++numCorners;
+            }
+            if (chunk.error.empty() && numCorners < 3) chunk.error = "face has less than 3 vertices";
+            chunk.faceSizes.push_back(numCorners);
+        }
+        if (!chunk.error.empty()) {
+            chunk.error += ": " + std::string(p, lineEnd);
+        }
+        p = lineEnd < end ? lineEnd + 1 : end;
+    }
+}
+
+} // namespace obj_detail
+
+// 读取 OBJ 文件；失败时输出错误信息并返回 false
+inline bool readObj(const std::string& path, ObjData& out, size_t minChunkBytes = 1 << 20) {
+    using namespace obj_detail;
+    out = ObjData();
+    MappedFile file(path);
+    if (!file.isOpen()) {
+        std::cerr << "Error: Failed to open file " << path << std::endl;
+        return false;
+    }
+
+    // 按换行对齐切块
+    unsigned int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    size_t numChunks = std::max<size_t>(1, std::min<size_t>(hardwareThreads, file.length() / std::max<size_t>(1, minChunkBytes)));
+    std::vector<const char*> bounds{ file.begin() };
+    for (size_t c = 1; c < numChunks; ++c) {
+        const char* cut = std::max(bounds.back(), file.begin() + file.length() * c / numChunks);
+        const char* newline = static_cast<const char*>(std::memchr(cut, '\n', static_cast<size_t>(file.end() - cut)));
+        if (!newline) break;
+        bounds.push_back(newline + 1);
+    }
+    bounds.push_back(file.end());
+    numChunks = bounds.size() - 1;
+
+    // 各块并行解析（第一块在当前线程）
+    std::vector<Chunk> chunks(numChunks);
+    {
+        std::vector<std::thread> workers;
+        for (size_t c = 1; c < numChunks; ++c) {
+            workers.emplace_back([&chunks, &bounds, c]() { parseChunk(bounds[c], bounds[c + 1], chunks[c]); });
+        }
+        if (numChunks > 0) parseChunk(bounds[0], bounds[1], chunks[0]);
+        for (std::thread& worker : workers) worker.join();
+    }
+    for (const Chunk& chunk : chunks) {
+        if (!chunk.error.empty()) {
+            std::cerr << "Error: " << path << ": " << chunk.error << std::endl;
+            return false;
+        }
+    }
+
+    // 各块元素的起始位置（前缀和）
+    struct Start { size_t position, texCoord, normal, corner, face; };
+    std::vector<Start> starts(numChunks + 1, Start{ 0, 0, 0, 0, 0 });
+    for (size_t c = 0; c < numChunks; ++c) {
+        starts[c + 1].position = starts[c].position + chunks[c].positions.size();
+        starts[c + 1].texCoord = starts[c].texCoord + chunks[c].texCoords.size();
+        starts[c + 1].normal = starts[c].normal + chunks[c].normals.size();
+        starts[c + 1].corner = starts[c].corner + chunks[c].corners.size() / 3;
+        starts[c + 1].face = starts[c].face + chunks[c].faceSizes.size();
+    }
+    const Start& total = starts[numChunks];
+    if (total.position > static_cast<size_t>(INT32_MAX) || total.corner > static_cast<size_t>(UINT32_MAX)) {
+        std::cerr << "Error: " << path << " is too large." << std::endl;
+        return false;
+    }
+    out.positions.resize(total.position);
+    out.texCoords.resize(total.texCoord);
+    out.normals.resize(total.normal);
+    out.corners.resize(total.corner);
+    out.faceOffsets.resize(total.face + 1);
+    out.faceOffsets[total.face] = static_cast<uint32_t>(total.corner);
+
+    // 按块顺序并行合并，换算相对索引并检查范围
+    std::vector<char> rangeError(numChunks, 0);
+    auto mergeChunk = [&](size_t c) {
+        Chunk& chunk = chunks[c];
+        const Start& s = starts[c];
+        std::copy(chunk.positions.begin(), chunk.positions.end(), out.positions.begin() + s.position);
+        std::copy(chunk.texCoords.begin(), chunk.texCoords.end(), out.texCoords.begin() + s.texCoord);
+        std::copy(chunk.normals.begin(), chunk.normals.end(), out.normals.begin() + s.normal);
+        const size_t base[3] = { s.position, s.texCoord, s.normal };
+        const size_t limit[3] = { total.position, total.texCoord, total.normal };
+        for (size_t slot : chunk.relativeSlots) {
+            chunk.corners[slot] += static_cast<int64_t>(base[slot % 3]);
+        }
+        for (size_t k = 0; k < chunk.corners.size() / 3; ++k) {
+            int32_t resolved[3];
+            for (size_t a = 0; a < 3; ++a) {
+                int64_t value = chunk.corners[3 * k + a];
+                if (value == MISSING) {
+                    resolved[a] = -1;
+                } else if (value < 0 || static_cast<size_t>(value) >= limit[a]) {
+                    rangeError[c] = 1;
+                    resolved[a] = -1;
+                } else {
+                    resolved[a] = static_cast<int32_t>(value);
+                }
+            }
+            out.corners[s.corner + k] = { resolved[0], resolved[1], resolved[2] };
+        }
+        uint32_t offset = static_cast<uint32_t>(s.corner);
+        for (size_t f = 0; f < chunk.faceSizes.size(); ++f) {
+            out.faceOffsets[s.face + f] = offset;
+            offset += chunk.faceSizes[f];
+        }
+        chunk = Chunk(); // 尽早释放
+    };
+    {
+        std::vector<std::thread> workers;
+        for (size_t c = 1; c < numChunks; ++c) {
+            workers.emplace_back(mergeChunk, c);
+        }
+        if (numChunks > 0) mergeChunk(0);
+        for (std::thread& worker : workers) worker.join();
+    }
+    if (std::find(rangeError.begin(), rangeError.end(), 1) != rangeError.end()) {
+        std::cerr << "Error: " << path << ": face index out of range." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+#endif // OBJ_READER_H
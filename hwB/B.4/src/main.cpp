@@ -12,6 +12,7 @@
 #include <fstream>
 #include <sstream>
 #include <unordered_map>
+#include "Mesh/ObjReader.h"
 
 // Window dimensions
 const GLuint WIDTH = 800, HEIGHT = 600;
@@ -337,33 +338,19 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 
 // Load OBJ file and build half-edge structure
 bool loadOBJ(const std::string& path) {
-    std::ifstream file(path);
-    if (!file.is_open()) {
-        std::cout << "Cannot open file: " << path << std::endl;
+    ObjData obj;
+    if (!readObj(path, obj)) {
+        std::cout << "Cannot load file: " << path << std::endl;
         return false;
     }
 
-    std::vector<glm::vec3> temp_vertices;
-    std::vector<glm::ivec3> faceIndices;
-
-    std::string line;
-    while (std::getline(file, line)) {
-        if (line.substr(0, 2) == "v ") {
-            std::istringstream s(line.substr(2));
-            glm::vec3 v;
-            s >> v.x; s >> v.y; s >> v.z;
-            temp_vertices.push_back(v);
-        }
-        else if (line.substr(0, 2) == "f ") {
-            std::istringstream s(line.substr(2));
-            glm::ivec3 f;
-            s >> f.x; s >> f.y; s >> f.z;
-            // OBJ indices start at 1
-            f -= glm::ivec3(1);
-            faceIndices.push_back(f);
-        }
+    // Polygons (including n-gons) are fan-triangulated; indices are already 0-based
+    std::vector<glm::vec3>& temp_vertices = obj.positions;
+    std::vector<unsigned int> triangles = obj.triangulate();
+    std::vector<glm::ivec3> faceIndices(triangles.size() / 3);
+    for (size_t i = 0; i < faceIndices.size(); ++i) {
+        faceIndices[i] = glm::ivec3(triangles[3 * i], triangles[3 * i + 1], triangles[3 * i + 2]);
     }
-    file.close();
 
     // Create vertices
     for (size_t i = 0; i < temp_vertices.size(); ++i) {